@@ -11,16 +11,21 @@
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFileInfo>
 #include <QFontDatabase>
 #include <QLocale>
 #include <QMetaMethod>
+#include <QMutex>
 #include <QTextCodec>
 #include <QTranslator>
 
 #include "canorus.h"
 #include "control/helpctl.h"
+#include "control/typesetserver.h"
+#include "core/exportqueue.h"
 #include "core/settings.h"
+#include "core/startuptrace.h"
 #include "core/undo.h"
 #include "interface/rtmididevice.h"
 #include "score/sheet.h"
@@ -34,6 +39,9 @@ CAAutoRecovery* CACanorus::_autoRecovery;
 CAMidiDevice* CACanorus::_midiDevice;
 CAUndo* CACanorus::_undo;
 CAHelpCtl* CACanorus::_help;
+bool CACanorus::_scriptingInitialized = false;
+CAExportQueue* CACanorus::_exportQueue = nullptr;
+CATypesetServer* CACanorus::_typesetServer = nullptr;
 QList<QString> CACanorus::_recentDocumentList;
 QHash<QString, int> CACanorus::_fetaMap;
 std::unique_ptr<QTranslator> CACanorus::_translator;
@@ -175,11 +183,48 @@ void CACanorus::initCommonGUI(std::unique_ptr<QFileDialog>& uiSaveDialog,
 
 /*!
 	Initializes playback devices.
+
+	This is called on first use of midiDevice(), usually on the first playback. At
+	startup it is only called when a MIDI input port is set up, so the MIDI keyboard
+	works right away. The stored ports are checked against the available ones and the
+	main windows are connected to the MIDI input.
 */
 void CACanorus::initPlayback()
 {
+    if (_midiDevice)
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+
     qRegisterMetaType<QVector<unsigned char>>("QVector< unsigned char >");
     setMidiDevice(new CARtMidiDevice());
+
+    if (_settings) {
+        _settings->updateMidiPorts();
+        _midiDevice->openInputPort(_settings->midiInPort());
+    }
+
+    for (CAMainWin* mainWin : _mainWinList) {
+        mainWin->connectMidiDevice();
+    }
+
+    CAStartupTrace::report("MIDI", timer.elapsed());
+}
+
+/*!
+	Returns the MIDI device used for playback and MIDI input. The device is opened
+	on first use.
+
+	\sa hasMidiDevice(), initPlayback()
+*/
+CAMidiDevice* CACanorus::midiDevice()
+{
+    if (!_midiDevice) {
+        initPlayback();
+    }
+
+    return _midiDevice;
 }
 
 /*!
@@ -203,15 +248,27 @@ CASettingsDialog::CASettingsPage CACanorus::initSettings()
 
 /*!
 	Initializes scripting and plugins subsystem.
+
+	The interpreters are started on first use, when a plugin action is called or a
+	command is entered in the console. Calling this function again does nothing.
 */
 void CACanorus::initScripting()
 {
+    if (_scriptingInitialized)
+        return;
+    _scriptingInitialized = true;
+
+    QElapsedTimer timer;
+    timer.start();
+
 #ifdef USE_RUBY
     CASwigRuby::init();
 #endif
 #ifdef USE_PYTHON
     CASwigPython::init();
 #endif
+
+    CAStartupTrace::report("scripting", timer.elapsed());
 }
 
 /*!
@@ -250,7 +307,57 @@ int CACanorus::fetaCodepoint(const QString& name)
 
 void CACanorus::initHelp()
 {
+    if (_help)
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+
     _help = new CAHelpCtl();
+
+    CAStartupTrace::report("help", timer.elapsed());
+}
+
+/*!
+	Returns the help controller. User's guide is looked up on first use.
+*/
+CAHelpCtl* CACanorus::help()
+{
+    if (!_help) {
+        initHelp();
+    }
+
+    return _help;
+}
+
+/*!
+	Returns the application-wide queue for background exports.
+	The queue is created on first use.
+*/
+CAExportQueue* CACanorus::exportQueue()
+{
+    if (!_exportQueue) {
+        _exportQueue = new CAExportQueue();
+    }
+
+    return _exportQueue;
+}
+
+/*!
+	Returns the typesetting server shared by the print preview and the PDF and SVG exports.
+	The typeset files are cached in the settings directory.
+
+	The server is created on first use, usually from an export thread.
+*/
+CATypesetServer* CACanorus::typesetServer()
+{
+    static QMutex mutex;
+    QMutexLocker locker(&mutex);
+    if (!_typesetServer) {
+        _typesetServer = new CATypesetServer(CASettings::defaultSettingsPath() + "/typeset");
+    }
+
+    return _typesetServer;
 }
 
 void CACanorus::insertRecentDocument(QString filename)
@@ -281,10 +388,16 @@ void CACanorus::removeRecentDocument(QString filename)
 */
 void CACanorus::cleanUp()
 {
+    delete _exportQueue; // finishes the running exports
+    _exportQueue = nullptr;
+    delete _typesetServer;
+    _typesetServer = nullptr;
     delete _settings;
     delete _midiDevice;
-    autoRecovery()->cleanupRecovery();
-    delete _autoRecovery;
+    if (_autoRecovery) { // not created when converting files from the command line
+        _autoRecovery->cleanupRecovery();
+        delete _autoRecovery;
+    }
     delete _undo;
 }
 
@@ -32,6 +32,8 @@ class CAMidiDevice;
 class CADocument;
 class CAUndo;
 class CAHelpCtl;
+class CAExportQueue;
+class CATypesetServer;
 
 class CACanorus {
 public:
@@ -82,10 +84,14 @@ public:
 
     inline static CASettings* settings() { return _settings; }
     inline static CAAutoRecovery* autoRecovery() { return _autoRecovery; }
-    inline static CAMidiDevice* midiDevice() { return _midiDevice; }
+    static CAMidiDevice* midiDevice();
+    inline static bool hasMidiDevice() { return _midiDevice != nullptr; }
     inline static void setMidiDevice(CAMidiDevice* d) { _midiDevice = d; }
 
-    inline static CAHelpCtl* help() { return _help; }
+    static CAHelpCtl* help();
+
+    static CAExportQueue* exportQueue();
+    static CATypesetServer* typesetServer();
 
     static void rebuildUI(CADocument* document, CASheet* sheet);
     static void rebuildUI(CADocument* document = nullptr);
@@ -109,14 +115,19 @@ private:
     static QList<QString> _recentDocumentList;
     static std::unique_ptr<QTranslator> _translator;
     static QHash<QString, int> _fetaMap;
+    static bool _scriptingInitialized; // interpreters are started on first use, see initScripting()
 
     // Playback output
-    static CAMidiDevice* _midiDevice;
+    static CAMidiDevice* _midiDevice; // opened on first use, see midiDevice()
 
     // Auto recovery
     static CAAutoRecovery* _autoRecovery;
 
     // Help
-    static CAHelpCtl* _help;
+    static CAHelpCtl* _help; // loaded on first use, see help()
+
+    // Background exports
+    static CAExportQueue* _exportQueue;
+    static CATypesetServer* _typesetServer;
 };
 #endif /* CANORUS_H_ */
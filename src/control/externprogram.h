@@ -49,6 +49,7 @@ public:
     inline void clearParameters() { _oParameters.clear(); }
     bool execProgram(const QString& roCwd = ".");
     inline bool waitForFinished(int iMSecs) { return _poExternProgram->waitForFinished(iMSecs); }
+    inline void kill() { _poExternProgram->kill(); }
 
 signals:
     void nextOutput(const QByteArray& roData);
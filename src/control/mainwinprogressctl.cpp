@@ -37,7 +37,7 @@ void CAMainWinProgressCtl::on_updateTimer_timeout()
 void CAMainWinProgressCtl::on_cancelButton_clicked(bool)
 {
     if (_file) {
-        _file->exit();
+        _file->cancel();
         restoreStatusBar();
         _updateTimer->stop();
 
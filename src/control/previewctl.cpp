@@ -16,13 +16,17 @@
 #include "control/previewctl.h"
 #include "core/settings.h"
 #include "export/pdfexport.h"
+#include "layout/pagelayout.h"
 #include "ui/mainwin.h"
+#include "widgets/scoreview.h"
 
 CAPreviewCtl::CAPreviewCtl(CAMainWin* poMainWin)
 {
     setObjectName("oPreviewCtl");
     _poMainWin = poMainWin;
     _poPDFExport = std::make_unique<CAPDFExport>();
+    _poPageLayout = std::make_unique<CAPageLayout>();
+    _poPreviewView = std::make_unique<CAScoreView>();
     if (!poMainWin) {
         qCritical("PreviewCtl: No mainwindow instance available!");
     }
@@ -45,6 +49,21 @@ void CAPreviewCtl::on_uiPrintPreview_triggered()
         oTempFile.unsetError();
     }
     qDebug("PreviewCtl: Preview triggered via main window");
+    if (CACanorus::settings()->useNativePreview()) {
+        // Lay out the pages natively, without running the typesetter
+        _poPreviewView->setSheet(_poMainWin->currentSheet());
+        _poPreviewView->rebuild();
+        _poPageLayout->layout(_poPreviewView.get());
+        _oOutputPDFName = oTempFileName;
+        bool bWritten = _poPageLayout->exportPdf(oTempFileName);
+        _poPreviewView->clearDrawables(); // the sheet may be deleted before the next preview
+        if (!bWritten) {
+            QMessageBox::critical(_poMainWin, tr("Error running preview"), tr("Unable to write %1.").arg(oTempFileName));
+            return;
+        }
+        showPDF(0);
+        return;
+    }
     // The exportDocument method defines the temporary file name and
     // directory, so we can only read it after the creation
     _poPDFExport->setStreamToFile(oTempFileName);
@@ -56,6 +75,32 @@ void CAPreviewCtl::on_uiPrintPreview_triggered()
     _oOutputPDFName = roTempPath;
 }
 
+/*!
+	Lays out the sheet \a poSheet natively and writes its pages to SVG files using
+	CAPageLayout::exportSvg(). The first page is written to \a roFileName, the following
+	ones to "-2.svg", "-3.svg", etc. like the typeset sheets of CASVGExport.
+
+	Returns True, if all the pages were written; otherwise False.
+*/
+bool CAPreviewCtl::exportSvg(CASheet* poSheet, const QString& roFileName)
+{
+    QString oBaseName = roFileName;
+    if (oBaseName.endsWith(".svg", Qt::CaseInsensitive))
+        oBaseName.chop(4);
+
+    _poPreviewView->setSheet(poSheet);
+    _poPreviewView->rebuild();
+    _poPageLayout->layout(_poPreviewView.get());
+    bool bWritten = true;
+    for (int iPage = 0; iPage < _poPageLayout->pageCount() && bWritten; iPage++) {
+        QString oFileName = iPage ? oBaseName + "-" + QString::number(iPage + 1) + ".svg" : roFileName;
+        bWritten = _poPageLayout->exportSvg(oFileName, iPage);
+    }
+    _poPreviewView->clearDrawables(); // the sheet may be deleted before the next export
+
+    return bWritten;
+}
+
 void CAPreviewCtl::showPDF(int iExitCode)
 {
     if (iExitCode) {
@@ -20,6 +20,9 @@
 // Forward declarations
 class CAMainWin;
 class CAPDFExport;
+class CAPageLayout;
+class CAScoreView;
+class CASheet;
 
 class CAPreviewCtl : public QObject {
     Q_OBJECT
@@ -28,6 +31,8 @@ public:
     CAPreviewCtl(CAMainWin* poMainWin);
     ~CAPreviewCtl();
 
+    bool exportSvg(CASheet* poSheet, const QString& roFileName);
+
 public slots:
     void on_uiPrintPreview_triggered();
 
@@ -37,6 +42,8 @@ protected slots:
 protected:
     CAMainWin* _poMainWin;
     std::unique_ptr<CAPDFExport> _poPDFExport;
+    std::unique_ptr<CAPageLayout> _poPageLayout; // kept between previews to reuse the line breaks
+    std::unique_ptr<CAScoreView> _poPreviewView; // hidden view laid out for every preview, see CAScoreView::clearDrawables()
     QString _oOutputPDFName;
 };
 
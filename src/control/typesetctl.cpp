@@ -6,9 +6,16 @@
 */
 
 // Includes
+#include <QFile>
+#include <QProcess>
+#include <QStandardPaths>
+
 #include "control/typesetctl.h"
 #include "control/externprogram.h"
+#include "control/typesetserver.h"
 #include "export/export.h"
+#include "export/lilypondexport.h"
+#include "score/document.h"
 //#include "core/document.h"
 
 /*!	\class CATypesetCtl
@@ -19,6 +26,10 @@
 	If the typesetter does not support creation of pdf files another process can
 	be started to do the conversion.
 
+	If a CATypesetServer is set by setServer(), the exported file is typeset by the
+	server's already running typesetter or taken from its cache instead of starting
+	a new process.
+
 	Constructor:
 */
 
@@ -27,6 +38,7 @@ CATypesetCtl::CATypesetCtl()
     _poTypesetter = new CAExternProgram;
     _poConvPS2PDF = new CAExternProgram;
     _poExport = nullptr;
+    _poServer = nullptr;
     _poOutputFile = nullptr;
     _bPDFConversion = false;
     _bOutputFileNameFirst = false;
@@ -62,8 +74,11 @@ void CATypesetCtl::setTypesetter(const QString& roProgramName, const QString& ro
 {
     if (!roProgramName.isEmpty()) {
         _poTypesetter->setProgramName(roProgramName);
-        if (!roProgramPath.isEmpty())
+        _oTypesetterProgram = roProgramName;
+        if (!roProgramPath.isEmpty()) {
             _poTypesetter->setProgramPath(roProgramPath);
+            _oTypesetterProgram = roProgramPath + "/" + roProgramName;
+        }
     }
 }
 
@@ -143,6 +158,29 @@ void CATypesetCtl::setTSetOption(const QVariant& roName, const QVariant& roValue
             roName.toString().toLatin1().data(), roValue.toString().toLatin1().data());
 }
 
+/*!
+	Creates a new temporary file for the exported document
+
+	The file name is also the base name of the typesetter output files.
+*/
+void CATypesetCtl::createOutputFile()
+{
+    if (_poOutputFile) {
+        delete _poOutputFile;
+        _poTypesetter->clearParameters();
+    }
+    _poOutputFile = new QTemporaryFile;
+    // Create the unique file as the file name is only defined when opening the file
+    _poOutputFile->open();
+    // Add the input file name as default parameter.
+    // @ToDo: There might be problems with typesetter expecting file extensions,
+    // if so, methods have to be added handling this
+    _oOutputFileName = _poOutputFile->fileName();
+    // Only add output file name as first parameter file name if it is needed
+    if (true == _bOutputFileNameFirst)
+        _poTypesetter->addParameter(_oOutputFileName, false);
+}
+
 /*!
 	Export the file to disk to be run by the typesetter
 
@@ -155,20 +193,7 @@ void CATypesetCtl::exportDocument(CADocument* poDoc)
 {
     /// \todo: Add export options to the document directly ?
     if (_poExport) {
-        if (_poOutputFile) {
-            delete _poOutputFile;
-            _poTypesetter->clearParameters();
-        }
-        _poOutputFile = new QTemporaryFile;
-        // Create the unique file as the file name is only defined when opening the file
-        _poOutputFile->open();
-        // Add the input file name as default parameter.
-        // @ToDo: There might be problems with typesetter expecting file extensions,
-        // if so, methods have to be added handling this
-        _oOutputFileName = _poOutputFile->fileName();
-        // Only add output file name as first parameter file name if it is needed
-        if (true == _bOutputFileNameFirst)
-            _poTypesetter->addParameter(_oOutputFileName, false);
+        createOutputFile();
         _poExport->setStreamToDevice(_poOutputFile);
         _poExport->exportDocument(poDoc);
         // @ToDo use signal/slot mechanism to wait for the file
@@ -190,20 +215,7 @@ void CATypesetCtl::exportSheet(CASheet* poSheet)
 {
     /// \todo: Add export options to the document directly ?
     if (_poExport) {
-        if (_poOutputFile) {
-            delete _poOutputFile;
-            _poTypesetter->clearParameters();
-        }
-        _poOutputFile = new QTemporaryFile;
-        // Create the unique file as the file name is only defined when opening the file
-        _poOutputFile->open();
-        // Add the input file name as default parameter.
-        // @ToDo: There might be problems with typesetter expecting file extensions,
-        // if so, methods have to be added handling this
-        _oOutputFileName = _poOutputFile->fileName();
-        // Only add output file name as first parameter file name if it is needed
-        if (true == _bOutputFileNameFirst)
-            _poTypesetter->addParameter(_oOutputFileName, false);
+        createOutputFile();
         _poExport->setStreamToDevice(_poOutputFile);
         _poExport->exportSheet(poSheet);
         // @ToDo use signal/slot mechanism to wait for the file
@@ -223,6 +235,18 @@ void CATypesetCtl::exportSheet(CASheet* poSheet)
 */
 void CATypesetCtl::runTypesetter()
 {
+    if (_poServer) {
+        QFile oSource(_oOutputFileName);
+        if (!oSource.open(QIODevice::ReadOnly)) {
+            qCritical("TypesetCtl: Could not read exported file %s", qPrintable(_oOutputFileName));
+            _oServerJob.clear();
+            typsetterExited(-1);
+            return;
+        }
+        _oServerJob = _poServer->typeset(_oTypesetterProgram, serverParameters(), oSource.readAll());
+        return;
+    }
+
     // Only add output file name as first parameter file name if it is needed
     if (false == _bOutputFileNameFirst)
         _poTypesetter->addParameter(_oOutputFileName, false);
@@ -262,9 +286,52 @@ void CATypesetCtl::rcvTypesetterOutput(const QByteArray& roData)
 */
 bool CATypesetCtl::waitForFinished(int iMSecs)
 {
+    if (_poServer) {
+        if (!_oServerJob || !_oServerJob->waitForFinished(iMSecs))
+            return false;
+        serverJobFinished();
+        return true;
+    }
     return _poTypesetter->waitForFinished(iMSecs);
 }
 
+/*!
+	Blocks until the process has finished like waitForFinished( -1 ), but kills the
+	typesetter as soon as the export \a poCancel gets cancelled.
+
+	Returns true if the process finished normally; otherwise returns false.
+
+	\sa CAFile::cancel()
+*/
+bool CATypesetCtl::waitForFinished(CAExport* poCancel)
+{
+    if (_poServer) {
+        if (!_oServerJob)
+            return false;
+        while (!_oServerJob->waitForFinished(100)) {
+            if (poCancel->isCancelled()) {
+                _oServerJob.clear(); // the server finishes and caches it anyway
+                typsetterExited(CAFile::CANCELLED_STATUS);
+                return false;
+            }
+        }
+        serverJobFinished();
+        return true;
+    }
+
+    while (!_poTypesetter->waitForFinished(100)) {
+        if (!_poTypesetter->getRunning()) {
+            return false;
+        }
+        if (poCancel->isCancelled()) {
+            _poTypesetter->kill();
+            _poTypesetter->waitForFinished(-1);
+            return false;
+        }
+    }
+    return true;
+}
+
 /*!
 	Send the exit code of the finished typesetter to a connected slot.
 
@@ -278,7 +345,7 @@ bool CATypesetCtl::waitForFinished(int iMSecs)
 */
 void CATypesetCtl::typsetterExited(int iExitCode)
 {
-    if (iExitCode != 0)
+    if (iExitCode != 0 && iExitCode != CAFile::CANCELLED_STATUS)
         qCritical("TypesetCtl: Typesetter finished with code %d", iExitCode);
     else if (_bPDFConversion) {
         if (!createPDF())
@@ -286,3 +353,254 @@ void CATypesetCtl::typsetterExited(int iExitCode)
     }
     emit typesetterFinished(iExitCode);
 }
+
+/*!
+	Copies the result of the finished server job next to the exported file, where the
+	typesetter would have created it, and reports the job like a finished typesetter.
+*/
+void CATypesetCtl::serverJobFinished()
+{
+    QSharedPointer<CATypesetJob> oJob = _oServerJob;
+    _oServerJob.clear();
+
+    if (!oJob->output().isEmpty())
+        emit nextOutput(oJob->output());
+
+    int iExitCode = oJob->exitCode();
+    if (!iExitCode) {
+        QString oTarget = _oOutputFileName + "." + CATypesetServer::outputSuffix(oJob->parameters());
+        QFile::remove(oTarget);
+        if (!QFile::copy(oJob->resultFileName(), oTarget)) {
+            qCritical("TypesetCtl: Could not copy typeset file %s", qPrintable(oJob->resultFileName()));
+            iExitCode = -1;
+        }
+    }
+    typsetterExited(iExitCode);
+}
+
+/*!
+	Returns the typesetter parameters for the server.
+	The server chooses the input and output file names itself.
+*/
+QStringList CATypesetCtl::serverParameters()
+{
+    QStringList oParams = _poTypesetter->getParameters();
+    oParams.removeAll(_oOutputFileName);
+    oParams.removeAll(QString("-o") + _oOutputFileName);
+    oParams.removeDuplicates(); // keep the cache key independent of options set twice
+    return oParams;
+}
+
+/*!
+	Typesets each sheet of the document \a poDoc separately using the server
+
+	The server's cache is keyed by the sheet's export, so only the sheets changed
+	since the last run are typeset again. SVG files are typeset in parallel and
+	stored as getTempFilePath() + ".svg" for the first sheet and "-2.svg", "-3.svg",
+	etc. for the following ones. PDF files are typeset as parts of one book and
+	merged into getTempFilePath() + ".pdf", see typesetBookParts().
+
+	Waits until the typesetting is finished and emits typesetterFinished(), with
+	CAFile::CANCELLED_STATUS, if the export \a poCancel was cancelled.
+	Returns false, if no server is set or the export was cancelled.
+*/
+bool CATypesetCtl::typesetSheets(CADocument* poDoc, CAExport* poCancel)
+{
+    if (!_poServer) {
+        qCritical("TypesetCtl: Typesetting sheets requires a typesetting server");
+        return false;
+    }
+
+    createOutputFile();
+    _poOutputFile->close();
+    const QStringList oParams = serverParameters();
+    if (CATypesetServer::outputSuffix(oParams) == "pdf") {
+        const int iExitCode = typesetBookParts(poDoc, poCancel, oParams);
+        typsetterExited(iExitCode);
+        return iExitCode != CAFile::CANCELLED_STATUS;
+    }
+
+    QList<QSharedPointer<CATypesetJob>> oJobs;
+    for (int i = 0; i < poDoc->sheetList().size() && !poCancel->isCancelled(); i++) {
+        CALilyPondExport oExport;
+        oExport.setStreamToString();
+        oExport.exportSheet(poDoc->sheetList()[i]);
+        oExport.wait();
+        oJobs << _poServer->typeset(_oTypesetterProgram, oParams, oExport.getStreamAsString().toUtf8());
+    }
+
+    int iExitCode = 0;
+    QStringList oSheetFiles;
+    for (int i = 0; i < oJobs.size() && !poCancel->isCancelled(); i++) {
+        while (!oJobs[i]->waitForFinished(100)) {
+            if (poCancel->isCancelled())
+                break; // the server finishes and caches the jobs anyway
+        }
+        if (!oJobs[i]->isFinished())
+            break;
+        if (!oJobs[i]->output().isEmpty())
+            emit nextOutput(oJobs[i]->output());
+
+        QString oSheetFile = _oOutputFileName + (i ? "-" + QString::number(i + 1) : QString()) + ".svg";
+        if (!iExitCode)
+            iExitCode = oJobs[i]->exitCode();
+        if (!iExitCode) {
+            QFile::remove(oSheetFile);
+            if (!QFile::copy(oJobs[i]->resultFileName(), oSheetFile)) {
+                qCritical("TypesetCtl: Could not copy typeset file %s", qPrintable(oJobs[i]->resultFileName()));
+                iExitCode = -1;
+            }
+            oSheetFiles << oSheetFile;
+        }
+    }
+
+    if (poCancel->isCancelled() || iExitCode) {
+        for (int i = 0; i < oSheetFiles.size(); i++)
+            QFile::remove(oSheetFiles[i]);
+    }
+    if (poCancel->isCancelled()) {
+        typsetterExited(CAFile::CANCELLED_STATUS);
+        return false;
+    }
+
+    typsetterExited(iExitCode);
+    return true;
+}
+
+/*!
+	Returns the Ghostscript executable used to merge the PDF files of the sheets
+	or an empty string, if it is not installed.
+*/
+QString CATypesetCtl::pdfMergeProgram()
+{
+#ifdef Q_OS_WIN
+    QString oProgram = QStandardPaths::findExecutable("gswin64c");
+    if (oProgram.isEmpty())
+        oProgram = QStandardPaths::findExecutable("gswin32c");
+    return oProgram;
+#else
+    return QStandardPaths::findExecutable("gs");
+#endif
+}
+
+/*!
+	Typesets the sheets of the document \a poDoc as parts of one book to PDF and
+	merges them into getTempFilePath() + ".pdf". Used by typesetSheets().
+
+	The sheets are typeset one after another, as each sheet continues the page
+	numbering of the previous ones. The document title is written on the first
+	sheet and the tagline on the last one. An unchanged sheet is taken from the
+	server's cache, unless the page count of a sheet before it has changed.
+
+	Returns 0 on success, CAFile::CANCELLED_STATUS if the export \a poCancel was
+	cancelled, otherwise the exit code of the failed typesetter or Ghostscript run.
+*/
+int CATypesetCtl::typesetBookParts(CADocument* poDoc, CAExport* poCancel, const QStringList& roParams)
+{
+    int iExitCode = 0;
+    int iFirstPage = 1;
+    QStringList oSheetFiles;
+    for (int i = 0; i < poDoc->sheetList().size() && !iExitCode; i++) {
+        if (poCancel->isCancelled()) {
+            iExitCode = CAFile::CANCELLED_STATUS;
+            break;
+        }
+        CALilyPondExport oExport;
+        oExport.setStreamToString();
+        oExport.setFirstPageNumber(iFirstPage);
+        oExport.setBookPart(i == 0, i == poDoc->sheetList().size() - 1);
+        oExport.exportSheet(poDoc->sheetList()[i]);
+        oExport.wait();
+        QSharedPointer<CATypesetJob> oJob = _poServer->typeset(_oTypesetterProgram, roParams, oExport.getStreamAsString().toUtf8());
+
+        while (!oJob->waitForFinished(100)) {
+            if (poCancel->isCancelled())
+                break; // the server finishes and caches the job anyway
+        }
+        if (!oJob->isFinished()) {
+            iExitCode = CAFile::CANCELLED_STATUS;
+            break;
+        }
+        if (!oJob->output().isEmpty())
+            emit nextOutput(oJob->output());
+
+        iExitCode = oJob->exitCode();
+        if (!iExitCode) {
+            QString oSheetFile = _oOutputFileName + "-" + QString::number(i + 1) + ".pdf";
+            QFile::remove(oSheetFile);
+            if (!QFile::copy(oJob->resultFileName(), oSheetFile)) {
+                qCritical("TypesetCtl: Could not copy typeset file %s", qPrintable(oJob->resultFileName()));
+                iExitCode = -1;
+                break;
+            }
+            oSheetFiles << oSheetFile;
+
+            if (i < poDoc->sheetList().size() - 1) {
+                const int iPages = pdfPageCount(oSheetFile);
+                if (iPages < 1)
+                    iExitCode = -1;
+                iFirstPage += iPages;
+            }
+        }
+    }
+
+    if (!iExitCode)
+        iExitCode = mergePDF(oSheetFiles, _oOutputFileName + ".pdf");
+    for (int i = 0; i < oSheetFiles.size(); i++)
+        QFile::remove(oSheetFiles[i]);
+    return iExitCode;
+}
+
+/*!
+	Returns the number of pages of the PDF file \a roFile counted by Ghostscript
+	or -1, if counting failed.
+*/
+int CATypesetCtl::pdfPageCount(const QString& roFile)
+{
+    QString oFile = roFile;
+    oFile.replace("\\", "\\\\").replace("(", "\\(").replace(")", "\\)"); // PostScript string
+    QStringList oParams;
+    oParams << "-q"
+            << "-dNODISPLAY"
+            << "-dNOSAFER"
+            << "-c" << QString("(%1) (r) file runpdfbegin pdfpagecount = quit").arg(oFile);
+
+    QProcess oProcess;
+    oProcess.start(pdfMergeProgram(), oParams);
+    if (!oProcess.waitForFinished() || oProcess.exitCode()) {
+        qCritical("TypesetCtl: Counting the pages of %s failed", qPrintable(roFile));
+        return -1;
+    }
+    bool bOk = false;
+    const int iPages = oProcess.readAllStandardOutput().trimmed().toInt(&bOk);
+    return bOk ? iPages : -1;
+}
+
+/*!
+	Merges the PDF files \a roFiles into \a roTarget using Ghostscript.
+	Returns 0 on success, otherwise the exit code of Ghostscript or a negative value.
+*/
+int CATypesetCtl::mergePDF(const QStringList& roFiles, const QString& roTarget)
+{
+    QFile::remove(roTarget);
+    if (roFiles.size() == 1)
+        return QFile::copy(roFiles[0], roTarget) ? 0 : -1;
+
+    const QString oProgram = pdfMergeProgram();
+    if (oProgram.isEmpty()) {
+        qCritical("TypesetCtl: Merging pdf files requires Ghostscript");
+        return -1;
+    }
+    QStringList oParams;
+    oParams << "-q"
+            << "-dBATCH"
+            << "-dNOPAUSE"
+            << "-sDEVICE=pdfwrite"
+            << QString("-sOutputFile=") + roTarget;
+    oParams << roFiles;
+
+    int iExitCode = QProcess::execute(oProgram, oParams);
+    if (iExitCode)
+        qCritical("TypesetCtl: Merging pdf files using %s failed with code %d", qPrintable(oProgram), iExitCode);
+    return iExitCode;
+}
@@ -10,6 +10,7 @@
 
 // Includes
 #include <QObject>
+#include <QSharedPointer>
 #include <QStringList>
 #include <QTemporaryFile>
 #include <QVariant>
@@ -20,6 +21,8 @@ class CAExternProgram;
 class CAExport;
 class CADocument;
 class CASheet;
+class CATypesetJob;
+class CATypesetServer;
 
 class CATypesetCtl : public QObject {
     Q_OBJECT
@@ -35,15 +38,20 @@ public:
     virtual void setTSetOption(const QVariant& roName, const QVariant& roValue, bool bSpace = false, bool bShortParam = true);
     inline void setPDFConversion(bool bConversion) { _bPDFConversion = bConversion; }
     inline void setExporter(CAExport* poExport) { _poExport = poExport; }
+    inline void setServer(CATypesetServer* poServer) { _poServer = poServer; }
     // Attention: .pdf automatically added and removed if it was added internally
     void exportDocument(CADocument* poDoc);
     void exportSheet(CASheet* poSheet);
     void runTypesetter();
+    bool typesetSheets(CADocument* poDoc, CAExport* poCancel);
+    static QString pdfMergeProgram();
 
     inline bool getPDFConversion() { return _bPDFConversion; }
     inline CAExport* getExporter() { return _poExport; }
+    inline CATypesetServer* getServer() { return _poServer; }
     inline QString getTempFilePath() { return _oOutputFileName; }
     bool waitForFinished(int iMSecs);
+    bool waitForFinished(CAExport* poCancel);
 
 signals:
     void nextOutput(const QByteArray& roData);
@@ -56,10 +64,19 @@ protected slots:
 
 protected:
     bool createPDF();
+    void createOutputFile();
+    QStringList serverParameters();
+    void serverJobFinished();
+    int typesetBookParts(CADocument* poDoc, CAExport* poCancel, const QStringList& roParams);
+    int pdfPageCount(const QString& roFile);
+    int mergePDF(const QStringList& roFiles, const QString& roTarget);
 
     CAExternProgram* _poTypesetter; // Transforms exported file to pdf / postscript
     CAExternProgram* _poConvPS2PDF; // Transforms postscripts files to pdf if needed
     CAExport* _poExport; // Transforms canorus document to typesetter format
+    CATypesetServer* _poServer; // Runs the typesetter instead of _poTypesetter if set
+    QSharedPointer<CATypesetJob> _oServerJob; // Current request to _poServer
+    QString _oTypesetterProgram; // Typesetter executable including the path
     QVector<QVariant> _oExpOptList; // List of options for export
     QVector<QVariant> _oTSetOptList; // List of options for typesetter
     QTemporaryFile* _poOutputFile; // Output file for pdf (also used for exported file)
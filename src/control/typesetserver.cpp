@@ -0,0 +1,449 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+// Includes
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <climits>
+
+#include "control/typesetserver.h"
+
+/*!
+	\class CATypesetJob
+	\brief Typesetting request of CATypesetServer
+
+	The job is created by CATypesetServer::typeset() and shared between the server and
+	the thread waiting for the result. Call waitForFinished() and then read exitCode()
+	and resultFileName().
+*/
+
+CATypesetJob::CATypesetJob(const QString& roHash, const QString& roProgram, const QStringList& roParams, const QByteArray& roSource)
+    : _oHash(roHash)
+    , _oProgram(roProgram)
+    , _oParameters(roParams)
+    , _oSource(roSource)
+    , _bFinished(false)
+    , _iExitCode(-1)
+{
+}
+
+/*!
+	Blocks until the job is finished or until \a iMSecs milliseconds have passed.
+	Waits forever, if \a iMSecs is -1.
+
+	Returns true, if the job is finished.
+*/
+bool CATypesetJob::waitForFinished(int iMSecs)
+{
+    QMutexLocker oLocker(&_oMutex);
+    if (!_bFinished) {
+        _oFinished.wait(&_oMutex, (iMSecs < 0) ? ULONG_MAX : static_cast<unsigned long>(iMSecs));
+    }
+    return _bFinished;
+}
+
+bool CATypesetJob::isFinished()
+{
+    QMutexLocker oLocker(&_oMutex);
+    return _bFinished;
+}
+
+/*!
+	Returns the exit code of the typesetter, 0 on success.
+*/
+int CATypesetJob::exitCode()
+{
+    QMutexLocker oLocker(&_oMutex);
+    return _iExitCode;
+}
+
+/*!
+	Returns the typeset file in the cache directory or an empty string, if the job failed.
+	The file is owned by the cache. It is not evicted as long as the job exists, but
+	should be copied right away.
+*/
+QString CATypesetJob::resultFileName()
+{
+    QMutexLocker oLocker(&_oMutex);
+    return _oResultFileName;
+}
+
+/*!
+	Returns the console output of the typesetter.
+	The output is empty, if the result was taken from the cache.
+*/
+QByteArray CATypesetJob::output()
+{
+    QMutexLocker oLocker(&_oMutex);
+    return _oOutput;
+}
+
+void CATypesetJob::finish(int iExitCode, const QString& roResultFileName, const QByteArray& roOutput)
+{
+    QMutexLocker oLocker(&_oMutex);
+    _iExitCode = iExitCode;
+    _oResultFileName = roResultFileName;
+    _oOutput = roOutput;
+    _bFinished = true;
+    _oFinished.wakeAll();
+}
+
+/*!
+	\class CATypesetServer
+	\brief Long-lived typesetter workers with a result cache
+
+	Starting LilyPond pays for the Guile startup and font loading each time. The server
+	keeps a typesetter process started in advance for each combination of the program and
+	its parameters. The process waits for the source on its standard input ("-" as the
+	input file name), so the next request only needs to send the exported document.
+	When a worker finishes, a new one is started for the next request.
+
+	The results are stored in cacheDir() under the hash of the program, parameters and
+	source. Typesetting an unchanged sheet again returns the cached file immediately.
+	Requests with the same hash as a queued or running one share its job. The least
+	recently used files over maxCacheSize() are removed, except the ones returned by
+	jobs which still exist, so a thread can still copy its result.
+
+	Any executable which reads the source from its standard input and writes the file
+	given by the "-o" parameter plus the outputSuffix() can be used as a typesetter.
+
+	The workers live in the server's own thread, so typeset() can be called from any
+	thread, including the export threads:
+	\code
+	  QSharedPointer<CATypesetJob> job = server->typeset("lilypond", QStringList(), source);
+	  job->waitForFinished();
+	  if (!job->exitCode())
+	    QFile::copy(job->resultFileName(), "jingle bells.pdf");
+	\endcode
+
+	\sa CATypesetCtl::setServer()
+*/
+
+/*!
+	Creates a new typesetting server storing the results to \a roCacheDir.
+*/
+CATypesetServer::CATypesetServer(const QString& roCacheDir)
+    : _oCacheDir(QDir(roCacheDir).absolutePath())
+    , _iMaxRunningJobs(qMax(QThread::idealThreadCount(), 1))
+    , _iMaxCacheSize(64)
+    , _iNextWorker(0)
+{
+    QDir().mkpath(_oCacheDir);
+
+    // reuse the results of the previous sessions, least recently used first
+    QFileInfoList oFiles = QDir(_oCacheDir).entryInfoList(QStringList() << "*.pdf"
+                                                                        << "*.svg",
+        QDir::Files, QDir::Time | QDir::Reversed);
+    for (int i = 0; i < oFiles.size(); i++) {
+        if (!oFiles[i].fileName().startsWith("work-")) {
+            _oCacheFiles << oFiles[i].absoluteFilePath();
+        }
+    }
+
+    _poOwnerThread = nullptr;
+    _poThread = new QThread();
+    moveToThread(_poThread);
+    _poThread->start();
+}
+
+/*!
+	Stops the workers. Waiting jobs are finished with exit code -1.
+*/
+CATypesetServer::~CATypesetServer()
+{
+    _poOwnerThread = QThread::currentThread();
+    QMetaObject::invokeMethod(this, "stopWorkers", Qt::BlockingQueuedConnection);
+    _poThread->quit();
+    _poThread->wait();
+    delete _poThread;
+}
+
+/*!
+	Queues typesetting the \a roSource using the typesetter \a roProgram with parameters
+	\a roParams. The input and output file names are added by the server.
+
+	Returns the job to wait for. The job is already finished, if the result was cached.
+*/
+QSharedPointer<CATypesetJob> CATypesetServer::typeset(const QString& roProgram, const QStringList& roParams, const QByteArray& roSource)
+{
+    QCryptographicHash oHash(QCryptographicHash::Sha1);
+    oHash.addData(workerKey(roProgram, roParams).toUtf8());
+    oHash.addData("\n", 1);
+    oHash.addData(roSource);
+    const QString oHashString = QString::fromLatin1(oHash.result().toHex());
+    const QString oResult = QDir(_oCacheDir).filePath(oHashString + "." + outputSuffix(roParams));
+
+    QSharedPointer<CATypesetJob> oJob(new CATypesetJob(oHashString, roProgram, roParams, roSource));
+
+    QMutexLocker oLocker(&_oMutex);
+    if (_oCacheFiles.contains(oResult) && QFile::exists(oResult)) {
+        insertIntoCache(oResult, oJob); // mark as recently used
+        oJob->finish(0, oResult, QByteArray());
+        return oJob;
+    }
+
+    if (_oPendingJobs.contains(oHashString)) {
+        return _oPendingJobs[oHashString];
+    }
+
+    _oPendingJobs[oHashString] = oJob;
+    _oQueue << oJob;
+    oLocker.unlock();
+
+    QMetaObject::invokeMethod(this, "processQueue", Qt::QueuedConnection);
+
+    return oJob;
+}
+
+/*!
+	Removes all the cached results, except the ones still used by a job.
+*/
+void CATypesetServer::clearCache()
+{
+    QMutexLocker oLocker(&_oMutex);
+    for (int i = 0; i < _oCacheFiles.size();) {
+        if (isInUse(_oCacheFiles[i])) {
+            i++;
+        } else {
+            QFile::remove(_oCacheFiles.takeAt(i));
+        }
+    }
+}
+
+/*!
+	Returns the suffix of the file the typesetter creates with the given parameters \a roParams.
+*/
+QString CATypesetServer::outputSuffix(const QStringList& roParams)
+{
+    return roParams.contains("-dbackend=svg") ? "svg" : "pdf";
+}
+
+QString CATypesetServer::workerKey(const QString& roProgram, const QStringList& roParams)
+{
+    return roProgram + "\n" + roParams.join("\n");
+}
+
+/*!
+	Sends the waiting jobs to the workers until maxRunningJobs() are running.
+*/
+void CATypesetServer::processQueue()
+{
+    int iRunning = 0;
+    for (int i = 0; i < _oWorkers.size(); i++) {
+        if (_oWorkers[i]->oJob) {
+            iRunning++;
+        }
+    }
+
+    while (iRunning < maxRunningJobs()) {
+        QSharedPointer<CATypesetJob> oJob;
+        {
+            QMutexLocker oLocker(&_oMutex);
+            if (_oQueue.isEmpty()) {
+                break;
+            }
+            oJob = _oQueue.takeFirst();
+        }
+
+        CATypesetWorker* poWorker = findWarmWorker(workerKey(oJob->program(), oJob->parameters()));
+        if (!poWorker) {
+            poWorker = startWorker(oJob->program(), oJob->parameters());
+        }
+
+        poWorker->oJob = oJob;
+        poWorker->poProcess->write(oJob->source());
+        poWorker->poProcess->closeWriteChannel();
+        iRunning++;
+    }
+}
+
+/*!
+	Starts a new typesetter process which waits for the source on its standard input.
+*/
+CATypesetServer::CATypesetWorker* CATypesetServer::startWorker(const QString& roProgram, const QStringList& roParams)
+{
+    CATypesetWorker* poWorker = new CATypesetWorker;
+    poWorker->poProcess = new QProcess(this);
+    poWorker->oKey = workerKey(roProgram, roParams);
+    poWorker->oOutputBase = QDir(_oCacheDir).filePath(QString("work-%1-%2").arg(QCoreApplication::applicationPid()).arg(_iNextWorker++));
+    _oWorkers << poWorker;
+
+    poWorker->poProcess->setProcessChannelMode(QProcess::MergedChannels);
+    poWorker->poProcess->setWorkingDirectory(_oCacheDir);
+    connect(poWorker->poProcess, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(workerFinished(int, QProcess::ExitStatus)));
+    connect(poWorker->poProcess, SIGNAL(error(QProcess::ProcessError)), this, SLOT(workerError(QProcess::ProcessError)));
+    poWorker->poProcess->start(roProgram, QStringList(roParams) << "-o" << poWorker->oOutputBase << "-");
+
+    return poWorker;
+}
+
+CATypesetServer::CATypesetWorker* CATypesetServer::findWorker(QProcess* poProcess)
+{
+    for (int i = 0; i < _oWorkers.size(); i++) {
+        if (_oWorkers[i]->poProcess == poProcess) {
+            return _oWorkers[i];
+        }
+    }
+    return nullptr;
+}
+
+/*!
+	Returns an idle running worker for the given \a roKey or Null, if there is none.
+*/
+CATypesetServer::CATypesetWorker* CATypesetServer::findWarmWorker(const QString& roKey)
+{
+    for (int i = 0; i < _oWorkers.size(); i++) {
+        if (!_oWorkers[i]->oJob && _oWorkers[i]->oKey == roKey && _oWorkers[i]->poProcess->state() != QProcess::NotRunning) {
+            return _oWorkers[i];
+        }
+    }
+    return nullptr;
+}
+
+void CATypesetServer::workerFinished(int iExitCode, QProcess::ExitStatus eExitStatus)
+{
+    CATypesetWorker* poWorker = findWorker(static_cast<QProcess*>(sender()));
+    if (poWorker) {
+        finishWorker(poWorker, (eExitStatus == QProcess::NormalExit) ? iExitCode : -1);
+    }
+}
+
+/*!
+	Finishes the worker, if the typesetter could not be started.
+	Crashes are handled by workerFinished().
+*/
+void CATypesetServer::workerError(QProcess::ProcessError eError)
+{
+    CATypesetWorker* poWorker = findWorker(static_cast<QProcess*>(sender()));
+    if (poWorker && eError == QProcess::FailedToStart) {
+        qCritical("TypesetServer: Could not run typesetter! Error %s", qPrintable(poWorker->poProcess->errorString()));
+        finishWorker(poWorker, -1);
+    }
+}
+
+/*!
+	Stores the result of the finished worker \a poWorker to the cache, finishes its job
+	and starts a new worker for the next request.
+*/
+void CATypesetServer::finishWorker(CATypesetWorker* poWorker, int iExitCode)
+{
+    _oWorkers.removeOne(poWorker);
+    QSharedPointer<CATypesetJob> oJob = poWorker->oJob;
+    QByteArray oOutput = poWorker->poProcess->readAll();
+    poWorker->poProcess->disconnect(this);
+    poWorker->poProcess->deleteLater();
+
+    if (oJob) {
+        const QString oSuffix = outputSuffix(oJob->parameters());
+        const QString oOutputFile = poWorker->oOutputBase + "." + oSuffix;
+        const QString oResult = QDir(_oCacheDir).filePath(oJob->hash() + "." + oSuffix);
+        if (!iExitCode && !QFile::exists(oOutputFile)) {
+            qCritical("TypesetServer: Typesetter did not create %s", qPrintable(oOutputFile));
+            iExitCode = -1;
+        }
+
+        {
+            QMutexLocker oLocker(&_oMutex);
+            if (!iExitCode) {
+                QFile::remove(oResult);
+                if (QFile::rename(oOutputFile, oResult)) {
+                    insertIntoCache(oResult, oJob);
+                } else {
+                    iExitCode = -1;
+                }
+            }
+            _oPendingJobs.remove(oJob->hash());
+        }
+
+        oJob->finish(iExitCode, (iExitCode ? QString() : oResult), oOutput);
+
+        // keep the typesetter warm for the next request, unless it cannot be run at all
+        if (iExitCode != -1 && !findWarmWorker(poWorker->oKey)) {
+            startWorker(oJob->program(), oJob->parameters());
+        }
+    }
+
+    // remove any other files the typesetter left behind
+    QDir oCacheDir(_oCacheDir);
+    QStringList oLeftovers = oCacheDir.entryList(QStringList() << QFileInfo(poWorker->oOutputBase).fileName() + "*", QDir::Files);
+    for (int i = 0; i < oLeftovers.size(); i++) {
+        oCacheDir.remove(oLeftovers[i]);
+    }
+
+    delete poWorker;
+
+    processQueue();
+}
+
+/*!
+	Adds \a roFileName returned by \a roJob as the most recently used cached file and
+	removes the oldest ones over maxCacheSize(). Files still used by a job are skipped
+	and removed by a later call. The mutex should be locked.
+*/
+void CATypesetServer::insertIntoCache(const QString& roFileName, const QSharedPointer<CATypesetJob>& roJob)
+{
+    _oCacheFiles.removeOne(roFileName);
+    _oCacheFiles << roFileName;
+    _oReaders.insert(roFileName, roJob.toWeakRef());
+
+    for (int i = 0; _oCacheFiles.size() > maxCacheSize() && i < _oCacheFiles.size() - 1;) {
+        if (isInUse(_oCacheFiles[i])) {
+            i++;
+        } else {
+            QFile::remove(_oCacheFiles.takeAt(i));
+        }
+    }
+}
+
+/*!
+	Returns true, if any job returning the cached file \a roFileName still exists.
+	Forgets the deleted jobs. The mutex should be locked.
+*/
+bool CATypesetServer::isInUse(const QString& roFileName)
+{
+    QMultiHash<QString, QWeakPointer<CATypesetJob>>::iterator i = _oReaders.find(roFileName);
+    while (i != _oReaders.end() && i.key() == roFileName) {
+        if (i.value().isNull()) {
+            i = _oReaders.erase(i);
+        } else {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*!
+	Kills the workers and moves the server to the thread destroying it.
+*/
+void CATypesetServer::stopWorkers()
+{
+    while (!_oWorkers.isEmpty()) {
+        CATypesetWorker* poWorker = _oWorkers.takeFirst();
+        poWorker->poProcess->disconnect(this);
+        poWorker->poProcess->kill();
+        poWorker->poProcess->waitForFinished();
+        if (poWorker->oJob) {
+            poWorker->oJob->finish(-1, QString(), QByteArray());
+        }
+        delete poWorker->poProcess;
+        delete poWorker;
+    }
+
+    QMutexLocker oLocker(&_oMutex);
+    while (!_oQueue.isEmpty()) {
+        _oQueue.takeFirst()->finish(-1, QString(), QByteArray());
+    }
+    _oPendingJobs.clear();
+
+    moveToThread(_poOwnerThread);
+}
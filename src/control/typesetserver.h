@@ -0,0 +1,119 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#ifndef TYPESET_SERVER_H
+#define TYPESET_SERVER_H
+
+// Includes
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QProcess>
+#include <QMultiHash>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QWaitCondition>
+#include <QWeakPointer>
+
+// Forward declarations
+class QThread;
+
+// Single typesetting request of CATypesetServer, shared between the server and the waiting thread
+class CATypesetJob {
+public:
+    CATypesetJob(const QString& roHash, const QString& roProgram, const QStringList& roParams, const QByteArray& roSource);
+
+    bool waitForFinished(int iMSecs = -1);
+    bool isFinished();
+    int exitCode();
+    QString resultFileName();
+    QByteArray output();
+
+    inline const QString& hash() { return _oHash; }
+    inline const QString& program() { return _oProgram; }
+    inline const QStringList& parameters() { return _oParameters; }
+    inline const QByteArray& source() { return _oSource; }
+
+private:
+    friend class CATypesetServer;
+    void finish(int iExitCode, const QString& roResultFileName, const QByteArray& roOutput);
+
+    const QString _oHash; // Content hash used as the cache key
+    const QString _oProgram; // Typesetter executable
+    const QStringList _oParameters; // Typesetter parameters without the input and output file names
+    const QByteArray _oSource; // Exported document to be typeset
+
+    QMutex _oMutex; // Guards the result members below
+    QWaitCondition _oFinished;
+    bool _bFinished;
+    int _iExitCode;
+    QString _oResultFileName; // Typeset file in the cache directory
+    QByteArray _oOutput; // Typesetter console output
+};
+
+class CATypesetServer : public QObject {
+    Q_OBJECT
+
+public:
+    CATypesetServer(const QString& roCacheDir);
+    ~CATypesetServer();
+
+    QSharedPointer<CATypesetJob> typeset(const QString& roProgram, const QStringList& roParams, const QByteArray& roSource);
+    void clearCache();
+
+    inline const QString& cacheDir() { return _oCacheDir; }
+    inline int maxRunningJobs() { return _iMaxRunningJobs; }
+    inline void setMaxRunningJobs(int iMax) { _iMaxRunningJobs = iMax; }
+    inline int maxCacheSize() { return _iMaxCacheSize; }
+    inline void setMaxCacheSize(int iMax) { _iMaxCacheSize = iMax; }
+
+    static QString outputSuffix(const QStringList& roParams);
+
+private slots:
+    void processQueue();
+    void workerFinished(int iExitCode, QProcess::ExitStatus eExitStatus);
+    void workerError(QProcess::ProcessError eError);
+    void stopWorkers();
+
+private:
+    // Typesetter process started in advance, waiting for the source on its standard input
+    struct CATypesetWorker {
+        QProcess* poProcess;
+        QString oKey; // program and parameters, see workerKey()
+        QString oOutputBase; // output file name without the suffix
+        QSharedPointer<CATypesetJob> oJob; // null while the worker is warm
+    };
+
+    static QString workerKey(const QString& roProgram, const QStringList& roParams);
+    CATypesetWorker* startWorker(const QString& roProgram, const QStringList& roParams);
+    CATypesetWorker* findWorker(QProcess* poProcess);
+    CATypesetWorker* findWarmWorker(const QString& roKey);
+    void finishWorker(CATypesetWorker* poWorker, int iExitCode);
+    void insertIntoCache(const QString& roFileName, const QSharedPointer<CATypesetJob>& roJob);
+    bool isInUse(const QString& roFileName);
+
+    QThread* _poThread; // Thread the workers and their processes live in
+    QThread* _poOwnerThread; // Thread destroying the server
+    QString _oCacheDir;
+    int _iMaxRunningJobs;
+    int _iMaxCacheSize;
+    int _iNextWorker;
+
+    // Accessed by the server thread only
+    QList<CATypesetWorker*> _oWorkers;
+
+    // Shared with the requesting threads, guarded by _oMutex
+    QMutex _oMutex;
+    QList<QSharedPointer<CATypesetJob>> _oQueue; // waiting jobs
+    QHash<QString, QSharedPointer<CATypesetJob>> _oPendingJobs; // queued and running jobs by hash
+    QStringList _oCacheFiles; // cached files, least recently used first
+    QMultiHash<QString, QWeakPointer<CATypesetJob>> _oReaders; // finished jobs returning a cached file
+};
+
+#endif // TYPESET_SERVER_H
@@ -9,6 +9,8 @@
 #include <QRegExp>
 #include <QString>
 #include <QTemporaryFile>
+#include <QThread>
+#include <QThreadPool>
 #include <zlib.h>
 
 #ifdef Q_OS_WIN
@@ -29,6 +31,8 @@
 */
 
 const int CAArchive::CHUNK = 16384;
+const int CAArchive::BLOCK = 131072; // size of a block compressed by a single thread
+const int CAArchive::DICTIONARY = 32768; // deflate window primed from the previous block
 const QString CAArchive::COMMENT = "Canorus Archive v" + QString(CANORUS_VERSION).remove(QRegExp("[a-z]*$"));
 
 /*!
@@ -36,6 +40,8 @@ const QString CAArchive::COMMENT = "Canorus Archive v" + QString(CANORUS_VERSION
 */
 CAArchive::CAArchive()
     : _err(false)
+    , _compressionLevel(Z_DEFAULT_COMPRESSION)
+    , _parallelCompression(false)
 {
     _tar = new CATar();
 }
@@ -45,6 +51,8 @@ CAArchive::CAArchive()
 */
 CAArchive::CAArchive(QIODevice& arch)
     : _err(false)
+    , _compressionLevel(Z_DEFAULT_COMPRESSION)
+    , _parallelCompression(false)
 {
     parse(arch);
 }
@@ -152,16 +160,15 @@ void CAArchive::parse(QIODevice& arch)
 /*!
 	Write the tar.gz archive into the given device.
 	Returns the number of byte written, or -1 on error.
-*/
 
+	If parallelCompression() is set and the tar is larger than a single
+	block, the tar is deflated in blocks on a thread pool of its own.
+	\sa writeParallel(), writeSerial()
+*/
 qint64 CAArchive::write(QIODevice& dest)
 {
     bool close = false;
-    int ret, flush;
-    qint64 total = 0, read;
-    z_stream strm;
-    gz_header header = gz_header();
-    QBuffer in, out;
+    qint64 total;
 
     if (!dest.isOpen()) {
         if (!dest.open(QIODevice::WriteOnly))
@@ -175,6 +182,28 @@ qint64 CAArchive::write(QIODevice& dest)
         return -1;
     }
 
+    if (parallelCompression() && QThread::idealThreadCount() > 1 && _tar->size() > BLOCK)
+        total = writeParallel(dest);
+    else
+        total = writeSerial(dest);
+
+    if (close)
+        dest.close();
+    return total;
+}
+
+/*!
+	Compresses the tar in chunks using a single deflate stream on the calling thread.
+	Returns the number of byte written, or -1 on error.
+*/
+qint64 CAArchive::writeSerial(QIODevice& dest)
+{
+    int ret, flush;
+    qint64 total = 0, read;
+    z_stream strm;
+    gz_header header = gz_header();
+    QBuffer in, out;
+
     header.os = getOS();
     header.comment = new unsigned char[COMMENT.size() + 1];
     // The code purposely could cut contents of the array.
@@ -188,13 +217,11 @@ qint64 CAArchive::write(QIODevice& dest)
     strm.zalloc = Z_NULL;
     strm.zfree = Z_NULL;
     strm.opaque = Z_NULL;
-    ret = deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 31, 8, Z_DEFAULT_STRATEGY);
+    ret = deflateInit2(&strm, compressionLevel(), Z_DEFLATED, 31, 8, Z_DEFAULT_STRATEGY);
     ret = (ret == Z_OK) ? deflateSetHeader(&strm, &header) : ret;
     if (ret != Z_OK) {
         deflateEnd(&strm);
         delete[] header.comment;
-        if (close)
-            dest.close();
         in.close();
         out.close();
         return -1;
@@ -238,14 +265,163 @@ qint64 CAArchive::write(QIODevice& dest)
         _err = true;
 
     delete[] header.comment;
-    if (close)
-        dest.close();
     _tar->close(in);
     in.close();
     out.close();
     return (_err) ? -1 : total;
 }
 
+/*!
+	\class CAArchiveBlock
+	\brief Deflates a single block of the tar for CAArchive::writeParallel()
+
+	Each block is compressed as raw deflate data primed with the last
+	CAArchive::DICTIONARY bytes of the previous block. All but the last block
+	are terminated with a sync flush, so the blocks are byte aligned and their
+	concatenation is one valid deflate stream.
+*/
+class CAArchiveBlock : public QRunnable {
+public:
+    CAArchiveBlock(const char* data, int size, const char* dictionary, int dictionarySize, int level, bool last)
+        : _data(data)
+        , _size(size)
+        , _dictionary(dictionary)
+        , _dictionarySize(dictionarySize)
+        , _level(level)
+        , _last(last)
+        , _crc(0)
+        , _ok(false)
+    {
+        setAutoDelete(false);
+    }
+
+    void run()
+    {
+        int ret;
+        z_stream strm;
+        strm.zalloc = Z_NULL;
+        strm.zfree = Z_NULL;
+        strm.opaque = Z_NULL;
+
+        _crc = crc32(0L, reinterpret_cast<const Bytef*>(_data), static_cast<uInt>(_size));
+
+        // negative window bits: raw deflate, the gzip wrapper is written by CAArchive
+        if (deflateInit2(&strm, _level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            return;
+        if (_dictionarySize)
+            deflateSetDictionary(&strm, reinterpret_cast<const Bytef*>(_dictionary), static_cast<uInt>(_dictionarySize));
+
+        // deflateBound() does not count the sync flush marker
+        _out.resize(static_cast<int>(deflateBound(&strm, static_cast<uLong>(_size))) + 16);
+        strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(_data));
+        strm.avail_in = static_cast<uInt>(_size);
+        strm.next_out = reinterpret_cast<Bytef*>(_out.data());
+        strm.avail_out = static_cast<uInt>(_out.size());
+
+        do {
+            if (strm.avail_out == 0) {
+                int written = _out.size();
+                _out.resize(written + CAArchive::CHUNK);
+                strm.next_out = reinterpret_cast<Bytef*>(_out.data() + written);
+                strm.avail_out = CAArchive::CHUNK;
+            }
+            ret = deflate(&strm, _last ? Z_FINISH : Z_SYNC_FLUSH);
+        } while ((ret == Z_OK || ret == Z_BUF_ERROR) && (_last || strm.avail_out == 0));
+
+        _out.resize(_out.size() - static_cast<int>(strm.avail_out));
+        _ok = _last ? (ret == Z_STREAM_END) : (ret == Z_OK && strm.avail_in == 0);
+        deflateEnd(&strm);
+    }
+
+    inline const QByteArray& out() { return _out; }
+    inline quint32 crc() { return _crc; }
+    inline int size() { return _size; }
+    inline bool ok() { return _ok; }
+
+private:
+    const char* _data;
+    int _size;
+    const char* _dictionary;
+    int _dictionarySize;
+    int _level;
+    bool _last;
+    QByteArray _out;
+    quint32 _crc;
+    bool _ok;
+};
+
+/*!
+	Compresses the tar pigz-style: the tar is split into BLOCK sized blocks
+	which are deflated concurrently on a local QThreadPool and written out
+	as a single gzip member with a combined CRC, so any gzip reader can read it.
+	Returns the number of byte written, or -1 on error.
+*/
+qint64 CAArchive::writeParallel(QIODevice& dest)
+{
+    QBuffer tar;
+    tar.open(QIODevice::ReadWrite);
+    _tar->open(tar);
+    if (_tar->write(tar) == -1)
+        _err = true;
+    _tar->close(tar);
+    if (_err)
+        return -1;
+
+    // A pool of our own, so we only wait for our blocks and never for
+    // unrelated tasks (exports, imports, typesetting) on the global pool.
+    QThreadPool pool;
+    const QByteArray& data = tar.buffer();
+    QList<CAArchiveBlock*> blocks;
+    for (int pos = 0; pos < data.size(); pos += BLOCK) {
+        int dictionarySize = qMin(pos, DICTIONARY);
+        CAArchiveBlock* block = new CAArchiveBlock(data.constData() + pos, qMin(BLOCK, data.size() - pos),
+            data.constData() + pos - dictionarySize, dictionarySize,
+            compressionLevel(), pos + BLOCK >= data.size());
+        blocks << block;
+        pool.start(block);
+    }
+    pool.waitForDone();
+
+    // gzip header, RFC 1952
+    QByteArray header;
+    header.append('\x1f').append('\x8b'); // ID1, ID2
+    header.append('\x08'); // CM: deflate
+    header.append('\x10'); // FLG: FCOMMENT
+    header.append(QByteArray(4, '\0')); // MTIME: not available
+    header.append(compressionLevel() == 9 ? '\x02' : (compressionLevel() == 1 ? '\x04' : '\0')); // XFL
+    header.append(static_cast<char>(getOS()));
+    header.append(COMMENT.toLatin1()).append('\0');
+
+    qint64 total = dest.write(header);
+    if (total != header.size())
+        _err = true;
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    for (int i = 0; i < blocks.size(); i++) {
+        if (!_err && blocks[i]->ok() && dest.write(blocks[i]->out()) == blocks[i]->out().size()) {
+            total += blocks[i]->out().size();
+            crc = crc32_combine(crc, blocks[i]->crc(), blocks[i]->size());
+        } else {
+            _err = true;
+        }
+        delete blocks[i];
+    }
+
+    // gzip trailer: CRC32 and ISIZE, both little endian
+    char trailer[8];
+    quint32 isize = static_cast<quint32>(data.size());
+    for (int i = 0; i < 4; i++) {
+        trailer[i] = static_cast<char>((crc >> (8 * i)) & 0xff);
+        trailer[4 + i] = static_cast<char>((isize >> (8 * i)) & 0xff);
+    }
+    if (!_err && dest.write(trailer, 8) == 8)
+        total += 8;
+    else
+        _err = true;
+
+    return (_err) ? -1 : total;
+}
+
 /*!
 	Return an operating system ID for use in a GZip header. 
 	See RFC 1952.
@@ -16,6 +16,8 @@ class QByteArray;
 class QString;
 
 class CAArchive {
+    friend class CAArchiveBlock;
+
 public:
     CAArchive();
     CAArchive(QIODevice& arch);
@@ -52,13 +54,24 @@ public:
     inline bool error() { return _err || _tar->error(); }
     inline const QString& version() { return _version; }
 
+    inline int compressionLevel() { return _compressionLevel; }
+    inline void setCompressionLevel(int level) { _compressionLevel = qBound(-1, level, 9); }
+    inline bool parallelCompression() { return _parallelCompression; }
+    inline void setParallelCompression(bool p) { _parallelCompression = p; }
+
 protected:
     static const int CHUNK;
+    static const int BLOCK;
+    static const int DICTIONARY;
     static const QString COMMENT;
 
     QString _version;
     bool _err;
+    int _compressionLevel;
+    bool _parallelCompression;
     void parse(QIODevice&);
+    qint64 writeSerial(QIODevice& dest);
+    qint64 writeParallel(QIODevice& dest);
     int getOS();
 
     CATar* _tar;
@@ -8,12 +8,13 @@
 #include "core/autorecovery.h"
 
 #include "canorus.h"
+#include "core/exportqueue.h"
 #include "core/settings.h"
 #include "export/canorusmlexport.h"
 #include "import/canorusmlimport.h"
+#include <QDir>
 #include <QFile>
 #include <QMessageBox>
-#include <QSet>
 #include <QTimer>
 
 /*!
@@ -37,7 +38,9 @@
 	manually deleted.
 
 	Call saveRecovery() to save the currently opened documents to recovery files. The
-	autosave timer's signal is connected to this slot.
+	autosave timer's signal is connected to this slot. Each document keeps its recovery
+	file while it is open and documents not modified since their last recovery save
+	(see CADocument::revision()) are skipped, so idle documents are not cloned again.
 
 	Settings class should already be initialized when creating instance of this class.
 */
@@ -47,10 +50,12 @@
 */
 CAAutoRecovery::CAAutoRecovery()
     : _saveAfterRecoveryTimer(nullptr)
+    , _nextRecoveryFile(0)
 {
     _autoRecoveryTimer = new QTimer(this);
     _autoRecoveryTimer->setSingleShot(false);
     connect(_autoRecoveryTimer, SIGNAL(timeout()), this, SLOT(saveRecovery()));
+    connect(CACanorus::exportQueue(), SIGNAL(jobFinished(int, int)), this, SLOT(onRecoveryJobFinished(int, int)));
     updateTimer(); // reads interval from settings and starts the timer
 }
 
@@ -72,39 +77,95 @@ void CAAutoRecovery::updateTimer()
 
 /*!
 	Saves the currently opened documents into settings folder named recovery0, recovery1 etc.
+	Documents which have not changed since their last recovery save are skipped.
 */
 void CAAutoRecovery::saveRecovery()
 {
-    cleanupRecovery();
-
-    QSet<CADocument*> documents;
+    QList<CADocument*> documents;
     for (int i = 0; i < CACanorus::mainWinList().size(); i++)
-        documents << CACanorus::mainWinList()[i]->document();
-
-    int c = 0;
-    for (QSet<CADocument*>::const_iterator i = documents.constBegin(); i != documents.constEnd(); i++, c++) {
-        CACanorusMLExport save;
-        save.setStreamToFile(CASettings::defaultSettingsPath() + "/recovery" + QString::number(c));
-        save.exportDocument(*i);
-        save.wait();
+        if (!documents.contains(CACanorus::mainWinList()[i]->document()))
+            documents << CACanorus::mainWinList()[i]->document();
+
+    // Remove recovery files of closed documents
+    for (QHash<CADocument*, QString>::iterator i = _recoveryFiles.begin(); i != _recoveryFiles.end();) {
+        if (!documents.contains(i.key()) && !_recoveryJobs.values().contains(i.key())) {
+            removeRecoveryFile(i.value());
+            _recoveryRevisions.remove(i.key());
+            i = _recoveryFiles.erase(i);
+        } else {
+            i++;
+        }
+    }
+
+    // Documents are saved in background from their snapshots
+    for (CADocument* doc : documents) {
+        if (_recoveryRevisions.contains(doc) && _recoveryRevisions[doc] == doc->revision())
+            continue; // recovery file is up to date
+        if (_recoveryJobs.values().contains(doc))
+            continue; // previous save still running, retry next time
+
+        if (!_recoveryFiles.contains(doc))
+            _recoveryFiles[doc] = CASettings::defaultSettingsPath() + "/recovery" + QString::number(_nextRecoveryFile++);
+
+        CACanorusMLExport* save = new CACanorusMLExport();
+        save->setStreamToFile(_recoveryFiles[doc]);
+        _recoveryRevisions[doc] = doc->revision();
+        _recoveryJobs[CACanorus::exportQueue()->exportDocument(save, doc)] = doc;
     }
 }
 
+/*!
+	Forgets the saved revision, if the recovery save \a job failed, so the
+	document is saved again next time.
+*/
+void CAAutoRecovery::onRecoveryJobFinished(int job, int status)
+{
+    if (!_recoveryJobs.contains(job))
+        return;
+
+    CADocument* doc = _recoveryJobs.take(job);
+    if (status != 0)
+        _recoveryRevisions.remove(doc);
+}
+
 /*!
 	Deletes recovery files.
 	This method is usually called when successfully quiting Canorus.
 */
 void CAAutoRecovery::cleanupRecovery()
 {
-    for (int i = 0; QFile::exists(CASettings::defaultSettingsPath() + "/recovery" + QString::number(i)); i++) {
-        QString fileName = CASettings::defaultSettingsPath() + "/recovery" + QString::number(i);
-        QFile::remove(fileName);
-        if (QDir(fileName + " files").exists()) {
-            foreach (QString entry, QDir(fileName + " files").entryList(QDir::Files)) {
-                QFile::remove(fileName + " files/" + entry);
-            }
-            QDir().rmdir(fileName + " files");
+    for (const QString& fileName : recoveryFiles())
+        removeRecoveryFile(fileName);
+
+    _recoveryFiles.clear();
+    _recoveryRevisions.clear();
+}
+
+/*!
+	Returns the recovery files in the settings folder, including the ones left
+	behind by a previous session.
+*/
+QStringList CAAutoRecovery::recoveryFiles()
+{
+    QDir dir(CASettings::defaultSettingsPath());
+    QStringList files;
+    for (const QString& entry : dir.entryList(QStringList() << "recovery*", QDir::Files, QDir::Name))
+        files << dir.absoluteFilePath(entry);
+
+    return files;
+}
+
+/*!
+	Deletes the recovery file \a fileName and its resources.
+*/
+void CAAutoRecovery::removeRecoveryFile(const QString& fileName)
+{
+    QFile::remove(fileName);
+    if (QDir(fileName + " files").exists()) {
+        foreach (QString entry, QDir(fileName + " files").entryList(QDir::Files)) {
+            QFile::remove(fileName + " files/" + entry);
         }
+        QDir().rmdir(fileName + " files");
     }
 }
 
@@ -115,9 +176,9 @@ void CAAutoRecovery::cleanupRecovery()
 void CAAutoRecovery::openRecovery()
 {
     QString documents;
-    for (int i = 0; QFile::exists(CASettings::defaultSettingsPath() + "/recovery" + QString::number(i)); i++) {
+    for (const QString& fileName : recoveryFiles()) {
         CACanorusMLImport open;
-        open.setStreamFromFile(CASettings::defaultSettingsPath() + "/recovery" + QString::number(i));
+        open.setStreamFromFile(fileName);
         open.importDocument();
         open.wait(_recoveryTimeout);
         if (open.importedDocument()) {
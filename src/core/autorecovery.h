@@ -8,9 +8,12 @@
 #ifndef AUTOSAVE_H_
 #define AUTOSAVE_H_
 
+#include <QHash>
 #include <QObject>
+#include <QStringList>
 
 class QTimer;
+class CADocument;
 
 class CAAutoRecovery : public QObject {
     Q_OBJECT
@@ -25,10 +28,21 @@ public slots:
     void cleanupRecovery();
     void saveRecovery();
 
+private slots:
+    void onRecoveryJobFinished(int job, int status);
+
 private:
+    QStringList recoveryFiles();
+    void removeRecoveryFile(const QString& fileName);
+
     QTimer* _autoRecoveryTimer;
     QTimer* _saveAfterRecoveryTimer;
 
+    QHash<CADocument*, QString> _recoveryFiles; // recovery file of each open document
+    QHash<CADocument*, unsigned int> _recoveryRevisions; // document revision stored in the recovery file
+    QHash<int, CADocument*> _recoveryJobs; // running export jobs
+    int _nextRecoveryFile;
+
     const int _recoveryTimeout = 120000;
 };
 
@@ -0,0 +1,415 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMutex>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include <iostream>
+#include <memory>
+
+#include "core/batchconverter.h"
+#include "export/canexport.h"
+#include "export/canorusmlexport.h"
+#include "export/lilypondexport.h"
+#include "export/midiexport.h"
+#include "export/musicxmlexport.h"
+#include "export/pdfexport.h"
+#include "export/svgexport.h"
+#include "import/canimport.h"
+#include "import/canorusmlimport.h"
+#include "import/midiimport.h"
+#include "import/musicxmlimport.h"
+#include "import/mxlimport.h"
+#include "score/document.h"
+#include "score/sheet.h"
+
+/*!
+	\class CABatchConverter
+	\brief Converts score files from the command line without the GUI
+
+	Started by main() when Canorus is run with the \c --convert switch:
+	\code
+	  canorus --convert "*.xml" other.can --to ly --jobs 8 --output-dir out
+	\endcode
+
+	Only the settings are loaded; translations, scripting, fonts, help and the
+	main window are not initialized. Every input file is imported and exported
+	by a CAImport and CAExport filter in a single job. The jobs run in parallel
+	on the converter's own QThreadPool and the filters work synchronously in the
+	job's thread. The global pool is left for the filters themselves, CAArchive
+	compresses .can files on it.
+
+	The output file is written next to the input file (or to the output
+	directory) with the extension of the target format. Formats which can only
+	export a sheet (LilyPond and MusicXML) write one file per sheet, numbered if
+	there are more sheets.
+
+	Wildcards in the file names are expanded by the converter as well, so quoted
+	patterns avoid the shell's limit on the argument length.
+
+	\sa CAImport, CAExport
+*/
+
+const int CABatchConverter::USAGE_ERROR = 2;
+const int CABatchConverter::CONVERT_ERROR = 1;
+
+/*!
+	\class CAConvertJob
+	\brief Converts a single file for CABatchConverter::convert()
+*/
+class CAConvertJob : public QRunnable {
+public:
+    CAConvertJob(const QString& inputFile, const QString& format, const QString& outputDir)
+        : _inputFile(inputFile)
+        , _format(format)
+        , _outputDir(outputDir)
+        , _ok(false)
+    {
+        setAutoDelete(false);
+    }
+
+    void run()
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        _ok = convert();
+
+        report(timer.elapsed());
+    }
+
+    inline bool isOk() const { return _ok; }
+
+private:
+    bool convert();
+    bool exportTo(CAExport* exp, const QString& fileName, CADocument* doc, CASheet* sheet);
+    QString outputFile(int sheet, int sheetCount);
+    void report(qint64 elapsed);
+
+    QString _inputFile;
+    QString _format;
+    QString _outputDir;
+
+    bool _ok;
+    QString _error;
+    QStringList _outputFiles;
+    qint64 _importTime;
+
+    static QMutex _reportMutex; // keeps the report lines of the parallel jobs whole
+};
+
+QMutex CAConvertJob::_reportMutex;
+
+/*!
+	Imports the input file and exports it to the target format.
+	Returns True, if all the output files were written.
+*/
+bool CAConvertJob::convert()
+{
+    QElapsedTimer timer;
+    timer.start();
+    _importTime = 0;
+
+    if (!QFileInfo(_inputFile).isFile()) {
+        _error = QCoreApplication::translate("CABatchConverter", "File not found");
+        return false;
+    }
+
+    std::unique_ptr<CAImport> import(CABatchConverter::createImport(_inputFile));
+    if (!import) {
+        _error = QCoreApplication::translate("CABatchConverter", "Unknown input format");
+        return false;
+    }
+
+    import->setStreamFromFile(_inputFile);
+    import->importDocument(false);
+    std::unique_ptr<CADocument> doc(import->importedDocument());
+    if (import->status() != 0 || !doc) {
+        _error = import->readableStatus();
+        return false;
+    }
+    _importTime = timer.elapsed();
+
+    if (CABatchConverter::exportsSheets(_format)) {
+        if (doc->sheetList().isEmpty()) {
+            _error = QCoreApplication::translate("CABatchConverter", "The document has no sheets");
+            return false;
+        }
+
+        for (int i = 0; i < doc->sheetList().size(); i++) {
+            std::unique_ptr<CAExport> exp(CABatchConverter::createExport(_format));
+            if (!exportTo(exp.get(), outputFile(i, doc->sheetList().size()), nullptr, doc->sheetList()[i]))
+                return false;
+        }
+
+        return true;
+    }
+
+    std::unique_ptr<CAExport> exp(CABatchConverter::createExport(_format));
+    return exportTo(exp.get(), outputFile(0, 1), doc.get(), nullptr);
+}
+
+/*!
+	Exports either the document \a doc or the \a sheet to \a fileName using the
+	filter \a exp in the calling thread.
+*/
+bool CAConvertJob::exportTo(CAExport* exp, const QString& fileName, CADocument* doc, CASheet* sheet)
+{
+    if (fileName.isEmpty())
+        return false;
+
+    exp->setStreamToFile(fileName);
+    if (doc)
+        exp->exportDocument(doc, false);
+    else
+        exp->exportSheet(sheet, false);
+
+    if (exp->status() != 0) {
+        _error = exp->readableStatus();
+        return false;
+    }
+
+    _outputFiles << fileName;
+    return true;
+}
+
+/*!
+	Returns the name of the output file for the given \a sheet, or an empty
+	string if it would overwrite the input file.
+*/
+QString CAConvertJob::outputFile(int sheet, int sheetCount)
+{
+    QFileInfo input(_inputFile);
+    QString dir = _outputDir.isEmpty() ? input.absolutePath() : QDir(_outputDir).absolutePath();
+    QString name = input.completeBaseName();
+    if (sheetCount > 1)
+        name += QString("-%1").arg(sheet + 1);
+
+    QString fileName = dir + "/" + name + "." + _format;
+    if (QFileInfo(fileName).absoluteFilePath() == input.absoluteFilePath()) {
+        _error = QCoreApplication::translate("CABatchConverter", "The output would overwrite the input file");
+        return QString();
+    }
+
+    return fileName;
+}
+
+/*!
+	Prints the result and timing of the job. Successful conversions are printed to
+	the standard output, failures to the standard error.
+*/
+void CAConvertJob::report(qint64 elapsed)
+{
+    QMutexLocker locker(&_reportMutex);
+    if (_ok) {
+        std::cout << qPrintable(QString("%1 ms (import %2 ms, export %3 ms)\t%4 -> %5")
+                                    .arg(elapsed, 6)
+                                    .arg(_importTime)
+                                    .arg(elapsed - _importTime)
+                                    .arg(_inputFile)
+                                    .arg(_outputFiles.join(", ")))
+                  << std::endl;
+    } else {
+        std::cerr << qPrintable(QString("%1 ms FAILED\t%2: %3").arg(elapsed, 6).arg(_inputFile).arg(_error)) << std::endl;
+    }
+}
+
+CABatchConverter::CABatchConverter()
+    : _maxThreadCount(QThread::idealThreadCount())
+{
+}
+
+/*!
+	Returns True, if the command line arguments \a argv contain the \c --convert
+	switch. This is checked before any application object is created.
+*/
+bool CABatchConverter::isRequested(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; i++) {
+        if (QString(argv[i]) == "--convert")
+            return true;
+    }
+
+    return false;
+}
+
+/*!
+	Reads the input files, the target format and the options from the command
+	line arguments \a args, including the program name.
+
+	Returns False and prints the reason, if the arguments are wrong.
+*/
+bool CABatchConverter::parseArguments(const QStringList& args)
+{
+    bool files = false;
+    for (int i = 1; i < args.size(); i++) {
+        const QString& arg = args[i];
+        if (arg == "--convert") {
+            files = true;
+        } else if (arg == "--to" && i + 1 < args.size()) {
+            _outputFormat = args[++i].toLower();
+        } else if ((arg == "--jobs" || arg == "-j") && i + 1 < args.size()) {
+            _maxThreadCount = qMax(args[++i].toInt(), 1);
+        } else if (arg == "--output-dir" && i + 1 < args.size()) {
+            _outputDir = args[++i];
+        } else if (arg.startsWith('-')) {
+            std::cerr << qPrintable(QString("Unknown option %1").arg(arg)) << std::endl;
+            return false;
+        } else if (files) {
+            addInput(arg);
+        }
+    }
+
+    // accept the format names besides the file extensions
+    if (_outputFormat == "canorusml")
+        _outputFormat = "xml";
+    else if (_outputFormat == "lilypond")
+        _outputFormat = "ly";
+    else if (_outputFormat == "midi")
+        _outputFormat = "mid";
+
+    std::unique_ptr<CAExport> exp(createExport(_outputFormat));
+    if (!exp) {
+        std::cerr << qPrintable(QString("Unknown output format \"%1\"").arg(_outputFormat)) << std::endl;
+        return false;
+    }
+    if (_inputFiles.isEmpty()) {
+        std::cerr << "No input files" << std::endl;
+        return false;
+    }
+    if (!_outputDir.isEmpty() && !QDir().mkpath(_outputDir)) {
+        std::cerr << qPrintable(QString("Cannot create the output directory %1").arg(_outputDir)) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+	Adds the file name or the wildcard \a pattern to the input files.
+	Wildcards are only expanded in the file name, not in the directory.
+*/
+void CABatchConverter::addInput(const QString& pattern)
+{
+    QFileInfo info(pattern);
+    QString name = info.fileName();
+    if (!name.contains('*') && !name.contains('?') && !name.contains('[')) {
+        _inputFiles << pattern;
+        return;
+    }
+
+    QDir dir(info.path());
+    QStringList files = dir.entryList(QStringList(name), QDir::Files, QDir::Name);
+    if (files.isEmpty())
+        std::cerr << qPrintable(QString("No files match %1").arg(pattern)) << std::endl;
+
+    for (const QString& file : files)
+        _inputFiles << (info.path() == "." && !pattern.startsWith("./") ? file : dir.filePath(file));
+}
+
+/*!
+	Converts all the input files on a thread pool and prints the summary.
+	Returns 0 if all the files were converted, CONVERT_ERROR otherwise.
+*/
+int CABatchConverter::convert()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(_maxThreadCount);
+
+    QList<CAConvertJob*> jobs;
+    for (const QString& file : _inputFiles) {
+        CAConvertJob* job = new CAConvertJob(file, _outputFormat, _outputDir);
+        jobs << job;
+        pool.start(job);
+    }
+    pool.waitForDone();
+
+    int converted = 0;
+    for (CAConvertJob* job : jobs) {
+        if (job->isOk())
+            converted++;
+    }
+    qDeleteAll(jobs);
+
+    std::cout << qPrintable(QString("Converted %1 of %2 files in %3 ms using %4 threads.")
+                                .arg(converted)
+                                .arg(_inputFiles.size())
+                                .arg(timer.elapsed())
+                                .arg(_maxThreadCount))
+              << std::endl;
+
+    return (converted == _inputFiles.size()) ? 0 : CONVERT_ERROR;
+}
+
+void CABatchConverter::printUsage()
+{
+    std::cout << "Usage: canorus --convert <files> --to <format> [--jobs <n>] [--output-dir <dir>]" << std::endl
+              << "  Input formats:  xml (CanorusML), can, musicxml, mxl, mid" << std::endl
+              << "  Output formats: xml (CanorusML), can, ly, musicxml, mid, pdf, svg" << std::endl;
+}
+
+/*!
+	Returns a new import filter for the file \a fileName according to its
+	extension or null, if the format cannot be imported.
+*/
+CAImport* CABatchConverter::createImport(const QString& fileName)
+{
+    QString suffix = QFileInfo(fileName).suffix().toLower();
+    if (suffix == "xml")
+        return new CACanorusMLImport();
+    if (suffix == "can")
+        return new CACanImport();
+    if (suffix == "musicxml")
+        return new CAMusicXmlImport();
+    if (suffix == "mxl")
+        return new CAMXLImport();
+    if (suffix == "mid" || suffix == "midi")
+        return new CAMidiImport();
+
+    return nullptr;
+}
+
+/*!
+	Returns a new export filter for the given \a format extension or null, if
+	the format is unknown.
+*/
+CAExport* CABatchConverter::createExport(const QString& format)
+{
+    if (format == "xml")
+        return new CACanorusMLExport();
+    if (format == "can")
+        return new CACanExport();
+    if (format == "ly")
+        return new CALilyPondExport();
+    if (format == "musicxml")
+        return new CAMusicXmlExport();
+    if (format == "mid")
+        return new CAMidiExport();
+    if (format == "pdf")
+        return new CAPDFExport();
+    if (format == "svg")
+        return new CASVGExport();
+
+    return nullptr;
+}
+
+/*!
+	Returns True, if the export filter of the \a format only exports single sheets.
+*/
+bool CABatchConverter::exportsSheets(const QString& format)
+{
+    return format == "ly" || format == "musicxml";
+}
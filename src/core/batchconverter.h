@@ -0,0 +1,48 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#ifndef BATCHCONVERTER_H_
+#define BATCHCONVERTER_H_
+
+#include <QString>
+#include <QStringList>
+
+class CAImport;
+class CAExport;
+
+class CABatchConverter {
+public:
+    CABatchConverter();
+
+    static bool isRequested(int argc, char* argv[]);
+    bool parseArguments(const QStringList& args);
+    int convert();
+    static void printUsage();
+
+    inline const QStringList& inputFiles() const { return _inputFiles; }
+    inline const QString& outputFormat() const { return _outputFormat; }
+    inline const QString& outputDir() const { return _outputDir; }
+    inline int maxThreadCount() const { return _maxThreadCount; }
+    inline void setMaxThreadCount(int count) { _maxThreadCount = count; }
+
+    static CAImport* createImport(const QString& fileName);
+    static CAExport* createExport(const QString& format);
+    static bool exportsSheets(const QString& format);
+
+    static const int USAGE_ERROR; // exit code for wrong arguments
+    static const int CONVERT_ERROR; // exit code when any of the files failed
+
+private:
+    void addInput(const QString& pattern);
+
+    QStringList _inputFiles;
+    QString _outputFormat;
+    QString _outputDir;
+    int _maxThreadCount;
+};
+
+#endif /* BATCHCONVERTER_H_ */
@@ -0,0 +1,305 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#include <QSet>
+#include <algorithm>
+
+#include "core/clipboardbuffer.h"
+#include "score/articulation.h"
+#include "score/barline.h"
+#include "score/note.h"
+#include "score/rest.h"
+#include "score/sheet.h"
+#include "score/slur.h"
+#include "score/staff.h"
+#include "score/voice.h"
+
+/*!
+	\class CAClipboardBuffer
+	\brief Compact clipboard representation of the copied staff elements
+
+	Copying a selection used to clone every element into a new set of contexts and
+	pasting cloned them once again. This class stores the copied elements as a flat
+	column buffer instead: one row per element with its type, time, length, pitch and
+	marks. No music elements are created until the buffer is pasted.
+
+	Rows are grouped into tracks, one for each copied voice, and tracks into staffs.
+	The elements of a track are created and inserted into the target voice in a single
+	pass by paste(), see CAVoice::insert(CAMusElement*, const QList<CAMusElement*>&).
+
+	Only notes, rests and barlines with articulations and ties are supported.
+	addStaff() returns False for anything else and the caller should fall back to
+	copying the cloned contexts.
+
+	\sa CAMimeData
+*/
+
+CAClipboardBuffer::CAClipboardBuffer()
+{
+    clear();
+}
+
+/*!
+	Removes all the rows from the buffer.
+*/
+void CAClipboardBuffer::clear()
+{
+    _type.clear();
+    _time.clear();
+    _length.clear();
+    _pitch.clear();
+    _marks.clear();
+    _variant.clear();
+
+    _trackStart.clear();
+    _trackStart << 0;
+    _staffTracks.clear();
+    _staffTracks << 0;
+    _staffLines.clear();
+}
+
+/*!
+	Returns True, if the element \a elt can be stored in the buffer.
+*/
+bool CAClipboardBuffer::isSupported(CAMusElement* elt)
+{
+    switch (elt->musElementType()) {
+    case CAMusElement::Note: {
+        CANote* note = static_cast<CANote*>(elt);
+        if (note->slurStart() || note->slurEnd() || note->phrasingSlurStart() || note->phrasingSlurEnd() || note->tuplet())
+            return false;
+        for (CAMark* mark : note->markList()) {
+            if (mark->markType() != CAMark::Articulation)
+                return false;
+        }
+        return true;
+    }
+    case CAMusElement::Rest:
+        return !static_cast<CARest*>(elt)->tuplet() && elt->markList().isEmpty();
+    case CAMusElement::Barline:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool clipboardLessThan(CAMusElement* a, CAMusElement* b)
+{
+    if (a->timeStart() != b->timeStart())
+        return a->timeStart() < b->timeStart();
+    if (a->isPlayable() != b->isPlayable())
+        return !a->isPlayable(); // signs come before the playables at the same time
+    if (a->musElementType() == CAMusElement::Note && b->musElementType() == CAMusElement::Note)
+        return static_cast<CANote*>(a)->diatonicPitch().noteName() < static_cast<CANote*>(b)->diatonicPitch().noteName();
+    return false;
+}
+
+/*!
+	Adds the selected elements \a elts of the \a staff to the buffer. Each voice
+	containing selected playables becomes a track. Signs are added to the first track.
+
+	Gaps between the selected playables are removed, the same as when appending
+	them to a voice.
+
+	Returns False and leaves the buffer unchanged, if any of the elements is not
+	supported.
+*/
+bool CAClipboardBuffer::addStaff(CAStaff* staff, const QList<CAMusElement*>& elts)
+{
+    QSet<CAMusElement*> selected;
+    for (CAMusElement* elt : elts) {
+        if (!isSupported(elt))
+            return false;
+        selected << elt;
+    }
+
+    QVector<QList<CAMusElement*>> voices(staff->voiceList().size());
+    QList<CAMusElement*> signs;
+    for (CAMusElement* elt : elts) {
+        if (elt->isPlayable())
+            voices[staff->voiceList().indexOf(static_cast<CAPlayable*>(elt)->voice())] << elt;
+        else
+            signs << elt;
+    }
+
+    QList<QList<CAMusElement*>> tracks;
+    for (const QList<CAMusElement*>& voice : voices) {
+        if (!voice.isEmpty())
+            tracks << voice;
+    }
+    if (tracks.isEmpty())
+        tracks << signs;
+    else
+        tracks[0] += signs;
+
+    for (QList<CAMusElement*>& track : tracks) {
+        std::stable_sort(track.begin(), track.end(), clipboardLessThan);
+
+        int time = 0;
+        int chordTime = 0;
+        CANote* prevNote = nullptr;
+        for (CAMusElement* elt : track) {
+            CANote* note = (elt->musElementType() == CAMusElement::Note) ? static_cast<CANote*>(elt) : nullptr;
+            if (!elt->isPlayable()) {
+                addElement(elt, time);
+                continue;
+            }
+
+            if (!note || !prevNote || prevNote->timeStart() != note->timeStart()) {
+                chordTime = time;
+                time += elt->timeLength();
+            }
+            addElement(elt, chordTime);
+
+            if (note && note->tieStart() && note->tieStart()->noteEnd() && selected.contains(note->tieStart()->noteEnd())
+                && note->tieStart()->noteEnd()->voice() == note->voice())
+                _marks.last() |= TIE_START;
+            prevNote = note;
+        }
+        _trackStart << _type.size();
+    }
+
+    _staffTracks << _trackStart.size() - 1;
+    _staffLines << staff->numberOfLines();
+
+    return true;
+}
+
+/*!
+	Adds a row for the element \a elt starting at the relative \a time.
+*/
+void CAClipboardBuffer::addElement(CAMusElement* elt, int time)
+{
+    _type << static_cast<char>(elt->musElementType());
+    _time << time;
+
+    unsigned int marks = 0;
+    switch (elt->musElementType()) {
+    case CAMusElement::Note: {
+        CANote* note = static_cast<CANote*>(elt);
+        _length << note->playableLength();
+        _pitch << note->diatonicPitch();
+        _variant << static_cast<char>(note->stemDirection());
+        for (CAMark* mark : note->markList())
+            marks |= 1u << static_cast<CAArticulation*>(mark)->articulationType();
+        break;
+    }
+    case CAMusElement::Rest:
+        _length << static_cast<CARest*>(elt)->playableLength();
+        _pitch << CADiatonicPitch();
+        _variant << static_cast<char>(static_cast<CARest*>(elt)->restType());
+        break;
+    default:
+        _length << CAPlayableLength();
+        _pitch << CADiatonicPitch();
+        _variant << static_cast<char>(static_cast<CABarline*>(elt)->barlineType());
+        break;
+    }
+    _marks << marks;
+}
+
+/*!
+	Creates the elements of the \a voice of the given \a staff in the buffer and inserts
+	them into the \a target voice before \a eltAfter, or appends them if \a eltAfter is
+	null.
+
+	Returns the list of the inserted elements or an empty list, if \a eltAfter was not
+	found in the target voice.
+*/
+QList<CAMusElement*> CAClipboardBuffer::paste(int staff, int voice, CAVoice* target, CAMusElement* eltAfter) const
+{
+    int track = _staffTracks[staff] + voice;
+    QList<CAMusElement*> elts = createElements(track, target);
+    if (!target->insert(eltAfter, elts)) {
+        qDeleteAll(elts);
+        return QList<CAMusElement*>();
+    }
+
+    createTies(track, elts);
+    return elts;
+}
+
+/*!
+	Creates the elements of the \a track for the given \a voice. Their times are relative
+	to the beginning of the track.
+*/
+QList<CAMusElement*> CAClipboardBuffer::createElements(int track, CAVoice* voice) const
+{
+    QList<CAMusElement*> elts;
+    elts.reserve(_trackStart[track + 1] - _trackStart[track]);
+
+    for (int row = _trackStart[track]; row < _trackStart[track + 1]; row++) {
+        switch (_type[row]) {
+        case CAMusElement::Note: {
+            CANote* note = new CANote(_pitch[row], _length[row], voice, _time[row]);
+            note->setStemDirection(static_cast<CANote::CAStemDirection>(_variant[row]));
+            for (int a = 0; a <= CAArticulation::Breath; a++) {
+                if (_marks[row] & (1u << a))
+                    note->addMark(new CAArticulation(static_cast<CAArticulation::CAArticulationType>(a), note));
+            }
+            elts << note;
+            break;
+        }
+        case CAMusElement::Rest:
+            elts << new CARest(static_cast<CARest::CARestType>(_variant[row]), _length[row], voice, _time[row]);
+            break;
+        default:
+            elts << new CABarline(static_cast<CABarline::CABarlineType>(_variant[row]), voice->staff(), _time[row]);
+            break;
+        }
+    }
+
+    return elts;
+}
+
+/*!
+	Ties the pasted notes \a elts of the \a track to the notes of the same pitch in the
+	following chord.
+*/
+void CAClipboardBuffer::createTies(int track, const QList<CAMusElement*>& elts) const
+{
+    int first = _trackStart[track];
+    int end = _trackStart[track + 1];
+    for (int row = first; row < end; row++) {
+        if (!(_marks[row] & TIE_START))
+            continue;
+
+        int next = row + 1;
+        while (next < end && _time[next] == _time[row])
+            next++;
+
+        CADiatonicPitch pitch = _pitch[row];
+        for (int i = next; i < end && _time[i] == _time[next]; i++) {
+            if (_type[i] == CAMusElement::Note && pitch == _pitch[i]) {
+                CANote* noteStart = static_cast<CANote*>(elts[row - first]);
+                CANote* noteEnd = static_cast<CANote*>(elts[i - first]);
+                CASlur* tie = new CASlur(CASlur::TieType, CASlur::SlurPreferred, noteStart->staff(), noteStart, noteEnd);
+                noteStart->setTieStart(tie);
+                noteEnd->setTieEnd(tie);
+                break;
+            }
+        }
+    }
+}
+
+/*!
+	Creates a staff for each staff in the buffer and adds it to the \a sheet.
+	This is used when the clipboard content needs to be exported.
+*/
+void CAClipboardBuffer::createContexts(CASheet* sheet) const
+{
+    for (int staff = 0; staff < staffCount(); staff++) {
+        CAStaff* newStaff = new CAStaff("", sheet, staffLines(staff));
+        sheet->addContext(newStaff);
+        for (int voice = 0; voice < voiceCount(staff); voice++) {
+            CAVoice* newVoice = new CAVoice("", newStaff);
+            newStaff->addVoice(newVoice);
+            paste(staff, voice, newVoice, nullptr);
+        }
+        newStaff->synchronizeVoices();
+    }
+}
@@ -0,0 +1,58 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#ifndef CLIPBOARDBUFFER_H_
+#define CLIPBOARDBUFFER_H_
+
+#include <QList>
+#include <QVector>
+
+#include "score/diatonicpitch.h"
+#include "score/playablelength.h"
+
+class CAMusElement;
+class CASheet;
+class CAStaff;
+class CAVoice;
+
+class CAClipboardBuffer {
+public:
+    CAClipboardBuffer();
+
+    bool addStaff(CAStaff* staff, const QList<CAMusElement*>& elts);
+    void clear();
+
+    inline int staffCount() const { return _staffLines.size(); }
+    inline int staffLines(int staff) const { return _staffLines[staff]; }
+    inline int voiceCount(int staff) const { return _staffTracks[staff + 1] - _staffTracks[staff]; }
+    inline int elementCount() const { return _type.size(); }
+
+    QList<CAMusElement*> paste(int staff, int voice, CAVoice* target, CAMusElement* eltAfter) const;
+    void createContexts(CASheet* sheet) const;
+
+    static const unsigned int TIE_START = 0x80000000; // in marks column, note is tied to the next one
+
+private:
+    bool isSupported(CAMusElement* elt);
+    void addElement(CAMusElement* elt, int time);
+    QList<CAMusElement*> createElements(int track, CAVoice* voice) const;
+    void createTies(int track, const QList<CAMusElement*>& elts) const;
+
+    // One row per copied element, tracks are stored one after another
+    QVector<char> _type; // CAMusElement::CAMusElementType
+    QVector<int> _time; // timeStart relative to the beginning of the track
+    QVector<CAPlayableLength> _length;
+    QVector<CADiatonicPitch> _pitch;
+    QVector<unsigned int> _marks; // articulation bits and TIE_START
+    QVector<char> _variant; // stem direction of notes, rest type or barline type
+
+    QVector<int> _trackStart; // first row of each track (voice), followed by the total row count
+    QVector<int> _staffTracks; // first track of each staff, followed by the total track count
+    QVector<int> _staffLines; // number of lines of each staff
+};
+
+#endif /* CLIPBOARDBUFFER_H_ */
@@ -0,0 +1,245 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#include <QThread>
+
+#include "core/exportqueue.h"
+#include "export/export.h"
+#include "score/document.h"
+#include "score/resource.h"
+#include "score/sheet.h"
+
+/*!
+	\class CAExportQueue
+	\brief Queue of background export jobs
+
+	This class runs CAExport filters asynchronously so the main window is not blocked
+	while exporting. Each job exports a snapshot of the document taken at the time the
+	job was queued, so the user can continue editing the original document.
+
+	Up to maxRunningJobs() jobs run concurrently, each in its own CAFile thread. The
+	remaining ones wait in the queue. Use the returned job ID to follow jobStarted(),
+	jobProgress() and jobFinished() signals or to cancel() the job.
+
+	The queue takes ownership of the given export filters and deletes them once the job
+	is finished. Slots connected to jobFinished() can still access the filter by calling
+	exporter().
+
+	\code
+	  CAExportQueue *queue = new CAExportQueue(this);
+	  CALilyPondExport *le = new CALilyPondExport();
+	  le->setStreamToFile("jingle bells.ly");
+	  connect(queue, SIGNAL(jobFinished(int, int)), this, SLOT(onExportFinished(int, int)));
+	  queue->exportSheet(le, currentSheet());
+	\endcode
+
+	\sa CAExport, CAFile::cancel()
+*/
+
+CAExportQueue::CAExportQueue(QObject* parent)
+    : QObject(parent)
+    , _maxRunningJobs(qMax(QThread::idealThreadCount(), 1))
+    , _nextId(0)
+{
+}
+
+/*!
+	Cancels any pending jobs and waits for the running ones to stop.
+*/
+CAExportQueue::~CAExportQueue()
+{
+    cancelAll();
+    waitForDone();
+}
+
+/*!
+	Queues the export of the whole document \a doc using the filter \a exp.
+	The filter stream should already be set.
+
+	Returns the ID of the new job.
+*/
+int CAExportQueue::exportDocument(CAExport* exp, CADocument* doc)
+{
+    return enqueue(exp, doc, -1);
+}
+
+/*!
+	Queues the export of the \a sheet using the filter \a exp.
+	The filter stream should already be set.
+
+	Returns the ID of the new job.
+*/
+int CAExportQueue::exportSheet(CAExport* exp, CASheet* sheet)
+{
+    return enqueue(exp, sheet->document(), sheet->document()->sheetList().indexOf(sheet));
+}
+
+int CAExportQueue::enqueue(CAExport* exp, CADocument* doc, int sheetIdx)
+{
+    CAExportJob job;
+    job.id = _nextId++;
+    job.exp = exp;
+    job.snapshot = doc->clone();
+    job.sheetIdx = sheetIdx;
+
+    connect(exp, SIGNAL(exportProgress(int)), this, SLOT(onExportProgress(int)), Qt::QueuedConnection);
+    connect(exp, SIGNAL(finished()), this, SLOT(onExportFinished()), Qt::QueuedConnection);
+
+    _queuedJobs << job;
+    startJobs();
+
+    return job.id;
+}
+
+/*!
+	Starts the queued jobs until maxRunningJobs() are running.
+*/
+void CAExportQueue::startJobs()
+{
+    while (!_queuedJobs.isEmpty() && _runningJobs.size() < maxRunningJobs()) {
+        CAExportJob job = _queuedJobs.takeFirst();
+        _runningJobs[job.exp] = job;
+
+        emit jobStarted(job.id);
+        if (job.sheetIdx == -1) {
+            job.exp->exportDocument(job.snapshot);
+        } else {
+            job.exp->exportSheet(job.snapshot->sheetList()[job.sheetIdx]);
+        }
+    }
+}
+
+/*!
+	Cancels the \a job.
+	Queued jobs are removed immediately, running ones stop at the next voice.
+	jobFinished() is emitted in both cases.
+*/
+void CAExportQueue::cancel(int job)
+{
+    for (int i = 0; i < _queuedJobs.size(); i++) {
+        if (_queuedJobs[i].id == job) {
+            CAExportJob j = _queuedJobs.takeAt(i);
+            emit jobFinished(j.id, CAExport::CANCELLED_STATUS);
+            finishJob(j);
+            return;
+        }
+    }
+
+    for (QHash<CAExport*, CAExportJob>::iterator i = _runningJobs.begin(); i != _runningJobs.end(); i++) {
+        if (i.value().id == job) {
+            i.key()->cancel();
+            return;
+        }
+    }
+}
+
+/*!
+	Cancels all queued and running jobs.
+*/
+void CAExportQueue::cancelAll()
+{
+    while (!_queuedJobs.isEmpty()) {
+        cancel(_queuedJobs.first().id);
+    }
+
+    for (QHash<CAExport*, CAExportJob>::iterator i = _runningJobs.begin(); i != _runningJobs.end(); i++) {
+        i.key()->cancel();
+    }
+}
+
+/*!
+	Blocks until all the jobs in the queue are finished.
+*/
+void CAExportQueue::waitForDone()
+{
+    while (!_runningJobs.isEmpty()) {
+        CAExport* exp = _runningJobs.begin().key();
+        exp->wait();
+        jobDone(exp);
+    }
+}
+
+/*!
+	Returns the export filter of the running \a job or Null, if the job is not running.
+*/
+CAExport* CAExportQueue::exporter(int job)
+{
+    for (QHash<CAExport*, CAExportJob>::iterator i = _runningJobs.begin(); i != _runningJobs.end(); i++) {
+        if (i.value().id == job) {
+            return i.key();
+        }
+    }
+
+    return nullptr;
+}
+
+/*!
+	Returns the percentage of the \a job done or -1, if the job is not queued or running
+	or its progress is unknown.
+
+	\sa CAExport::setIndeterminateProgress()
+*/
+int CAExportQueue::progress(int job)
+{
+    for (int i = 0; i < _queuedJobs.size(); i++) {
+        if (_queuedJobs[i].id == job) {
+            return 0;
+        }
+    }
+
+    CAExport* exp = exporter(job);
+    return exp ? exp->progress() : -1;
+}
+
+void CAExportQueue::onExportProgress(int progress)
+{
+    CAExport* exp = static_cast<CAExport*>(sender());
+    if (_runningJobs.contains(exp)) {
+        emit jobProgress(_runningJobs[exp].id, progress);
+    }
+}
+
+/*!
+	Called when the export thread has finished.
+	Unlike exportDone(), QThread::finished() is emitted after the filter's run()
+	returned, so the final status is set and the thread doesn't need to be waited for.
+*/
+void CAExportQueue::onExportFinished()
+{
+    jobDone(static_cast<CAExport*>(sender()));
+}
+
+/*!
+	Emits jobFinished() for the filter \a exp and starts the next queued job.
+*/
+void CAExportQueue::jobDone(CAExport* exp)
+{
+    if (!_runningJobs.contains(exp)) {
+        return; // already finished in waitForDone()
+    }
+
+    emit jobFinished(_runningJobs[exp].id, exp->status());
+
+    CAExportJob job = _runningJobs.take(exp);
+    finishJob(job);
+    startJobs();
+}
+
+/*!
+	Destroys the snapshot and the filter of the finished \a job.
+*/
+void CAExportQueue::finishJob(CAExportJob& job)
+{
+    // resources are shared with the original document, don't delete them
+    while (!job.snapshot->resourceList().isEmpty()) {
+        job.snapshot->removeResource(job.snapshot->resourceList().first());
+    }
+    delete job.snapshot;
+
+    job.exp->disconnect(this);
+    job.exp->deleteLater();
+}
@@ -0,0 +1,71 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#ifndef EXPORTQUEUE_H_
+#define EXPORTQUEUE_H_
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+
+class CAExport;
+class CADocument;
+class CASheet;
+
+class CAExportQueue : public QObject {
+#ifndef SWIG
+    Q_OBJECT
+#endif
+public:
+    CAExportQueue(QObject* parent = nullptr);
+    virtual ~CAExportQueue();
+
+    int exportDocument(CAExport* exp, CADocument* doc);
+    int exportSheet(CAExport* exp, CASheet* sheet);
+
+    void cancel(int job);
+    void cancelAll();
+    void waitForDone();
+
+    CAExport* exporter(int job);
+    int progress(int job);
+    inline int jobCount() { return _queuedJobs.size() + _runningJobs.size(); }
+
+    inline int maxRunningJobs() { return _maxRunningJobs; }
+    inline void setMaxRunningJobs(int m) { _maxRunningJobs = m; }
+
+#ifndef SWIG
+signals:
+    void jobStarted(int job);
+    void jobProgress(int job, int progress);
+    void jobFinished(int job, int status);
+
+private slots:
+    void onExportProgress(int progress);
+    void onExportFinished();
+#endif
+
+private:
+    struct CAExportJob {
+        int id;
+        CAExport* exp;
+        CADocument* snapshot; // cloned document, owned by the job
+        int sheetIdx; // -1 for the whole document
+    };
+
+    int enqueue(CAExport* exp, CADocument* doc, int sheetIdx);
+    void startJobs();
+    void jobDone(CAExport* exp);
+    void finishJob(CAExportJob& job);
+
+    QList<CAExportJob> _queuedJobs;
+    QHash<CAExport*, CAExportJob> _runningJobs;
+    int _maxRunningJobs;
+    int _nextId;
+};
+
+#endif /* EXPORTQUEUE_H_ */
@@ -22,11 +22,18 @@
 	defined by the filter. Waiting for the thread to be finished can be implemented by calling QThread::wait()
 	or by catching the signals emitted by children import and export classes.
 
+	Long operations can be interrupted from another thread by calling cancel(). Filters poll
+	isCancelled() at convenient points (eg. after each exported voice), stop the work and set
+	the status to CANCELLED_STATUS.
+
 	\sa CAImport, CAExport
 */
 
+const int CAFile::CANCELLED_STATUS = -99;
+
 CAFile::CAFile()
     : QThread()
+    , _cancelled(0)
 {
     setProgress(0);
     setStatus(0);
@@ -172,6 +179,7 @@ void CAFile::setStreamFromDevice(QIODevice* device)
 	  0              - filter is ready (not started yet or successfully done)
 	  greater than 0 - filter is busy, custom filter status
 	  -1             - file not found or cannot be opened
+	  -99            - operation was cancelled, see cancel()
 	  lesser than -1 - custom filter errors
 */
 
@@ -8,6 +8,7 @@
 #ifndef FILE_H_
 #define FILE_H_
 
+#include <QAtomicInt>
 #include <QFile>
 #include <QThread>
 
@@ -21,6 +22,9 @@ public:
     inline int status() { return _status; }
     inline int progress() { return _progress; }
     virtual const QString readableStatus() = 0;
+    inline void cancel() { _cancelled.store(1); }
+    inline bool isCancelled() { return _cancelled.load(); }
+    static const int CANCELLED_STATUS;
     void setStreamFromFile(const QString filename);
     void setStreamToFile(const QString filename);
     void setStreamFromDevice(QIODevice* device);
@@ -45,6 +49,7 @@ private:
     QTextStream* _stream;
     QFile* _file;
     bool _deleteStream; // whether to delete stream when destroyed.
+    QAtomicInt _cancelled; // set from another thread to stop the operation
 };
 
 #endif /* FILE_H_ */
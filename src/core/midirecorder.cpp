@@ -61,7 +61,7 @@ void CAMidiRecorder::startRecording(int)
         _timer->start();
         // the default time signature is a 4 quarters measure
         _midiExport->sendMetaEvent(0, CAMidiDevice::Meta_Timesig, 4, 4, 0);
-        _midiExport->sendMetaEvent(0, CAMidiDevice::Meta_Tempo, 120, 0, 0);
+        _midiExport->sendMetaEvent(0, CAMidiDevice::Meta_Tempo, 0, 0, 60000000 / CATempoMap::DEFAULT_BPM);
     } else {
         _paused = false;
     }
@@ -85,6 +85,6 @@ void CAMidiRecorder::pauseRecording()
 void CAMidiRecorder::onMidiInEvent(QVector<unsigned char> messages)
 {
     if (_midiExport && !_paused) {
-        _midiExport->send(messages, _curTime / 2); // needs division somewhere else ...
+        _midiExport->send(messages, _tempoMap.msToTime(_curTime));
     }
 }
@@ -13,6 +13,8 @@
 
 #include <memory>
 
+#include "score/tempomap.h"
+
 class CAMidiExport;
 class CAResource;
 class CAMidiDevice;
@@ -41,7 +43,8 @@ private:
     std::shared_ptr<CAResource> _resource;
     CAMidiExport* _midiExport;
     QTimer* _timer;
-    unsigned int _curTime;
+    unsigned int _curTime; // miliseconds
+    CATempoMap _tempoMap; // default tempo, matching the tempo written to the file
 
     bool _paused;
 };
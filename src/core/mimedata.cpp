@@ -6,12 +6,21 @@
 */
 
 #include "core/mimedata.h"
+#include "core/clipboardbuffer.h"
+#include "export/canorusmlexport.h"
 #include "score/context.h"
+#include "score/document.h"
+#include "score/sheet.h"
 
 /*!
 	Subclass of QMimeData which incorporates list of Music elements for
 	copy/paste functionality.
 
+	The copied elements are stored either as a list of cloned contexts or, for
+	simple selections, as a compact CAClipboardBuffer. Pasting inside Canorus uses
+	them directly. When another process requests the data, it is serialised to
+	CanorusML on the first request only.
+
 	MIME types for Canorus contexts are "application/canorus-contexts".
 */
 
@@ -19,29 +28,86 @@ const QString CAMimeData::CANORUS_MIME_TYPE = "application/canorus-contexts";
 
 CAMimeData::CAMimeData()
     : QMimeData()
+    , _buffer(nullptr)
 {
 }
 
 CAMimeData::CAMimeData(QList<CAContext*> list)
     : QMimeData()
+    , _buffer(nullptr)
 {
     setContexts(list);
 }
 
+/*!
+	Creates the mime data out of the compact clipboard \a buffer and takes ownership of it.
+*/
+CAMimeData::CAMimeData(CAClipboardBuffer* buffer)
+    : QMimeData()
+    , _buffer(buffer)
+{
+}
+
 CAMimeData::~CAMimeData()
 {
     for (int i = 0; i < contexts().size(); i++)
         delete contexts().at(i);
+    delete _buffer;
 }
 
 QStringList CAMimeData::formats() const
 {
     QStringList curFormats = QMimeData::formats();
-    if (hasContexts())
+    if (hasContexts() || hasBuffer())
         curFormats << CANORUS_MIME_TYPE;
     return curFormats;
 }
 
+/*!
+	Returns the clipboard content as CanorusML, when another process asks for the
+	Canorus \a mimeType.
+*/
+QVariant CAMimeData::retrieveData(const QString& mimeType, QVariant::Type type) const
+{
+    if (mimeType == CANORUS_MIME_TYPE && (hasContexts() || hasBuffer())) {
+        if (_canorusML.isEmpty())
+            _canorusML = toCanorusML();
+        return _canorusML;
+    }
+
+    return QMimeData::retrieveData(mimeType, type);
+}
+
+/*!
+	Exports the copied contexts as a CanorusML document with a single sheet.
+*/
+QByteArray CAMimeData::toCanorusML() const
+{
+    CADocument doc;
+    CASheet* sheet = doc.addSheet();
+    if (hasBuffer()) {
+        _buffer->createContexts(sheet);
+    } else {
+        for (CAContext* context : contexts())
+            sheet->addContext(context);
+    }
+
+    CACanorusMLExport exp;
+    exp.setStreamToString();
+    exp.exportDocument(&doc, false);
+    QByteArray data = exp.getStreamAsString().toUtf8();
+
+    // the copied contexts are owned by the mime data, the created ones are not owned by the sheet
+    while (!sheet->contextList().isEmpty()) {
+        CAContext* context = sheet->contextList().first();
+        sheet->removeContext(context);
+        if (hasBuffer())
+            delete context;
+    }
+
+    return data;
+}
+
 bool CAMimeData::hasFormat(const QString format) const
 {
     return formats().contains(format);
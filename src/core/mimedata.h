@@ -12,12 +12,14 @@
 #include <QMimeData>
 #include <QStringList>
 
+class CAClipboardBuffer;
 class CAContext;
 
 class CAMimeData : public QMimeData {
 public:
     CAMimeData();
     CAMimeData(QList<CAContext*> list);
+    CAMimeData(CAClipboardBuffer* buffer);
     virtual ~CAMimeData();
 
     using QMimeData::hasFormat;
@@ -28,10 +30,20 @@ public:
     inline const QList<CAContext*>& contexts() const { return _contexts; }
     inline bool hasContexts() const { return _contexts.size(); }
 
+    inline const CAClipboardBuffer* buffer() const { return _buffer; }
+    inline bool hasBuffer() const { return _buffer; }
+
     static const QString CANORUS_MIME_TYPE;
 
+protected:
+    QVariant retrieveData(const QString& mimeType, QVariant::Type type) const;
+
 private:
+    QByteArray toCanorusML() const;
+
     QList<CAContext*> _contexts;
+    CAClipboardBuffer* _buffer; // compact representation, used instead of _contexts when set
+    mutable QByteArray _canorusML; // serialised on the first request from another process
 };
 
 #endif /* MIMEDATA_H_ */
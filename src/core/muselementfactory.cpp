@@ -263,7 +263,7 @@ bool CAMusElementFactory::configureNote(int pitch,
         if (voice->lastNote() == mpoMusElement) {
             // note was appended, reposition elements in dependent contexts accordingly
             for (CALyricsContext* lc : voice->lyricsContextList()) {
-                lc->repositionElements();
+                lc->repositionElements(mpoMusElement->timeStart());
             }
             for (CAContext* context : voice->staff()->sheet()->contextList()) {
                 switch (context->contextType()) {
@@ -284,7 +284,7 @@ bool CAMusElementFactory::configureNote(int pitch,
             // note was inserted somewhere inbetween, insert empty element in dependent contexts accordingly
             for (CALyricsContext* lc : voice->lyricsContextList()) {
                 lc->insertEmptyElement(mpoMusElement->timeStart());
-                lc->repositionElements();
+                lc->repositionElements(mpoMusElement->timeStart());
             }
             for (CAContext* context : voice->staff()->sheet()->contextList()) {
                 switch (context->contextType()) {
@@ -478,7 +478,7 @@ bool CAMusElementFactory::configureRest(CAVoice* voice, CAMusElement* right)
             removeMusElem(true);
         else {
             for (CALyricsContext* lc : voice->lyricsContextList()) {
-                lc->repositionElements();
+                lc->repositionElements(mpoMusElement->timeStart());
             }
             for (CAContext* context : voice->staff()->sheet()->contextList()) {
                 switch (context->contextType()) {
@@ -5,7 +5,11 @@
 	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
 */
 
+#include <QHash>
 #include <QObject>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
 
 #include "core/notechecker.h"
 #include "score/notecheckererror.h"
@@ -18,6 +22,9 @@
 #include "score/chordname.h"
 #include "score/playablelength.h"
 #include "score/timesignature.h"
+#include "score/voice.h"
+
+#include <algorithm>
 
 /*!
 	\class CANoteChecker
@@ -26,9 +33,54 @@
 	This class is spell checker that provides tools for checking potential
 	"typing" errors made by the user such as too little notes not filling the bar
 	and similar.
+
+	The checker works incrementally. Staffs whose voices kept their CAVoice::revision()
+	since the last check of the same sheet are not visited again, their previous results
+	are reused. Every incorrect bar is keyed by a hash of its contents relative to the
+	bar start and the required duration, and the hash is stored in the CANoteCheckerError
+	it produced. Errors of unchanged bars are kept as they are, also when the bar was only
+	moved in time, so their drawables stay valid, and only the errors of changed bars are
+	removed or created. The elements whose errors changed during the last check are
+	returned by changedElements(), use CAScoreView::updateNoteCheckerErrors() to show them
+	without laying out the sheet.
+
+	Contexts are independent of each other and are checked concurrently, if
+	parallelCheck() is set (default). The checker uses its own thread pool, so it never
+	waits for the unrelated tasks on the global QThreadPool.
 */
 
+/*!
+	Checks a single context on the thread pool.
+	The score is only read, the errors are created afterwards on the calling thread.
+*/
+class CANoteCheckerTask : public QRunnable {
+public:
+    CANoteCheckerTask(CAContext* context)
+        : _context(context)
+    {
+        setAutoDelete(false);
+    }
+
+    void run() { _results = CANoteChecker::checkContext(_context); }
+
+    inline CAContext* context() { return _context; }
+    inline const QList<CANoteChecker::CANoteCheckerResult>& results() { return _results; }
+
+private:
+    CAContext* _context;
+    QList<CANoteChecker::CANoteCheckerResult> _results;
+};
+
+/*!
+	Returns the hash \a h combined with the value \a v.
+*/
+static inline uint combineHash(uint h, int v)
+{
+    return h ^ (qHash(v) + 0x9e3779b9 + (h << 6) + (h >> 2));
+}
+
 CANoteChecker::CANoteChecker()
+    : _parallelCheck(true)
 {
 }
 
@@ -37,65 +89,186 @@ CANoteChecker::~CANoteChecker()
 }
 
 /*!
-	Parse/decompress an existing archive
+	Checks the given \a sheet and updates its note checker errors.
+	Errors which are still valid are kept.
+
+	\sa changedElements()
 */
 void CANoteChecker::checkSheet(CASheet* sheet)
 {
-    sheet->clearNoteCheckerErrors();
+    _changedElements.clear();
 
-    // check for incomplete bars
-    QList<CAContext*> contexts = sheet->contextList();
+    QHash<CAContext*, CAStaffCache> staffCache;
+    QList<CANoteCheckerTask*> tasks;
+    QList<CANoteCheckerResult> cachedResults;
+    const QList<CAContext*>& contexts = sheet->contextList();
     for (int i = 0; i < contexts.size(); i++) {
-        switch (contexts[i]->contextType()) {
-        case CAContext::Staff: {
-            CAStaff* staff = static_cast<CAStaff*>(contexts[i]);
-            QList<CAMusElement*> timeSigs = staff->timeSignatureRefs();
-            QList<CAMusElement*> barlines = staff->barlineRefs();
+        if (contexts[i]->contextType() == CAContext::Staff) {
+            CAStaffCache& cache = staffCache[contexts[i]];
+            cache.key = staffKey(contexts[i]);
 
-            if (!timeSigs.size()) {
-                continue;
+            QHash<CAContext*, CAStaffCache>::const_iterator it = _staffCache.constFind(contexts[i]);
+            if (it != _staffCache.constEnd() && it.value().key == cache.key) { // unchanged staff, skip it
+                cache.results = it.value().results;
+                cachedResults += cache.results;
+            } else {
+                tasks << new CANoteCheckerTask(contexts[i]);
             }
+        } else if (contexts[i]->contextType() == CAContext::ChordNameContext) {
+            tasks << new CANoteCheckerTask(contexts[i]);
+        }
+    }
 
-            int lastTimeSigIdx = 0;
-            int lastTimeSigRequiredDuration = static_cast<CATimeSignature*>(timeSigs[lastTimeSigIdx])->barDuration();
-            int lastBarlineTime = -1;
-            for (int j = 0; j < barlines.size(); j++) {
-                if (static_cast<CABarline*>(barlines[j])->barlineType() == CABarline::Dotted) {
-                    continue;
-                }
-
-                if (((lastTimeSigIdx + 1) < timeSigs.size()) && barlines[j]->timeStart() > timeSigs[lastTimeSigIdx]->timeStart()) {
-                    // go to next time sig
-                    lastTimeSigIdx++;
-                    lastTimeSigRequiredDuration = static_cast<CATimeSignature*>(timeSigs[lastTimeSigIdx])->barDuration();
-                }
-
-                // check the bar duration.
-                // If first bar is partial, the length should be shorter or equal to time sig.
-                if ((lastBarlineTime == -1 && barlines[j]->timeStart() > lastTimeSigRequiredDuration) || (lastBarlineTime != -1 && barlines[j]->timeStart() != lastBarlineTime + lastTimeSigRequiredDuration)) {
-                    CANoteCheckerError* nce = new CANoteCheckerError(barlines[j], QObject::tr("Bar duration incorrect."));
-                    sheet->addNoteCheckerError(nce);
-                }
-
-                lastBarlineTime = barlines[j]->timeStart();
-            }
+    if (parallelCheck() && tasks.size() > 1 && QThread::idealThreadCount() > 1) {
+        QThreadPool pool;
+        for (int i = 0; i < tasks.size(); i++) {
+            pool.start(tasks[i]);
+        }
+        pool.waitForDone();
+    } else {
+        for (int i = 0; i < tasks.size(); i++) {
+            tasks[i]->run();
+        }
+    }
+
+    QHash<CAMusElement*, CANoteCheckerResult> found;
+    for (int i = 0; i < cachedResults.size(); i++) {
+        found.insert(cachedResults[i].element, cachedResults[i]);
+    }
+    for (int i = 0; i < tasks.size(); i++) {
+        for (int j = 0; j < tasks[i]->results().size(); j++) {
+            found.insert(tasks[i]->results()[j].element, tasks[i]->results()[j]);
+        }
+        if (staffCache.contains(tasks[i]->context())) {
+            staffCache[tasks[i]->context()].results = tasks[i]->results();
+        }
+        delete tasks[i];
+    }
+    _staffCache = staffCache;
+
+    // keep the errors of unchanged bars, remove the others
+    QList<CANoteCheckerError*> errors = sheet->noteCheckerErrorList();
+    for (int i = 0; i < errors.size(); i++) {
+        QHash<CAMusElement*, CANoteCheckerResult>::iterator it = found.find(errors[i]->targetElement());
+        if (it != found.end() && it.value().hash == errors[i]->hash() && it.value().message == errors[i]->message()) {
+            found.erase(it);
+        } else {
+            _changedElements << errors[i]->targetElement();
+            delete errors[i]; // also removes it from the sheet
+        }
+    }
+
+    // add the errors of changed bars
+    for (QHash<CAMusElement*, CANoteCheckerResult>::const_iterator it = found.constBegin(); it != found.constEnd(); it++) {
+        sheet->addNoteCheckerError(new CANoteCheckerError(it.key(), it.value().message, it.value().hash));
+        _changedElements << it.key();
+    }
+}
+
+/*!
+	Returns the key of the staff \a context contents checked by checkContext(): the
+	revisions and sizes of its voices and the bar durations of its time signatures.
+	The results of a staff with the same key as in the last check are reused.
+*/
+QVector<uint> CANoteChecker::staffKey(CAContext* context)
+{
+    CAStaff* staff = static_cast<CAStaff*>(context);
+    QVector<uint> key;
+    for (int i = 0; i < staff->voiceList().size(); i++) {
+        key << staff->voiceList()[i]->revision() << staff->voiceList()[i]->musElementList().size();
+    }
+    for (int i = 0; i < staff->timeSignatureRefs().size(); i++) {
+        key << static_cast<CATimeSignature*>(staff->timeSignatureRefs()[i])->barDuration();
+    }
+    return key;
+}
+
+/*!
+	Returns the hash of the bar in the given \a staff from \a barStart to \a barEnd
+	with the \a requiredDuration. Only the element types, lengths and times relative to
+	the bar start are hashed, so the bar keeps its hash when it is moved in time.
+*/
+uint CANoteChecker::barHash(CAStaff* staff, int barStart, int barEnd, int requiredDuration)
+{
+    uint h = combineHash(combineHash(0, barEnd - barStart), requiredDuration);
+    for (int i = 0; i < staff->voiceList().size(); i++) {
+        const QList<CAMusElement*>& list = staff->voiceList()[i]->musElementList();
+        QList<CAMusElement*>::const_iterator it = std::lower_bound(list.constBegin(), list.constEnd(), barStart,
+            [](const CAMusElement* elt, int t) { return elt->timeStart() < t; });
+        for (; it != list.constEnd() && (*it)->timeStart() < barEnd; it++) {
+            h = combineHash(combineHash(combineHash(h, (*it)->musElementType()), (*it)->timeStart() - barStart), (*it)->timeLength());
+        }
+        h = combineHash(h, -1); // voice separator
+    }
+    return h;
+}
+
+/*!
+	Returns the errors found in the given \a context.
+	Doesn't change the score, so different contexts can be checked concurrently.
+*/
+QList<CANoteChecker::CANoteCheckerResult> CANoteChecker::checkContext(CAContext* context)
+{
+    QList<CANoteCheckerResult> results;
+
+    switch (context->contextType()) {
+    case CAContext::Staff: {
+        // check for incomplete bars
+        CAStaff* staff = static_cast<CAStaff*>(context);
+        const QList<CAMusElement*>& timeSigs = staff->timeSignatureRefs();
+        const QList<CAMusElement*>& barlines = staff->barlineRefs();
+
+        if (!timeSigs.size()) {
             break;
         }
-        case CAContext::ChordNameContext: {
-            CAChordNameContext* cnc = static_cast<CAChordNameContext*>(contexts[i]);
-            for (int j = 0; j < cnc->chordNameList().size(); j++) {
-                CAChordName* cn = cnc->chordNameList()[j];
-                if (cn->diatonicPitch().noteName() == CADiatonicPitch::Undefined && !cn->qualityModifier().isEmpty()) {
-                    CANoteCheckerError* nce = new CANoteCheckerError(cn, QObject::tr("Invalid chord name syntax. Please use chord pitch and optionally ':' and quality modifier. e.g. cis:m"));
-                    sheet->addNoteCheckerError(nce);
-                }
+
+        int lastTimeSigIdx = 0;
+        int lastTimeSigRequiredDuration = static_cast<CATimeSignature*>(timeSigs[lastTimeSigIdx])->barDuration();
+        int lastBarlineTime = -1;
+        for (int j = 0; j < barlines.size(); j++) {
+            if (static_cast<CABarline*>(barlines[j])->barlineType() == CABarline::Dotted) {
+                continue;
             }
-            break;
+
+            if (((lastTimeSigIdx + 1) < timeSigs.size()) && barlines[j]->timeStart() > timeSigs[lastTimeSigIdx]->timeStart()) {
+                // go to next time sig
+                lastTimeSigIdx++;
+                lastTimeSigRequiredDuration = static_cast<CATimeSignature*>(timeSigs[lastTimeSigIdx])->barDuration();
+            }
+
+            // check the bar duration.
+            // If first bar is partial, the length should be shorter or equal to time sig.
+            if ((lastBarlineTime == -1 && barlines[j]->timeStart() > lastTimeSigRequiredDuration) || (lastBarlineTime != -1 && barlines[j]->timeStart() != lastBarlineTime + lastTimeSigRequiredDuration)) {
+                CANoteCheckerResult r;
+                r.element = barlines[j];
+                r.hash = barHash(staff, qMax(lastBarlineTime, 0), barlines[j]->timeStart(), lastTimeSigRequiredDuration);
+                r.message = QObject::tr("Bar duration incorrect.");
+                results << r;
+            }
+
+            lastBarlineTime = barlines[j]->timeStart();
         }
-        case CAContext::LyricsContext:
-        case CAContext::FunctionMarkContext:
-        case CAContext::FiguredBassContext:
-            break;
+        break;
+    }
+    case CAContext::ChordNameContext: {
+        CAChordNameContext* cnc = static_cast<CAChordNameContext*>(context);
+        for (int j = 0; j < cnc->chordNameList().size(); j++) {
+            CAChordName* cn = cnc->chordNameList()[j];
+            if (cn->diatonicPitch().noteName() == CADiatonicPitch::Undefined && !cn->qualityModifier().isEmpty()) {
+                CANoteCheckerResult r;
+                r.element = cn;
+                r.hash = qHash(cn->qualityModifier());
+                r.message = QObject::tr("Invalid chord name syntax. Please use chord pitch and optionally ':' and quality modifier. e.g. cis:m");
+                results << r;
+            }
         }
+        break;
     }
+    case CAContext::LyricsContext:
+    case CAContext::FunctionMarkContext:
+    case CAContext::FiguredBassContext:
+        break;
+    }
+
+    return results;
 }
@@ -8,14 +8,50 @@
 #ifndef NOTECHECKER_H_
 #define NOTECHECKER_H_
 
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+class CAContext;
+class CAMusElement;
 class CASheet;
+class CAStaff;
 
 class CANoteChecker {
+    friend class CANoteCheckerTask; // checks a single context on the thread pool
+
 public:
     CANoteChecker();
     virtual ~CANoteChecker();
 
     void checkSheet(CASheet*);
+
+    inline bool parallelCheck() { return _parallelCheck; }
+    inline void setParallelCheck(bool p) { _parallelCheck = p; }
+    inline const QList<CAMusElement*>& changedElements() { return _changedElements; }
+
+private:
+    // Error found in a single bar or element
+    struct CANoteCheckerResult {
+        CAMusElement* element; // barline closing the bar or the checked element
+        uint hash; // content of the bar or element
+        QString message;
+    };
+
+    // Results of a staff checked earlier
+    struct CAStaffCache {
+        QVector<uint> key; // see staffKey()
+        QList<CANoteCheckerResult> results;
+    };
+
+    static QVector<uint> staffKey(CAContext* context);
+    static QList<CANoteCheckerResult> checkContext(CAContext* context);
+    static uint barHash(CAStaff* staff, int barStart, int barEnd, int requiredDuration);
+
+    bool _parallelCheck;
+    QList<CAMusElement*> _changedElements; // elements whose errors changed in the last checkSheet()
+    QHash<CAContext*, CAStaffCache> _staffCache; // staffs of the last checked sheet
 };
 
 #endif /* NOTECHECKER_H_ */
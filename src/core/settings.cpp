@@ -21,12 +21,15 @@ const bool CASettings::DEFAULT_SHADOW_NOTES_IN_OTHER_STAFFS = false;
 const bool CASettings::DEFAULT_PLAY_INSERTED_NOTES = true;
 const bool CASettings::DEFAULT_AUTO_BAR = true;
 const bool CASettings::DEFAULT_USE_NOTE_CHECKER = true;
+const bool CASettings::DEFAULT_VIRTUAL_LAYOUT = false;
 
 const QDir CASettings::DEFAULT_DOCUMENTS_DIRECTORY = QDir::home();
 const QDir CASettings::DEFAULT_SHORTCUTS_DIRECTORY = QDir(QDir::homePath() + "/.config/Canorus");
 const CAFileFormats::CAFileFormatType CASettings::DEFAULT_SAVE_FORMAT = CAFileFormats::Can;
 const int CASettings::DEFAULT_AUTO_RECOVERY_INTERVAL = 1;
 const int CASettings::DEFAULT_MAX_RECENT_DOCUMENTS = 15;
+const int CASettings::DEFAULT_COMPRESSION_LEVEL = 6;
+const bool CASettings::DEFAULT_PARALLEL_COMPRESSION = true;
 
 #ifndef SWIGCPP
 const bool CASettings::DEFAULT_LOCK_SCROLL_PLAYBACK = true; // scroll while playing
@@ -58,6 +61,7 @@ const QString CASettings::DEFAULT_TYPESETTER_LOCATION = "lilypond";
 const bool CASettings::DEFAULT_USE_SYSTEM_TYPESETTER = true;
 const QString CASettings::DEFAULT_PDF_VIEWER_LOCATION = "";
 const bool CASettings::DEFAULT_USE_SYSTEM_PDF_VIEWER = true;
+const bool CASettings::DEFAULT_USE_NATIVE_PREVIEW = true;
 
 /*!
 	\class CASettings
@@ -138,12 +142,15 @@ void CASettings::writeSettings()
     setValue("editor/playinsertednotes", playInsertedNotes());
     setValue("editor/autobar", autoBar());
     setValue("editor/usenotechecker", useNoteChecker());
+    setValue("editor/virtuallayout", virtualLayout());
     setValue("appearance/showruler", showRuler());
 
     setValue("files/documentsdirectory", documentsDirectory().absolutePath());
     setValue("files/defaultsaveformat", defaultSaveFormat());
     setValue("files/autorecoveryinterval", autoRecoveryInterval());
     setValue("files/maxrecentdocuments", maxRecentDocuments());
+    setValue("files/compressionlevel", compressionLevel());
+    setValue("files/parallelcompression", parallelCompression());
 #ifndef SWIGCPP
     writeRecentDocuments();
 
@@ -168,6 +175,7 @@ void CASettings::writeSettings()
     setValue("printing/usesystemdefaulttypesetter", useSystemDefaultTypesetter());
     setValue("printing/pdfviewerlocation", pdfViewerLocation());
     setValue("printing/usesystemdefaultpdfviewer", useSystemDefaultPdfViewer());
+    setValue("printing/usenativepreview", useNativePreview());
 
     sync();
 }
@@ -210,6 +218,11 @@ int CASettings::readSettings()
     else
         setUseNoteChecker(DEFAULT_USE_NOTE_CHECKER);
 
+    if (contains("editor/virtuallayout"))
+        setVirtualLayout(value("editor/virtuallayout").toBool());
+    else
+        setVirtualLayout(DEFAULT_VIRTUAL_LAYOUT);
+
     // Saving/Loading settings
     if (contains("files/documentsdirectory"))
         setDocumentsDirectory(value("files/documentsdirectory").toString());
@@ -232,6 +245,16 @@ int CASettings::readSettings()
     else
         setMaxRecentDocuments(DEFAULT_MAX_RECENT_DOCUMENTS);
 
+    if (contains("files/compressionlevel"))
+        setCompressionLevel(value("files/compressionlevel").toInt());
+    else
+        setCompressionLevel(DEFAULT_COMPRESSION_LEVEL);
+
+    if (contains("files/parallelcompression"))
+        setParallelCompression(value("files/parallelcompression").toBool());
+    else
+        setParallelCompression(DEFAULT_PARALLEL_COMPRESSION);
+
 #ifndef SWIGCPP
     readRecentDocuments();
 
@@ -292,12 +315,8 @@ int CASettings::readSettings()
         setShowRuler(DEFAULT_SHOW_RULER);
 
 #endif
-    // Playback settings
-    if (contains("rtmidi/midiinport")
-#ifndef SWIGCPP
-        && value("rtmidi/midiinport").toInt() < CACanorus::midiDevice()->getInputPorts().count()
-#endif
-    ) {
+    // Playback settings, the ports are checked when the MIDI device is opened, see updateMidiPorts()
+    if (contains("rtmidi/midiinport")) {
         setMidiInPort(value("rtmidi/midiinport").toInt());
     } else {
         setMidiInPort(DEFAULT_MIDI_IN_PORT);
@@ -305,21 +324,13 @@ int CASettings::readSettings()
     }
 
     if (contains("rtmidi/midiinnumdevices")) {
-#ifndef SWIGCPP
-        if (value("rtmidi/midiinnumdevices").toInt() != CACanorus::midiDevice()->getInputPorts().count())
-            settingsPage = -1;
-        setMidiInNumDevices(CACanorus::midiDevice()->getInputPorts().count());
-#endif
+        setMidiInNumDevices(value("rtmidi/midiinnumdevices").toInt());
     } else {
         setMidiInNumDevices(DEFAULT_MIDI_IN_NUM_DEVICES);
         settingsPage = -1;
     }
 
-    if (contains("rtmidi/midioutport")
-#ifndef SWIGCPP
-        && value("rtmidi/midioutport").toInt() < CACanorus::midiDevice()->getOutputPorts().count()
-#endif
-    ) {
+    if (contains("rtmidi/midioutport")) {
         setMidiOutPort(value("rtmidi/midioutport").toInt());
     } else {
         setMidiOutPort(DEFAULT_MIDI_OUT_PORT);
@@ -327,11 +338,7 @@ int CASettings::readSettings()
     }
 
     if (contains("rtmidi/midioutnumdevices")) {
-#ifndef SWIGCPP
-        if (value("rtmidi/midioutnumdevices").toInt() != CACanorus::midiDevice()->getOutputPorts().count())
-            settingsPage = -1;
-        setMidiOutNumDevices(CACanorus::midiDevice()->getOutputPorts().count());
-#endif
+        setMidiOutNumDevices(value("rtmidi/midioutnumdevices").toInt());
     } else {
         setMidiOutNumDevices(DEFAULT_MIDI_OUT_NUM_DEVICES);
         settingsPage = -1;
@@ -363,6 +370,11 @@ int CASettings::readSettings()
     else
         setUseSystemDefaultPdfViewer(DEFAULT_USE_SYSTEM_PDF_VIEWER);
 
+    if (contains("printing/usenativepreview"))
+        setUseNativePreview(value("printing/usenativepreview").toBool());
+    else
+        setUseNativePreview(DEFAULT_USE_NATIVE_PREVIEW);
+
     // Action / Command settings
     if (contains("action/shortcutsdirectory"))
         setLatestShortcutsDirectory(value("action/shortcutsdirectory").toString());
@@ -376,13 +388,34 @@ void CASettings::setMidiInPort(int in)
 {
     _midiInPort = in;
 #ifndef SWIGCPP
-    if (CACanorus::midiDevice()) {
+    if (CACanorus::hasMidiDevice()) { // otherwise the port is opened together with the device
         CACanorus::midiDevice()->closeInputPort();
         CACanorus::midiDevice()->openInputPort(midiInPort());
     }
 #endif
 }
 
+/*!
+	Checks the stored MIDI ports against the ports of the MIDI device. Called when
+	the device is opened, as the ports aren't known when reading the settings.
+	Ports which don't exist anymore are reset to the default ones.
+*/
+void CASettings::updateMidiPorts()
+{
+#ifndef SWIGCPP
+    int inPorts = CACanorus::midiDevice()->getInputPorts().count();
+    int outPorts = CACanorus::midiDevice()->getOutputPorts().count();
+
+    if (midiInPort() >= inPorts)
+        setMidiInPort(DEFAULT_MIDI_IN_PORT);
+    if (midiOutPort() >= outPorts)
+        setMidiOutPort(DEFAULT_MIDI_OUT_PORT);
+
+    setMidiInNumDevices(inPorts);
+    setMidiOutNumDevices(outPorts);
+#endif
+}
+
 #ifndef SWIGCPP
 
 /*!
@@ -51,6 +51,9 @@ public:
     inline bool useNoteChecker() { return _useNoteChecker; }
     inline void setUseNoteChecker(bool b) { _useNoteChecker = b; }
     static const bool DEFAULT_USE_NOTE_CHECKER;
+    inline bool virtualLayout() { return _virtualLayout; }
+    inline void setVirtualLayout(bool b) { _virtualLayout = b; }
+    static const bool DEFAULT_VIRTUAL_LAYOUT;
 
     /////////////////////////////
     // Loading/Saving settings //
@@ -67,6 +70,12 @@ public:
     inline int maxRecentDocuments() { return _maxRecentDocuments; }
     inline void setMaxRecentDocuments(int r) { _maxRecentDocuments = r; }
     static const int DEFAULT_MAX_RECENT_DOCUMENTS;
+    inline int compressionLevel() { return _compressionLevel; }
+    inline void setCompressionLevel(int level) { _compressionLevel = qBound(-1, level, 9); } // zlib levels, -1 is the default
+    static const int DEFAULT_COMPRESSION_LEVEL;
+    inline bool parallelCompression() { return _parallelCompression; }
+    inline void setParallelCompression(bool p) { _parallelCompression = p; }
+    static const bool DEFAULT_PARALLEL_COMPRESSION;
 
     /////////////////////////
     // Appearance settings //
@@ -125,6 +134,7 @@ public:
     inline int midiOutNumDevices() { return _midiOutNumDevices; }
     void setMidiOutNumDevices(int outNum) { _midiOutNumDevices = outNum; }
     static const int DEFAULT_MIDI_OUT_NUM_DEVICES;
+    void updateMidiPorts();
 
     ///////////////////////
     // Printing settings //
@@ -144,6 +154,9 @@ public:
     inline bool useSystemDefaultPdfViewer() { return _useSystemDefaultPdfViewer; }
     void setUseSystemDefaultPdfViewer(bool s) { _useSystemDefaultPdfViewer = s; }
     static const bool DEFAULT_USE_SYSTEM_PDF_VIEWER;
+    inline bool useNativePreview() { return _useNativePreview; }
+    void setUseNativePreview(bool s) { _useNativePreview = s; }
+    static const bool DEFAULT_USE_NATIVE_PREVIEW;
 
     ///////////////////////////////
     // Action / Command settings //
@@ -185,6 +198,7 @@ private:
     bool _playInsertedNotes;
     bool _autoBar;
     bool _useNoteChecker;
+    bool _virtualLayout;
 
     /////////////////////////////
     // Loading/Saving settings //
@@ -193,6 +207,8 @@ private:
     CAFileFormats::CAFileFormatType _defaultSaveFormat;
     int _autoRecoveryInterval; // auto recovery interval in minutes
     int _maxRecentDocuments; // number of stored recently opened files
+    int _compressionLevel; // zlib compression level of saved archives, 1 (fastest) to 9 (smallest)
+    bool _parallelCompression; // compress archives on all available cores
 
     /////////////////////////
     // Appearance settings //
@@ -226,6 +242,7 @@ private:
     bool _useSystemDefaultTypesetter;
     QString _pdfViewerLocation;
     bool _useSystemDefaultPdfViewer;
+    bool _useNativePreview;
 
     /*
 % To adjust the size of notes and fonts in points, it can be done like this:
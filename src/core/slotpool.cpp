@@ -0,0 +1,160 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#include <QtGlobal>
+#include <new>
+
+#include "core/slotpool.h"
+
+/*!
+	\class CASlotPool
+	\brief Allocator of small objects of a few different sizes
+
+	Scores and their views consist of many small objects of only a few different sizes.
+	The pool groups them into size classes of SLOT_ALIGN bytes and carves them from
+	CHUNK_SIZE blocks, so objects of the same type are packed together and allocating or
+	freeing them only pops or pushes the free list of their block.
+
+	Each block is aligned to CHUNK_SIZE and starts with a header, so a freed object finds
+	its block by masking its address. The blocks of a size class with free slots are
+	linked together. When the last object of a block is freed, the block is released,
+	unless it is the only block of its size class with free slots. This keeps a single
+	block for creating and deleting the same element over and over again, but returns
+	the memory of a closed document.
+
+	Classes use the pool by overloading the operator new and the sized operator delete,
+	see CAMusElement. Objects are created and destroyed by the import and
+	export threads as well, so the pool is guarded by a mutex.
+*/
+
+CASlotPool::CASlotPool()
+    : _chunkCount(0)
+    , _usedBytes(0)
+{
+    for (size_t i = 0; i < MAX_SLOT_SIZE / SLOT_ALIGN; i++) {
+        _partialChunks[i] = nullptr;
+    }
+}
+
+/*!
+	Returns the memory for a new object of the given \a size.
+	Objects larger than MAX_SLOT_SIZE are allocated by the global allocator.
+*/
+void* CASlotPool::allocate(size_t size)
+{
+    if (size == 0 || size > MAX_SLOT_SIZE) {
+        return ::operator new(size);
+    }
+
+    size_t sizeClass = (size - 1) / SLOT_ALIGN;
+    QMutexLocker locker(&_mutex);
+    CAChunk* c = _partialChunks[sizeClass];
+    if (!c) {
+        c = createChunk(sizeClass);
+    }
+
+    CAFreeSlot* slot = c->freeSlots;
+    c->freeSlots = slot->next;
+    c->live++;
+    if (!c->freeSlots) {
+        unlink(c); // full
+    }
+    _usedBytes += (sizeClass + 1) * SLOT_ALIGN;
+    return slot;
+}
+
+/*!
+	Returns the memory \a p of the destroyed object of the given \a size to the pool.
+	Releases the block of the object, if it became empty.
+*/
+void CASlotPool::release(void* p, size_t size)
+{
+    if (!p) {
+        return;
+    }
+
+    if (size == 0 || size > MAX_SLOT_SIZE) {
+        ::operator delete(p);
+        return;
+    }
+
+    CAChunk* c = chunk(p);
+    CAFreeSlot* slot = static_cast<CAFreeSlot*>(p);
+    QMutexLocker locker(&_mutex);
+    if (!c->freeSlots) {
+        link(c); // was full
+    }
+    slot->next = c->freeSlots;
+    c->freeSlots = slot;
+    c->live--;
+    _usedBytes -= (c->sizeClass + 1) * SLOT_ALIGN;
+
+    if (!c->live && (_partialChunks[c->sizeClass] != c || c->next)) {
+        unlink(c);
+        qFreeAligned(c);
+        _chunkCount--;
+    }
+}
+
+/*!
+	Returns the block the slot \a p was carved from.
+*/
+CASlotPool::CAChunk* CASlotPool::chunk(void* p)
+{
+    return reinterpret_cast<CAChunk*>(reinterpret_cast<quintptr>(p) & ~quintptr(CHUNK_SIZE - 1));
+}
+
+/*!
+	Carves a new block into free slots of the given \a sizeClass and links it to the
+	blocks with free slots. Slots are linked in address order, so consecutive
+	allocations are adjacent in memory.
+*/
+CASlotPool::CAChunk* CASlotPool::createChunk(size_t sizeClass)
+{
+    CAChunk* c = static_cast<CAChunk*>(qMallocAligned(CHUNK_SIZE, CHUNK_SIZE));
+    if (!c) {
+        throw std::bad_alloc();
+    }
+    c->freeSlots = nullptr;
+    c->sizeClass = sizeClass;
+    c->live = 0;
+    _chunkCount++;
+
+    size_t slotSize = (sizeClass + 1) * SLOT_ALIGN;
+    size_t first = (sizeof(CAChunk) + slotSize - 1) / slotSize; // slots taken by the header
+    for (size_t i = CHUNK_SIZE / slotSize; i > first; i--) {
+        CAFreeSlot* slot = reinterpret_cast<CAFreeSlot*>(reinterpret_cast<char*>(c) + (i - 1) * slotSize);
+        slot->next = c->freeSlots;
+        c->freeSlots = slot;
+    }
+
+    link(c);
+    return c;
+}
+
+void CASlotPool::link(CAChunk* c)
+{
+    c->prev = nullptr;
+    c->next = _partialChunks[c->sizeClass];
+    if (c->next) {
+        c->next->prev = c;
+    }
+    _partialChunks[c->sizeClass] = c;
+}
+
+void CASlotPool::unlink(CAChunk* c)
+{
+    if (c->prev) {
+        c->prev->next = c->next;
+    } else {
+        _partialChunks[c->sizeClass] = c->next;
+    }
+    if (c->next) {
+        c->next->prev = c->prev;
+    }
+    c->prev = c->next = nullptr;
+}
@@ -0,0 +1,53 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#ifndef SLOTPOOL_H_
+#define SLOTPOOL_H_
+
+#include <QMutex>
+#include <cstddef>
+
+class CASlotPool {
+public:
+    static const size_t SLOT_ALIGN = 16;
+    static const size_t MAX_SLOT_SIZE = 512; // larger objects use the global allocator
+    static const size_t CHUNK_SIZE = 64 * 1024;
+
+    CASlotPool();
+
+    void* allocate(size_t size);
+    void release(void* p, size_t size);
+
+    inline size_t allocatedChunks() { return _chunkCount; }
+    inline size_t usedBytes() { return _usedBytes; }
+
+private:
+    struct CAFreeSlot {
+        CAFreeSlot* next;
+    };
+
+    // Put at the start of every block, which is aligned to CHUNK_SIZE
+    struct CAChunk {
+        CAChunk* prev; // blocks of the same size class with free slots
+        CAChunk* next;
+        CAFreeSlot* freeSlots;
+        size_t sizeClass;
+        int live; // slots in use
+    };
+
+    static CAChunk* chunk(void* p);
+    CAChunk* createChunk(size_t sizeClass);
+    void link(CAChunk* chunk);
+    void unlink(CAChunk* chunk);
+
+    QMutex _mutex;
+    CAChunk* _partialChunks[MAX_SLOT_SIZE / SLOT_ALIGN];
+    size_t _chunkCount;
+    size_t _usedBytes;
+};
+
+#endif /* SLOTPOOL_H_ */
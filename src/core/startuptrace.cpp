@@ -0,0 +1,88 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#include <iostream>
+
+#include "core/startuptrace.h"
+
+/*!
+	\class CAStartupTrace
+	\brief Prints the time spent in each phase of the application startup
+
+	The trace is enabled by the \c --trace-startup switch or the
+	\c CANORUS_TRACE_STARTUP environment variable. main() calls phase() after each
+	initialization step and finish() when the event loop runs for the first time.
+	Subsystems which are initialized on first use (scripting, MIDI, help) call
+	report() with their own duration, so the deferred costs show up as well. A
+	subsystem initialized before finish() is marked as a startup cost, because its
+	duration is also included in the phase it was initialized in.
+
+	The lines are printed to the standard error output:
+	\code
+	  startup: settings                    3 ms  (total 41 ms)
+	\endcode
+*/
+
+bool CAStartupTrace::_enabled = false;
+QElapsedTimer CAStartupTrace::_timer;
+qint64 CAStartupTrace::_lastPhase = 0;
+bool CAStartupTrace::_finished = false;
+
+/*!
+	Starts measuring the startup time, if the trace was requested in the command
+	line arguments \a argv or in the environment.
+*/
+void CAStartupTrace::start(int argc, char* argv[])
+{
+    _enabled = !qEnvironmentVariableIsEmpty("CANORUS_TRACE_STARTUP");
+    for (int i = 1; i < argc; i++) {
+        if (QString(argv[i]) == "--trace-startup")
+            _enabled = true;
+    }
+
+    _timer.start();
+    _lastPhase = 0;
+    _finished = false;
+}
+
+/*!
+	Ends the current startup phase and prints its duration under the given \a name.
+*/
+void CAStartupTrace::phase(const QString& name)
+{
+    if (!_enabled)
+        return;
+
+    qint64 now = _timer.elapsed();
+    std::cerr << qPrintable(QString("startup: %1 %2 ms  (total %3 ms)").arg(name, -24).arg(now - _lastPhase, 6).arg(now)) << std::endl;
+    _lastPhase = now;
+}
+
+/*!
+	Prints the duration \a msecs of a subsystem \a name initialized on first use.
+	This doesn't end the current startup phase.
+*/
+void CAStartupTrace::report(const QString& name, qint64 msecs)
+{
+    if (!_enabled)
+        return;
+
+    std::cerr << qPrintable(QString("on demand: %1 %2 ms  (at %3 ms%4)").arg(name, -22).arg(msecs, 6).arg(_timer.elapsed()).arg(_finished ? "" : ", during startup")) << std::endl;
+}
+
+/*!
+	Ends the last phase and prints the total startup time.
+*/
+void CAStartupTrace::finish()
+{
+    if (!_enabled)
+        return;
+
+    phase("first event loop");
+    _finished = true;
+    std::cerr << qPrintable(QString("startup: finished in %1 ms").arg(_timer.elapsed())) << std::endl;
+}
@@ -0,0 +1,30 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#ifndef STARTUPTRACE_H_
+#define STARTUPTRACE_H_
+
+#include <QElapsedTimer>
+#include <QString>
+
+class CAStartupTrace {
+public:
+    static void start(int argc, char* argv[]);
+    static void phase(const QString& name);
+    static void report(const QString& name, qint64 msecs);
+    static void finish();
+
+    inline static bool isEnabled() { return _enabled; }
+
+private:
+    static bool _enabled;
+    static QElapsedTimer _timer; // started in start()
+    static qint64 _lastPhase; // end of the previous phase in ms since start()
+    static bool _finished; // finish() was called, later reports are not startup costs
+};
+
+#endif /* STARTUPTRACE_H_ */
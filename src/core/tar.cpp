@@ -405,6 +405,17 @@ qint64 CATar::write(QIODevice& dest, qint64 chunk)
     return total;
 }
 
+/*!
+	Returns the number of bytes write() produces, without serialising the tar.
+*/
+qint64 CATar::size()
+{
+    qint64 total = 0;
+    for (CATarFile* f : _files)
+        total += 512 + ((f->data->size() + 511) / 512) * 512;
+    return total;
+}
+
 /*
 	Tells whether the whole tar has been written to \a dest.
 */
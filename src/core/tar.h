@@ -31,6 +31,7 @@ public:
     CAIOPtr file(const QString& filename);
     qint64 write(QIODevice& dest, qint64 chunk);
     qint64 write(QIODevice& dest);
+    qint64 size();
     inline bool open(QIODevice& dest)
     {
         if (_pos.contains(&dest)) {
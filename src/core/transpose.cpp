@@ -5,6 +5,9 @@
 	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
 */
 
+#include <QHash>
+#include <algorithm>
+
 #include "core/transpose.h"
 
 #include "score/chordname.h"
@@ -32,15 +35,56 @@
 	   addMusElement() or addContext().
 	3) Transpose the elements by calling transposeByKeySig(), transposeByInterval(),
 	   transposeBySemitones() or reinterpretAccidentals().
+	4) Optionally read the changed time range by calling dirtyTimeStart() and dirtyTimeEnd().
 
 	\sa CAInterval::fromSemitones()
  */
 
+/*!
+	Precomputed transposition of the diatonic pitches for a single interval.
+
+	Adding the interval moves every note name by the same number of steps and changes the
+	accidentals by an amount depending only on the note name in the octave, so a table of
+	seven entries replaces the interval arithmetic of CADiatonicPitch::operator+() for
+	every note.
+*/
+class CATransposeTable {
+public:
+    CATransposeTable(CAInterval interval)
+        : _interval(interval)
+    {
+        for (int i = 0; i < 7; i++) {
+            CADiatonicPitch p(28 + i, 0); // any octave gives the same result
+            CADiatonicPitch q = p + interval;
+            _accs[i] = q.accs();
+            _shift = q.noteName() - p.noteName();
+        }
+    }
+
+    inline CADiatonicPitch transpose(CADiatonicPitch p)
+    {
+        if (p.noteName() < 0) { // undefined
+            return p + _interval;
+        }
+
+        return CADiatonicPitch(p.noteName() + _shift, p.accs() + _accs[p.noteName() % 7]);
+    }
+
+private:
+    CAInterval _interval;
+    int _shift; // change of the note name
+    int _accs[7]; // change of the accidentals for each note name in the octave
+};
+
 CATranspose::CATranspose()
+    : _dirtyTimeStart(-1)
+    , _dirtyTimeEnd(-1)
 {
 }
 
 CATranspose::CATranspose(CASheet* sheet)
+    : _dirtyTimeStart(-1)
+    , _dirtyTimeEnd(-1)
 {
     for (int i = 0; i < sheet->contextList().size(); i++) {
         addContext(sheet->contextList()[i]);
@@ -48,6 +92,8 @@ CATranspose::CATranspose(CASheet* sheet)
 }
 
 CATranspose::CATranspose(QList<CAContext*> contexts)
+    : _dirtyTimeStart(-1)
+    , _dirtyTimeEnd(-1)
 {
     for (int i = 0; i < contexts.size(); i++) {
         addContext(contexts[i]);
@@ -55,6 +101,8 @@ CATranspose::CATranspose(QList<CAContext*> contexts)
 }
 
 CATranspose::CATranspose(QList<CAMusElement*> selection)
+    : _dirtyTimeStart(-1)
+    , _dirtyTimeEnd(-1)
 {
     _elements = QSet<CAMusElement*>::fromList(selection);
 }
@@ -129,13 +177,25 @@ void CATranspose::transposeByKeySig(CADiatonicKey from, CADiatonicKey to, int di
 /*!
 	Transposes the music elements by the given interval.
 	If the interval quantity is negative, elements are transposed down.
+
+	Notes are grouped by their voice and transposed in time order using a precomputed
+	CATransposeTable. If all the notes of a voice are transposed, the ties between them
+	stay valid and are not updated note by note. Key signatures, chord names and function
+	marks are transposed in the same pass.
+
+	\sa dirtyTimeStart(), dirtyTimeEnd()
  */
 void CATranspose::transposeByInterval(CAInterval interval)
 {
+    CATransposeTable table(interval);
+    QHash<CAVoice*, QList<CANote*>> voiceNotes;
+    _dirtyTimeStart = -1;
+    _dirtyTimeEnd = -1;
+
     for (CAMusElement* elt : _elements) {
         switch (elt->musElementType()) {
         case CAMusElement::Note:
-            static_cast<CANote*>(elt)->setDiatonicPitch(static_cast<CANote*>(elt)->diatonicPitch() + interval);
+            voiceNotes[static_cast<CANote*>(elt)->voice()] << static_cast<CANote*>(elt);
             break;
         case CAMusElement::KeySignature:
             static_cast<CAKeySignature*>(elt)->setDiatonicKey(static_cast<CAKeySignature*>(elt)->diatonicKey() + interval);
@@ -147,13 +207,51 @@ void CATranspose::transposeByInterval(CAInterval interval)
             static_cast<CAFunctionMark*>(elt)->setKey(static_cast<CAFunctionMark*>(elt)->key() + interval);
             break;
         case CAMusElement::MidiNote: // ToDo
-            break;
         default:
-            break;
+            continue;
+        }
+        addDirtyTime(elt);
+    }
+
+    for (QHash<CAVoice*, QList<CANote*>>::iterator it = voiceNotes.begin(); it != voiceNotes.end(); it++) {
+        QList<CANote*>& notes = it.value();
+        std::stable_sort(notes.begin(), notes.end(), [](CANote* a, CANote* b) { return a->timeStart() < b->timeStart(); });
+
+        int voiceNoteCount = 0;
+        if (it.key()) {
+            const QList<CAMusElement*>& musElementList = it.key()->musElementList();
+            for (int i = 0; i < musElementList.size(); i++) {
+                if (musElementList[i]->musElementType() == CAMusElement::Note) {
+                    voiceNoteCount++;
+                }
+            }
+        }
+
+        if (notes.size() == voiceNoteCount) {
+            for (int i = 0; i < notes.size(); i++) {
+                notes[i]->diatonicPitch() = table.transpose(notes[i]->diatonicPitch()); // ties are unaffected
+            }
+        } else {
+            for (int i = 0; i < notes.size(); i++) {
+                notes[i]->setDiatonicPitch(table.transpose(notes[i]->diatonicPitch())); // also updates ties
+            }
         }
     }
 }
 
+/*!
+	Extends the changed time range for the given \a elt.
+ */
+void CATranspose::addDirtyTime(CAMusElement* elt)
+{
+    if (_dirtyTimeStart == -1 || elt->timeStart() < _dirtyTimeStart) {
+        _dirtyTimeStart = elt->timeStart();
+    }
+    if (_dirtyTimeEnd == -1 || elt->timeEnd() > _dirtyTimeEnd) {
+        _dirtyTimeEnd = elt->timeEnd();
+    }
+}
+
 /*!
 	Changes note accidentals dependent on \a type:
 	1) If type==1, sharps -> flats
@@ -165,6 +263,9 @@ void CATranspose::transposeByInterval(CAInterval interval)
 */
 void CATranspose::reinterpretAccidentals(int type)
 {
+    _dirtyTimeStart = -1;
+    _dirtyTimeEnd = -1;
+
     for (CAMusElement* elt : _elements) {
         switch (elt->musElementType()) {
         case CAMusElement::Note:
@@ -188,6 +289,7 @@ void CATranspose::reinterpretAccidentals(int type)
                 static_cast<CAChordName*>(elt)->setDiatonicPitch(newPitch);
             }
 
+            addDirtyTime(elt);
             break;
         }
         case CAMusElement::KeySignature: {
@@ -199,6 +301,7 @@ void CATranspose::reinterpretAccidentals(int type)
                 newDiatonicKey = CADiatonicKey(keySig->diatonicKey().diatonicPitch() - CAInterval(-2, 2), keySig->diatonicKey().gender());
             }
             keySig->setDiatonicKey(newDiatonicKey);
+            addDirtyTime(elt);
             break;
         }
         default:
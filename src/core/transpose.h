@@ -37,8 +37,15 @@ public:
     void addContext(CAContext* context);
     void addMusElement(CAMusElement* musElt) { _elements << musElt; }
 
+    inline int dirtyTimeStart() { return _dirtyTimeStart; }
+    inline int dirtyTimeEnd() { return _dirtyTimeEnd; }
+
 private:
+    void addDirtyTime(CAMusElement* elt);
+
     QSet<CAMusElement*> _elements;
+    int _dirtyTimeStart; // start of the changed elements in the last transposition, -1 if none
+    int _dirtyTimeEnd; // end of the changed elements in the last transposition, -1 if none
 };
 
 #endif /* TRANSPOSE_H_ */
@@ -8,6 +8,10 @@
 #include "export/canexport.h"
 #include "core/archive.h"
 #include "export/canorusmlexport.h"
+#ifndef SWIGCPP
+#include "canorus.h" // needed for settings()
+#endif
+#include "core/settings.h"
 
 #include "score/document.h"
 #include "score/resource.h"
@@ -61,6 +65,21 @@ void CACanExport::exportDocumentImpl(CADocument* doc)
     }
 
     // Save the archive
-    doc->archive()->write(*stream()->device());
+#ifndef SWIGCPP
+    if (CACanorus::settings()) {
+        doc->archive()->setCompressionLevel(CACanorus::settings()->compressionLevel());
+        doc->archive()->setParallelCompression(CACanorus::settings()->parallelCompression());
+    } else
+#endif
+    {
+        doc->archive()->setCompressionLevel(CASettings::DEFAULT_COMPRESSION_LEVEL);
+        doc->archive()->setParallelCompression(CASettings::DEFAULT_PARALLEL_COMPRESSION);
+    }
+
+    if (doc->archive()->write(*stream()->device()) == -1) {
+        setStatus(-3);
+        return;
+    }
+
     setStatus(0); // done
 }
@@ -114,8 +114,6 @@ void CACanorusMLExport::exportDocumentImpl(CADocument* doc)
     dDocument.setAttribute("time-edited", doc->timeEdited());
 
     for (int sheetIdx = 0; sheetIdx < doc->sheetList().size(); sheetIdx++) {
-        setProgress(qRound((static_cast<float>(sheetIdx) / doc->sheetList().size()) * 100));
-
         // CASheet
         QDomElement dSheet = dDoc.createElement("sheet");
         dDocument.appendChild(dSheet);
@@ -146,6 +144,10 @@ void CACanorusMLExport::exportDocumentImpl(CADocument* doc)
                     dVoice.setAttribute("stem-direction", CANote::stemDirectionToString(v->stemDirection()));
 
                     exportVoiceImpl(v, dVoice); // writes notes, clefs etc.
+
+                    if (!advanceProgress()) {
+                        return;
+                    }
                 }
 
                 break;
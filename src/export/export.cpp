@@ -6,6 +6,9 @@
 */
 
 #include "export/export.h"
+#include "score/document.h"
+#include "score/sheet.h"
+#include "score/staff.h"
 #include <QTextStream>
 
 /*!
@@ -46,6 +49,9 @@ CAExport::CAExport(QTextStream* stream)
     setExportedVoice(nullptr);
     setExportedLyricsContext(nullptr);
     setExportedFunctionMarkContext(nullptr);
+
+    _progressSteps = 1;
+    _progressStep = 0;
 }
 
 CAExport::~CAExport()
@@ -59,6 +65,7 @@ CAExport::~CAExport()
 */
 void CAExport::run()
 {
+    initProgressSteps();
     if (!stream()) {
         setStatus(-1);
     } else {
@@ -86,15 +93,85 @@ void CAExport::run()
         if (stream()->device() && stream()->device()->isOpen()) {
             stream()->device()->close();
         }
-        if (status() > 0) { // error - bad implemented filter
+        if (isCancelled()) {
+            setStatus(CANCELLED_STATUS);
+        } else if (status() > 0) { // error - bad implemented filter
             // job is finished but status is still marked as working, set to Ready to prevent infinite loops
             setStatus(0);
         }
     }
 
+    if (status() == 0) {
+        setProgress(100);
+        emit exportProgress(100);
+    }
     emit exportDone(status());
 }
 
+/*!
+	Counts the voices of the exported document, sheet or staff and resets the progress.
+	Called before the filter is run.
+
+	\sa advanceProgress()
+*/
+void CAExport::initProgressSteps()
+{
+    int steps = 0;
+    if (exportedDocument()) {
+        for (int i = 0; i < exportedDocument()->sheetList().size(); i++) {
+            steps += exportedDocument()->sheetList()[i]->voiceList().size();
+        }
+    } else if (exportedSheet()) {
+        steps = exportedSheet()->voiceList().size();
+    } else if (exportedStaff()) {
+        steps = exportedStaff()->voiceList().size();
+    }
+
+    _progressSteps = qMax(steps, 1);
+    _progressStep = 0;
+    setProgress(0);
+}
+
+/*!
+	Marks another voice as exported and updates the progress accordingly.
+	Filters should call this after each exported voice.
+
+	Returns False, if the export was cancelled in the meantime and the filter
+	should stop. True otherwise.
+
+	\sa initProgressSteps(), CAFile::cancel()
+*/
+bool CAExport::advanceProgress()
+{
+    if (_progressStep < _progressSteps) {
+        _progressStep++;
+    }
+
+    int p = _progressStep * 100 / _progressSteps;
+    if (p != progress()) {
+        setProgress(p);
+        emit exportProgress(p);
+    }
+
+    return !isCancelled();
+}
+
+/*!
+	Marks the progress as unknown (-1).
+	Filters should call this when the rest of the work can't be measured, eg.
+	while waiting for an external typesetter. The progress is set to 100 when
+	the export is finished.
+
+	\sa advanceProgress()
+*/
+void CAExport::setIndeterminateProgress()
+{
+    if (progress() != -1) {
+        setProgress(-1);
+        emit exportProgress(-1);
+    }
+}
+
 void CAExport::exportDocument(CADocument* doc, bool bStartThread)
 {
     setExportedDocument(doc);
@@ -102,6 +179,7 @@ void CAExport::exportDocument(CADocument* doc, bool bStartThread)
     if (bStartThread)
         start();
     else {
+        initProgressSteps();
         if (!stream()) {
             setStatus(-1);
         } else {
@@ -119,11 +197,18 @@ void CAExport::exportDocument(CADocument* doc, bool bStartThread)
     }
 }
 
-void CAExport::exportSheet(CASheet* sheet)
+/*!
+	Exports the given \a sheet. If \a bStartThread is False, the export is done
+	in the calling thread.
+*/
+void CAExport::exportSheet(CASheet* sheet, bool bStartThread)
 {
     setExportedSheet(sheet);
     setStatus(1); // process started
-    start();
+    if (bStartThread)
+        start();
+    else
+        run();
 }
 
 void CAExport::exportStaff(CAStaff* staff)
@@ -163,6 +248,8 @@ const QString CAExport::readableStatus()
         return tr("Ready");
     case -1:
         return tr("Unable to open file for writing");
+    case CANCELLED_STATUS:
+        return tr("Cancelled");
     }
     return tr("Ready");
 }
@@ -29,7 +29,7 @@ public:
 
     virtual const QString readableStatus();
     void exportDocument(CADocument*, bool bStartThread = true);
-    void exportSheet(CASheet*);
+    void exportSheet(CASheet*, bool bStartThread = true);
     void exportStaff(CAStaff*);
     void exportVoice(CAVoice*);
     void exportLyricsContext(CALyricsContext*);
@@ -62,6 +62,7 @@ signals:
     void functionMarkContextExported(CAFunctionMarkContext*);
 
     void exportDone(int status);
+    void exportProgress(int progress);
 #endif
 
 protected:
@@ -98,6 +99,10 @@ protected:
 
     inline QTextStream& out() { return *stream(); }
 
+    void initProgressSteps();
+    bool advanceProgress();
+    void setIndeterminateProgress();
+
     void run();
 
 private:
@@ -114,6 +119,9 @@ private:
     CAVoice* _exportedVoice;
     CALyricsContext* _exportedLyricsContext;
     CAFunctionMarkContext* _exportedFunctionMarkContext;
+
+    int _progressSteps; // number of voices to be exported
+    int _progressStep; // number of voices already exported
 };
 
 #endif /* EXPORT_H_ */
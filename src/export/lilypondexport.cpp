@@ -6,8 +6,10 @@
 */
 
 #include <QFileInfo>
+#include <QIODevice>
 #include <QList>
 #include <QRegExp>
+#include <QTextCodec>
 #include <QTextStream>
 
 #include "export/lilypondexport.h"
@@ -61,6 +63,9 @@ CALilyPondExport::CALilyPondExport(QTextStream* out)
     _voltaBracketFinishAtRepeat = false;
     _voltaBracketFinishAtBar = false;
     _timeSignatureFound = false;
+    _firstPageNumber = 0;
+    _bookPartFirst = true;
+    _bookPartLast = true;
 }
 
 /*!
@@ -186,6 +191,10 @@ void CALilyPondExport::exportVoiceImpl(CAVoice* v)
     indentLess();
     indent();
     out() << "\n}";
+
+    if (v == exportedVoice()) {
+        flushOutput(); // otherwise the sheet export flushes
+    }
 }
 
 void CALilyPondExport::exportPlayable(CAPlayable* elt)
@@ -205,13 +214,13 @@ void CALilyPondExport::exportPlayable(CAPlayable* elt)
         }
 
         // write the note name
-        out() << relativePitchToString(note->diatonicPitch(), _lastNotePitch);
+        writeRelativePitch(note->diatonicPitch(), _lastNotePitch);
         if (note->forceAccidentals()) {
             out() << "!";
         }
 
         if (!note->isPartOfChord() && _lastPlayableLength != note->playableLength()) {
-            out() << playableLengthToLilyPond(note->playableLength());
+            writePlayableLength(note->playableLength());
         }
 
         if (note->tieStart())
@@ -229,7 +238,7 @@ void CALilyPondExport::exportPlayable(CAPlayable* elt)
             out() << ">";
 
             if (_lastPlayableLength != note->playableLength()) {
-                out() << playableLengthToLilyPond(note->playableLength());
+                writePlayableLength(note->playableLength());
             }
 
             _lastNotePitch = note->getChord().at(0)->diatonicPitch();
@@ -270,7 +279,7 @@ void CALilyPondExport::exportPlayable(CAPlayable* elt)
         out() << restTypeToLilyPond(rest->restType());
 
         if (_lastPlayableLength != rest->playableLength()) {
-            out() << playableLengthToLilyPond(rest->playableLength());
+            writePlayableLength(rest->playableLength());
         }
 
         exportMarksAfterElement(rest);
@@ -622,6 +631,10 @@ void CALilyPondExport::exportLyricsContextImpl(CALyricsContext* lc)
 
         out() << syllableToLilyPond(lc->syllableList()[i]);
     }
+
+    if (lc == exportedLyricsContext()) {
+        flushOutput();
+    }
 }
 
 /*!
@@ -666,14 +679,16 @@ void CALilyPondExport::exportChordNameContextImpl(CAChordNameContext* cnc)
         if (pl.size()) {
             if (cn->diatonicPitch().noteName() != CADiatonicPitch::Undefined) {
                 // chord change
-                out() << CADiatonicPitch::diatonicPitchToString(cn->diatonicPitch()) << playableLengthToLilyPond(pl[0]);
+                out() << CADiatonicPitch::diatonicPitchToString(cn->diatonicPitch());
+                writePlayableLength(pl[0]);
                 if (!cn->qualityModifier().isEmpty()) {
                     out() << ":" << cn->qualityModifier();
                 }
             } else {
                 // diatonicPitch is Undefined - either chord name is empty or a syntax error.
                 // In either case, don't print the chord.
-                out() << "s" << playableLengthToLilyPond(pl[0]);
+                out() << "s";
+                writePlayableLength(pl[0]);
             }
         }
     }
@@ -744,37 +759,53 @@ CADiatonicPitch CALilyPondExport::writeRelativeIntro()
 
     CADiatonicPitch notePitch = static_cast<CANote*>(curVoice()->musElementList()[i])->diatonicPitch();
     notePitch.setNoteName(((notePitch.noteName() + 3) / 7) * 7);
-    out() << "\\relative "
-          << relativePitchToString(notePitch, CADiatonicPitch(21)) << " "; // LilyPond default C is c1
+    out() << "\\relative ";
+    writeRelativePitch(notePitch, CADiatonicPitch(21)); // LilyPond default C is c1
+    out() << " ";
 
     return notePitch;
 }
 
 /*!
-	This function returns the relative note pitch in LilyPond syntax on the given
-	Canorus pitch and previous note pitch.
+	Writes the relative note pitch in LilyPond syntax on the given Canorus pitch and
+	previous note pitch.
 
-	eg. pitch=10, accs=1, prevPitch=5 => returns "f'"
+	eg. pitch=10, accs=1, prevPitch=5 => writes "f'"
 
-	\sa notePitchToLilyPond()
+	Note names with up to two accidentals are taken from the lookup table, others are
+	spelled by diatonicPitchToLilyPond().
 */
-const QString CALilyPondExport::relativePitchToString(CADiatonicPitch p, CADiatonicPitch prevPitch)
+void CALilyPondExport::writeRelativePitch(CADiatonicPitch p, CADiatonicPitch prevPitch)
 {
+    // indexed by note letter a-g and accidentals -2..2
+    static const char* const pitchNames[7][5] = {
+        { "ases", "as", "a", "ais", "aisis" },
+        { "beses", "bes", "b", "bis", "bisis" },
+        { "ceses", "ces", "c", "cis", "cisis" },
+        { "deses", "des", "d", "dis", "disis" },
+        { "eses", "es", "e", "eis", "eisis" },
+        { "feses", "fes", "f", "fis", "fisis" },
+        { "geses", "ges", "g", "gis", "gisis" }
+    };
+
     // write the note name
-    QString stringPitch = diatonicPitchToLilyPond(p);
+    int letter = (p.noteName() + 2) % 7;
+    if (letter >= 0 && p.accs() >= -2 && p.accs() <= 2) {
+        out() << pitchNames[letter][p.accs() + 2];
+    } else {
+        out() << diatonicPitchToLilyPond(p);
+    }
 
     // write , or ' to lower/higher a note
     int delta = prevPitch.noteName() - p.noteName();
     while (delta > 3) { // add the needed amount of the commas
-        stringPitch += ",";
+        out() << ',';
         delta -= 7;
     }
     while (delta < -3) { // add the needed amount of the apostrophes
-        stringPitch += "'";
+        out() << '\'';
         delta += 7;
     }
-
-    return stringPitch;
 }
 
 /*!
@@ -892,6 +923,35 @@ const QString CALilyPondExport::playableLengthToLilyPond(CAPlayableLength playab
     return length;
 }
 
+/*!
+	Writes the note length in LilyPond syntax.
+	This is the same as playableLengthToLilyPond() without the temporary string.
+*/
+void CALilyPondExport::writePlayableLength(CAPlayableLength playableLength)
+{
+    switch (playableLength.musicLength()) {
+    case CAPlayableLength::Breve:
+        out() << "\\breve";
+        break;
+    case CAPlayableLength::Whole:
+    case CAPlayableLength::Half:
+    case CAPlayableLength::Quarter:
+    case CAPlayableLength::Eighth:
+    case CAPlayableLength::Sixteenth:
+    case CAPlayableLength::ThirtySecond:
+    case CAPlayableLength::SixtyFourth:
+    case CAPlayableLength::HundredTwentyEighth:
+        out() << static_cast<int>(playableLength.musicLength());
+        break;
+    case CAPlayableLength::Undefined:
+        out() << '4';
+        break;
+    }
+
+    for (int j = 0; j < playableLength.dotted(); j++)
+        out() << '.';
+}
+
 /*!
 	Converts the note pitch to LilyPond syntax.
 */
@@ -984,24 +1044,78 @@ const QString CALilyPondExport::syllableToLilyPond(CASyllable* s)
 
 /*!
 	Exports the current sheet to LilyPond syntax.
+
+	If the sheet is typeset as a part of the whole document, setFirstPageNumber()
+	continues the page numbering of the previous sheets and setBookPart() writes
+	the document title only on the first sheet and the tagline only on the last one.
 */
 void CALilyPondExport::exportSheetImpl(CASheet* sheet)
 {
-    out().setCodec("UTF-8");
-    setCurSheet(sheet);
+    stream()->setCodec("UTF-8");
 
     // we need to check if the document is not set, for example at exporting the first sheet
     if (sheet->document()) {
         setCurDocument(sheet->document());
     }
 
+    writeFileHeader();
+    if (_firstPageNumber > 1) {
+        out() << "\n\\paper {\n";
+        indentMore();
+        indent();
+        out() << "first-page-number = " << _firstPageNumber << "\n";
+        indent();
+        out() << "print-first-page-number = ##t\n";
+        indentLess();
+        out() << "}\n";
+    }
+    writeDocumentHeader();
+    exportSheetBlocks(sheet);
+
+    flushOutput();
+}
+
+/*!
+	Exports the whole document to LilyPond syntax.
+
+	The sheets are written as consecutive \score blocks of a single book, so
+	LilyPond lays them out as one document with continuous page numbering.
+	The voice variables of each sheet are defined right before its \score block.
+*/
+void CALilyPondExport::exportDocumentImpl(CADocument* doc)
+{
+    stream()->setCodec("UTF-8");
+    setCurDocument(doc);
+
+    writeFileHeader();
+    writeDocumentHeader();
+    for (int i = 0; i < doc->sheetList().size() && !isCancelled(); i++) {
+        out() << "\n% " << doc->sheetList()[i]->name() << "\n";
+        exportSheetBlocks(doc->sheetList()[i]);
+    }
+
+    flushOutput();
+}
+
+/*!
+	Writes the Canorus and LilyPond version at the top of the file.
+*/
+void CALilyPondExport::writeFileHeader()
+{
     // Print file name and Canorus version in comments at the top of the file
     out() << "% This document was generated by Canorus, version " << CANORUS_VERSION << "\n";
 
     // Version of Lilypond syntax being generated.
     out() << "\\version \"2.10.0\"\n";
+}
 
-    writeDocumentHeader();
+/*!
+	Writes the voice variables and the \score block of the \a sheet.
+*/
+void CALilyPondExport::exportSheetBlocks(CASheet* sheet)
+{
+    setCurSheet(sheet);
+    _timeSignatureFound = false;
 
     for (int c = 0; c < sheet->contextList().size(); ++c) {
         if (sheet->contextList()[c]->contextType() == CAContext::Staff) {
@@ -1044,6 +1158,15 @@ void CALilyPondExport::writeDocumentHeader()
 {
     out() << "\n\\header {\n";
     indentMore();
+    if (!_bookPartLast) {
+        indent();
+        out() << "tagline        = ##f\n";
+    }
+    if (!_bookPartFirst) {
+        indentLess();
+        out() << "}\n";
+        return;
+    }
     indent();
     out() << "title          = " << markupString(curDocument()->title()) << "\n";
     indent();
@@ -1133,6 +1256,10 @@ void CALilyPondExport::exportStaffVoices(CAStaff* staff)
 
         exportVoiceImpl(curVoice());
         out() << "\n"; // exportVoiceImpl doesn't put endline at the end
+
+        if (!advanceProgress()) {
+            return;
+        }
     }
 }
 
@@ -1374,6 +1501,30 @@ void CALilyPondExport::exportScoreBlock(CASheet* sheet)
     out() << "% }\n\n";
 }
 
+/*!
+	Writes the buffered output to the stream.
+
+	If the stream writes UTF-8 to a device, the already encoded buffer is written
+	directly. Otherwise (eg. the string of the source view) it is decoded and written
+	to the stream.
+*/
+void CALilyPondExport::flushOutput()
+{
+    if (_buffer.isEmpty()) {
+        return;
+    }
+
+    QTextStream& s = *stream();
+    if (s.device() && s.codec() && s.codec()->mibEnum() == 106 && !s.generateByteOrderMark()) {
+        s.flush();
+        s.device()->write(_buffer.data());
+    } else {
+        s << QString::fromUtf8(_buffer.data());
+    }
+
+    _buffer.clear();
+}
+
 /*!
 	Output tabs according to _indentLevel.
 */
@@ -1426,3 +1577,51 @@ void CALilyPondExport::voltaFunction(void)
 
 const QString CALilyPondExport::_regExpVoltaRepeat = QString("voltaRepeat (.*)");
 const QString CALilyPondExport::_regExpVoltaBar = QString("voltaBar (.*)");
+
+/*!
+	\class CALilyPondBuffer
+	\brief UTF-8 output buffer of the LilyPond export filter
+
+	Writing each token to QTextStream converts it to unicode and back. CALilyPondExport
+	writes tokens to this buffer instead and flushes it to the stream in blocks of
+	BLOCK bytes.
+
+	\sa CALilyPondExport::flushOutput()
+*/
+
+const int CALilyPondBuffer::BLOCK = 65536;
+
+CALilyPondBuffer::CALilyPondBuffer()
+{
+    _data.reserve(BLOCK + 1024);
+}
+
+CALilyPondBuffer& CALilyPondBuffer::operator<<(const QString& s)
+{
+    const QChar* c = s.constData();
+    for (int i = 0; i < s.size(); i++) {
+        if (c[i].unicode() >= 0x80) {
+            _data.append(s.midRef(i).toUtf8());
+            break;
+        }
+        _data.append(static_cast<char>(c[i].unicode()));
+    }
+
+    return *this;
+}
+
+CALilyPondBuffer& CALilyPondBuffer::operator<<(int n)
+{
+    char digits[12];
+    int i = sizeof(digits);
+    unsigned int u = (n < 0) ? 0u - static_cast<unsigned int>(n) : static_cast<unsigned int>(n);
+    do {
+        digits[--i] = static_cast<char>('0' + u % 10);
+        u /= 10;
+    } while (u);
+    if (n < 0) {
+        digits[--i] = '-';
+    }
+
+    return write(digits + i, sizeof(digits) - i);
+}
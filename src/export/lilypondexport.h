@@ -8,6 +8,7 @@
 #ifndef LILYPONDEXPORT_H_
 #define LILYPONDEXPORT_H_
 
+#include <QByteArray>
 #include <QString>
 #include <QTextStream>
 
@@ -26,6 +27,41 @@
 
 class CAChordNameContext;
 
+#ifndef SWIG
+class CALilyPondBuffer {
+public:
+    CALilyPondBuffer();
+
+    CALilyPondBuffer& operator<<(const QString& s);
+    CALilyPondBuffer& operator<<(int n);
+    inline CALilyPondBuffer& operator<<(const char* s)
+    {
+        _data.append(s);
+        return *this;
+    }
+    inline CALilyPondBuffer& operator<<(char c)
+    {
+        _data.append(c);
+        return *this;
+    }
+    inline CALilyPondBuffer& write(const char* s, int len)
+    {
+        _data.append(s, len);
+        return *this;
+    }
+
+    inline const QByteArray& data() { return _data; }
+    inline bool isEmpty() { return _data.isEmpty(); }
+    inline bool isFull() { return _data.size() >= BLOCK; }
+    inline void clear() { _data.resize(0); } // keeps the reserved capacity
+
+    static const int BLOCK;
+
+private:
+    QByteArray _data; // UTF-8 encoded
+};
+#endif
+
 class CALilyPondExport : public CAExport {
 #ifndef SWIG
     Q_OBJECT
@@ -33,6 +69,14 @@ class CALilyPondExport : public CAExport {
 public:
     CALilyPondExport(QTextStream* out = 0);
 
+    // Options for exporting a sheet as a part of a book typeset in several runs
+    inline void setFirstPageNumber(int firstPageNumber) { _firstPageNumber = firstPageNumber; }
+    inline void setBookPart(bool first, bool last)
+    {
+        _bookPartFirst = first;
+        _bookPartLast = last;
+    }
+
     ///////////////////////////
     // Polling export status //
     ///////////////////////////
@@ -45,7 +89,17 @@ public:
     inline int curIndentLevel() { return _curIndentLevel; }
 
 private:
+    inline CALilyPondBuffer& out()
+    {
+        if (_buffer.isFull())
+            flushOutput();
+        return _buffer;
+    }
+    void flushOutput();
+
+    void exportDocumentImpl(CADocument* doc);
     void exportSheetImpl(CASheet* sheet);
+    void exportSheetBlocks(CASheet* sheet);
     void exportScoreBlock(CASheet* sheet);
     void exportStaffVoices(CAStaff* staff);
     void exportVoiceImpl(CAVoice* voice);
@@ -58,6 +112,7 @@ private:
     void exportMarksAfterElement(CAMusElement*);
     void exportPlayable(CAPlayable* elt);
 
+    void writeFileHeader();
     void writeDocumentHeader();
     void scanForRepeats(CAStaff* staff);
     CADiatonicPitch writeRelativeIntro();
@@ -74,11 +129,8 @@ private:
     const QString barlineTypeToLilyPond(CABarline::CABarlineType type);
     const QString syllableToLilyPond(CASyllable* s);
 
-    inline const QString relativePitchToString(CANote* note, CADiatonicPitch prevPitch)
-    {
-        return relativePitchToString(note->diatonicPitch(), prevPitch);
-    }
-    const QString relativePitchToString(CADiatonicPitch p, CADiatonicPitch prevPitch);
+    void writeRelativePitch(CADiatonicPitch p, CADiatonicPitch prevPitch);
+    void writePlayableLength(CAPlayableLength length);
     void voiceVariableName(QString& name, int staffNum, int voiceNum);
     void spellNumbers(QString& s);
 
@@ -108,6 +160,7 @@ private:
     CADocument* _curDocument;
     int _curContextIndex;
     int _curIndentLevel;
+    CALilyPondBuffer _buffer;
 
     // Voice exporting current status
     CADiatonicPitch _lastNotePitch;
@@ -124,6 +177,10 @@ private:
     static const QString _regExpVoltaRepeat;
     static const QString _regExpVoltaBar;
     bool _timeSignatureFound;
+
+    int _firstPageNumber; // 0 leaves the page numbering to LilyPond
+    bool _bookPartFirst; // write the document title
+    bool _bookPartLast; // write the tagline
 };
 
 #endif /* LILYPONDEXPORT_H_*/
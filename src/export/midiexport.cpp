@@ -77,7 +77,7 @@ void CAMidiExport::send(QVector<unsigned char> message, int time)
     }
 }
 
-void CAMidiExport::sendMetaEvent(int time, char event, char a, char b, int)
+void CAMidiExport::sendMetaEvent(int time, char event, char a, char b, int c)
 {
     // We don't do a time check on time, and we compute
     // only the time increment when we really send an event out.
@@ -106,7 +106,7 @@ void CAMidiExport::sendMetaEvent(int time, char event, char a, char b, int)
         tc.append(8);
         trackChunk.append(tc);
     } else if (event == CAMidiDevice::Meta_Tempo) {
-        int usPerQuarter = 60000000 / a;
+        int usPerQuarter = c; // 24 bit, not limited to 255 quarters per minute like a char
         tc.append(writeTime(timeIncrement(time)));
         tc.append(static_cast<char>(CAMidiDevice::Midi_Ctl_Event));
         tc.append(event);
@@ -254,6 +254,9 @@ void CAMidiExport::exportDocumentImpl(CADocument* doc)
                 setCurVoice(staff->voiceList()[v]);
                 count++;
                 //std::cout << "Hallo  " << c << " " << v << "\n" << std::endl;
+                if (!advanceProgress()) {
+                    return;
+                }
             }
             break;
         }
@@ -304,6 +307,9 @@ void CAMidiExport::exportSheetImpl(CASheet* sheet)
                 setCurVoice(staff->voiceList()[v]);
                 count++;
                 //std::cout << "Hallo  " << c << " " << v << "\n" << std::endl;
+                if (!advanceProgress()) {
+                    return;
+                }
             }
             break;
         }
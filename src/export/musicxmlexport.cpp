@@ -108,6 +108,15 @@ void CAMusicXmlExport::exportSheetImpl(CASheet* sheet)
         xmlPart.setAttribute("id", QString("P") + QString::number(i + 1));
         exportStaffImpl(staffList[i], xmlPart);
         xmlScorePartwise.appendChild(xmlPart);
+
+        // voices of a staff are exported measure by measure together
+        bool cancelled = false;
+        for (int v = 0; v < staffList[i]->voiceList().size(); v++) {
+            cancelled = !advanceProgress();
+        }
+        if (cancelled) {
+            return;
+        }
     }
 
     xmlDoc.appendChild(xmlScorePartwise);
@@ -13,6 +13,7 @@
 #include "canorus.h" // needed for settings()
 #endif
 #include "core/settings.h"
+#include "score/sheet.h"
 
 /*!
 	\class CAPDFExport
@@ -52,6 +53,7 @@ void CAPDFExport::startExport()
     // For now we support only lilypond export
 #ifndef SWIGCPP
     _poTypesetCtl->setTypesetter((CACanorus::settings()->useSystemDefaultTypesetter()) ? (CASettings::DEFAULT_TYPESETTER_LOCATION) : (CACanorus::settings()->typesetterLocation()));
+    _poTypesetCtl->setServer(CACanorus::typesetServer());
 #else
     _poTypesetCtl->setTypesetter(CASettings::DEFAULT_TYPESETTER_LOCATION);
 #endif
@@ -75,6 +77,11 @@ void CAPDFExport::finishExport()
 /*!
 	Exports the document \a poDoc to LilyPond first and create a PDF from it
 	using the Typesetter instance.
+
+	If the typesetting server and Ghostscript are available, the sheets are typeset
+	separately as parts of one book and merged afterwards, so only the changed
+	sheets are typeset again. Otherwise the sheets are typeset together as a single
+	book, and the server's cache only helps, if the whole document is unchanged.
 */
 void CAPDFExport::exportDocumentImpl(CADocument* poDoc)
 {
@@ -85,9 +92,21 @@ void CAPDFExport::exportDocumentImpl(CADocument* poDoc)
     // We cannot create the typesetter instance (a QProcess in the end)
     // in the constructor as it's parent would be in a different thread!
     startExport();
+    if (_poTypesetCtl->getServer() && poDoc->sheetList().size() > 1 && !CATypesetCtl::pdfMergeProgram().isEmpty()) {
+        // Typeset the sheets separately, so only the changed ones are typeset again
+        removeOldFile();
+        setIndeterminateProgress(); // the typesetting time is unknown
+        if (!_poTypesetCtl->typesetSheets(poDoc, this)) {
+            qWarning("PDFExport: Typesetter %s was not finished", "lilypond");
+        }
+        return;
+    }
     // The exportDocument method defines the temporary file name and
     // directory, so we can only read it after the creation
     _poTypesetCtl->exportDocument(poDoc);
+    if (isCancelled()) {
+        return;
+    }
     // actual PDF creation is done now
     runTypesetter();
 }
@@ -104,6 +123,9 @@ void CAPDFExport::exportSheetImpl(CASheet* poSheet)
     // The exportSheet method defines the temporary file name and
     // directory, so we can only read it after the creation
     _poTypesetCtl->exportSheet(poSheet);
+    if (isCancelled()) {
+        return;
+    }
     // actual PDF creation is done now
     runTypesetter();
 }
@@ -115,17 +137,25 @@ void CAPDFExport::runTypesetter()
 {
     const QString roTempPath = _poTypesetCtl->getTempFilePath();
     _poTypesetCtl->setTSetOption(QString("o"), roTempPath);
-    // Remove old pdf file first, but ignore error (file might not exist)
+    removeOldFile();
+    setIndeterminateProgress(); // the typesetting time is unknown
+    _poTypesetCtl->runTypesetter(); // create pdf
+    // as we are not in the main thread wait until we are finished or cancelled
+    if (_poTypesetCtl->waitForFinished(this) == false) {
+        qWarning("PDFExport: Typesetter %s was not finished", "lilypond");
+    }
+}
+
+/*!
+	Remove the old pdf file, but ignore error (file might not exist)
+*/
+void CAPDFExport::removeOldFile()
+{
     if (!file()->remove()) {
         qWarning("PDFExport: Could not remove old pdf file %s, error %s", qPrintable(file()->fileName()),
             qPrintable(file()->errorString()));
         file()->unsetError();
     }
-    _poTypesetCtl->runTypesetter(); // create pdf
-    // as we are not in the main thread wait until we are finished
-    if (_poTypesetCtl->waitForFinished(-1) == false) {
-        qWarning("PDFExport: Typesetter %s was not finished", "lilypond");
-    }
 }
 
 /*!
@@ -15,7 +15,7 @@
 class CATypesetCtl;
 
 // PDF Export class doing lilypond export internally
-// !! exportDocument does not support threading !!
+// The typesetter result is copied to the destination in pdfFinished() once the export thread is finished
 class CAPDFExport : public CAExport {
 #ifndef SWIG
     Q_OBJECT
@@ -40,6 +40,7 @@ private:
     void exportDocumentImpl(CADocument* doc);
     void exportSheetImpl(CASheet* poSheet);
     void runTypesetter();
+    void removeOldFile();
 
 protected:
     CATypesetCtl* _poTypesetCtl;
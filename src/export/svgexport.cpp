@@ -6,6 +6,8 @@
 */
 
 // Includes
+#include <QFileInfo>
+
 #include "export/svgexport.h"
 #include "control/typesetctl.h"
 #include "export/lilypondexport.h"
@@ -13,6 +15,7 @@
 #include "canorus.h" // needed for settings()
 #endif
 #include "core/settings.h"
+#include "score/sheet.h"
 
 /*!
 	\class CASVGExport
@@ -52,6 +55,7 @@ void CASVGExport::startExport()
     // For now we support only lilypond export
 #ifndef SWIGCPP
     _poTypesetCtl->setTypesetter((CACanorus::settings()->useSystemDefaultTypesetter()) ? (CASettings::DEFAULT_TYPESETTER_LOCATION) : (CACanorus::settings()->typesetterLocation()));
+    _poTypesetCtl->setServer(CACanorus::typesetServer());
 #else
     _poTypesetCtl->setTypesetter(CASettings::DEFAULT_TYPESETTER_LOCATION);
 #endif
@@ -76,6 +80,9 @@ void CASVGExport::finishExport()
 /*!
 	Exports the document \a poDoc to LilyPond first and create a SVG from it
   using the Typesetter instance.
+
+	If the typesetting server is available, each sheet is typeset to its own SVG
+	file and unchanged sheets are taken from the server's cache.
 */
 void CASVGExport::exportDocumentImpl(CADocument* poDoc)
 {
@@ -86,10 +93,22 @@ void CASVGExport::exportDocumentImpl(CADocument* poDoc)
     // We cannot create the typesetter instance (a QProcess in the end)
     // in the constructor as it's parent would be in a different thread!
     startExport();
+    if (_poTypesetCtl->getServer()) {
+        // Typeset the sheets separately, so only the changed ones are typeset again
+        removeOldFile();
+        setIndeterminateProgress(); // the typesetting time is unknown
+        if (!_poTypesetCtl->typesetSheets(poDoc, this)) {
+            qWarning("SVGExport: Typesetter %s was not finished", "lilypond");
+        }
+        return;
+    }
     // The exportDocument method defines the temporary file name and
     // directory, so we can only read it after the creation
     _poTypesetCtl->exportDocument(poDoc);
-    // actual PDF creation is done now
+    if (isCancelled()) {
+        return;
+    }
+    // actual SVG creation is done now
     runTypesetter();
 }
 
@@ -105,7 +124,10 @@ void CASVGExport::exportSheetImpl(CASheet* poSheet)
     // The exportSheet method defines the temporary file name and
     // directory, so we can only read it after the creation
     _poTypesetCtl->exportSheet(poSheet);
-    // actual PDF creation is done now
+    if (isCancelled()) {
+        return;
+    }
+    // actual SVG creation is done now
     runTypesetter();
 }
 
@@ -117,17 +139,25 @@ void CASVGExport::runTypesetter()
     const QString roTempPath = _poTypesetCtl->getTempFilePath();
     _poTypesetCtl->setTSetOption(QString("o"), roTempPath);
     _poTypesetCtl->setTSetOption("dbackend", "svg", false, false);
-    // Remove old svg file first, but ignore error (file might not exist)
+    removeOldFile();
+    setIndeterminateProgress(); // the typesetting time is unknown
+    _poTypesetCtl->runTypesetter(); // create svg
+    // as we are not in the main thread wait until we are finished or cancelled
+    if (_poTypesetCtl->waitForFinished(this) == false) {
+        qWarning("SVGExport: Typesetter %s was not finished", "lilypond");
+    }
+}
+
+/*!
+	Remove the old svg file, but ignore error (file might not exist)
+*/
+void CASVGExport::removeOldFile()
+{
     if (!file()->remove()) {
         qWarning("SVGExport: Could not remove old svg file %s, error %s", qPrintable(file()->fileName()),
             qPrintable(file()->errorString()));
         file()->unsetError();
     }
-    _poTypesetCtl->runTypesetter(); // create svg
-    // as we are not in the main thread wait until we are finished
-    if (_poTypesetCtl->waitForFinished(-1) == false) {
-        qWarning("SVGExport: Typesetter %s was not finished", "lilypond");
-    }
 }
 
 /*!
@@ -154,6 +184,17 @@ void CASVGExport::svgFinished(int iExitCode)
             qPrintable(oTempFile.errorString()));
         return;
     }
+    // Further sheets of the document are stored next to the file as "-2.svg", "-3.svg", etc.
+    QFileInfo oTarget(file()->fileName());
+    for (int i = 2; !iExitCode && QFile::exists(getTempFilePath() + "-" + QString::number(i) + ".svg"); i++) {
+        QString oSheetFile = getTempFilePath() + "-" + QString::number(i) + ".svg";
+        QString oTargetFile = oTarget.absolutePath() + "/" + oTarget.completeBaseName() + "-" + QString::number(i) + ".svg";
+        QFile::remove(oTargetFile);
+        if (!QFile::copy(oSheetFile, oTargetFile)) {
+            qCritical("SVGExport: Could not copy temporary file %s", qPrintable(oSheetFile));
+        }
+        QFile::remove(oSheetFile);
+    }
     emit svgIsFinished(iExitCode);
     // Remove temporary files.
     if (!oTempFile.remove()) {
@@ -15,7 +15,7 @@
 class CATypesetCtl;
 
 // SVG Export class doing lilypond export internally
-// !! exportDocument does not support threading !!
+// The typesetter result is copied to the destination in svgFinished() once the export thread is finished
 class CASVGExport : public CAExport {
 #ifndef SWIG
     Q_OBJECT
@@ -41,6 +41,7 @@ private:
     void exportDocumentImpl(CADocument* doc);
     void exportSheetImpl(CASheet* poSheet);
     void runTypesetter();
+    void removeOldFile();
 
 protected:
     CATypesetCtl* _poTypesetCtl;
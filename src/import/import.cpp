@@ -161,11 +161,18 @@ void CAImport::run()
     emit importDone(status());
 }
 
-void CAImport::importDocument()
+/*!
+	Imports the whole document. If \a bStartThread is False, the import is done
+	in the calling thread and the document is available when the function returns.
+*/
+void CAImport::importDocument(bool bStartThread)
 {
     setImportPart(Document);
     setStatus(1); // process started
-    start();
+    if (bStartThread)
+        start();
+    else
+        run();
 }
 
 void CAImport::importSheet()
@@ -789,14 +789,10 @@ CADiatonicPitch CAMidiImport::matchPitchToKey(CAVoice* voice, int midiPitch)
         _actualKeySignatureAccs[i] = 0;
     _actualKeyAccidentalsSum = 0;
 
-    // Trace which Key Signature might be in effect.
-    // We make a local copy for later optimisation by only updating at a non
-    // linear input
-    QList<CAMusElement*> keyList = voice->getPreviousByType(
-        CAMusElement::KeySignature, voice->lastTimeEnd());
-    if (keyList.size()) {
+    // Trace which Key Signature might be in effect (binary search in the staff)
+    CAKeySignature* effSig = voice->keySignatureAt(voice->lastTimeEnd());
+    if (effSig) {
         // set the note name and its accidental and the accidentals of the scale
-        CAKeySignature* effSig = static_cast<CAKeySignature*>(keyList.last());
         return CADiatonicPitch::diatonicPitchFromMidiPitchKey(midiPitch, effSig->diatonicKey());
     } else {
         return CADiatonicPitch::diatonicPitchFromMidiPitch(midiPitch);
@@ -22,7 +22,6 @@
 #include "score/note.h"
 #include "score/sheet.h"
 #include "score/staff.h"
-#include "score/tempo.h"
 #include "score/timesignature.h"
 #include "score/voice.h"
 
@@ -54,6 +53,11 @@ CAPlayback::CAPlayback(CASheet* s, CAMidiDevice* m)
     _sheet = s;
     _midiDevice = m;
     _playSelectionOnly = false;
+
+    // also builds the cached staff and voice lists now, not concurrently in the playback thread
+    if (_sheet) {
+        _tempoMap = *_sheet->tempoMap();
+    }
 }
 
 /*!
@@ -86,7 +90,10 @@ void CAPlayback::initPlayback()
     _midiDevice = nullptr;
     _playSelectionOnly = false;
     _initTimeStart = 0;
-    _sleepFactor = 1.0; // set by tempo to determine the miliseconds for sleep
+    _lastTempo = -1;
+
+    _clock.start();
+    publishTime(-1, 0, 0);
 
     connect(this, SIGNAL(finished()), SLOT(stopNow()));
 }
@@ -170,22 +177,13 @@ void CAPlayback::run()
         if (_stop)
             continue; // no notes on anymore
 
+        sendTempo();
+
         minLength = -1;
         for (int i = 0; i < streamList().size(); i++) {
 
             while (streamAt(i).size() > streamIdx(i) && streamAt(i).at(streamIdx(i))->timeStart() == _curTime) {
 
-                // check if a rest carries a tempo mark
-                CAMusElement* me = streamAt(i).at(streamIdx(i));
-                if (me->musElementType() == CAMusElement::Rest) {
-                    for (int j = 0; j < me->markList().size(); j++) {
-                        if (me->markList()[j]->markType() == CAMark::Tempo) {
-                            CATempo* tempo = static_cast<CATempo*>(me->markList()[j]);
-                            midiDevice()->sendMetaEvent(_curTime, CAMidiDevice::Meta_Tempo, static_cast<char>(tempo->bpm()), 0, 0);
-                        }
-                    }
-                }
-
                 // note on
 
                 CANote* note = dynamic_cast<CANote*>(streamAt(i).at(streamIdx(i)));
@@ -205,10 +203,6 @@ void CAPlayback::run()
                             message << static_cast<unsigned char>(static_cast<CAInstrumentChange*>(note->markList()[j])->instrument());
                             midiDevice()->send(message, _curTime);
                             message.clear();
-                        } else if (note->markList()[j]->markType() == CAMark::Tempo) {
-                            updateSleepFactor(static_cast<CATempo*>(note->markList()[j]));
-                            CATempo* tempo = static_cast<CATempo*>(note->markList()[j]);
-                            midiDevice()->sendMetaEvent(_curTime, CAMidiDevice::Meta_Tempo, tempo->bpm(), 0, 0);
                         }
                     }
 
@@ -247,28 +241,78 @@ void CAPlayback::run()
         }
 
         if (minLength != -1) {
-            mSeconds += qRound(minLength * _sleepFactor);
+            int duration = qRound(_tempoMap.timeToMs(_curTime + minLength) - _tempoMap.timeToMs(_curTime));
+            mSeconds += duration;
+            publishTime(_curTime, minLength, duration);
 
             if (midiDevice()->isRealTime())
-                msleep(static_cast<ulong>(qRound(minLength * _sleepFactor)));
+                msleep(static_cast<ulong>(duration));
 
             _curTime += minLength;
         }
     }
 
     _curPlaying.clear();
+    publishTime(-1, 0, 0);
     stop();
 }
 
 /*!
-	Calculates the sleep factor for the given tempo \a t.
-	If \a t is null, it does nothing.
+	Sends the tempo at the current time to the midi device, if it changed since the
+	last call. Ritardandos are sent as a new tempo at each played chord.
  */
-void CAPlayback::updateSleepFactor(CATempo* t)
+void CAPlayback::sendTempo()
+{
+    int usPerQuarter = qBound(1, qRound(60000000.0 / _tempoMap.tempoAt(_curTime)), 0xFFFFFF);
+    if (usPerQuarter != _lastTempo) {
+        midiDevice()->sendMetaEvent(_curTime, CAMidiDevice::Meta_Tempo, 0, 0, usPerQuarter);
+        _lastTempo = usPerQuarter;
+    }
+}
+
+/*!
+	Stores the current playback step starting at \a time and lasting \a length in
+	Canorus time or \a duration in miliseconds for playbackTime().
+	Called by the playback thread only.
+*/
+void CAPlayback::publishTime(int time, int length, int duration)
 {
-    if (t) {
-        _sleepFactor = 60000.0f / (CAPlayableLength::playableLengthToTimeLength(t->beat()) * t->bpm());
+    _snapshotSequence.fetchAndAddOrdered(1);
+    _snapshotTime.storeRelease(time);
+    _snapshotLength.storeRelease(length);
+    _snapshotStamp.storeRelease(static_cast<int>(_clock.elapsed()));
+    _snapshotDuration.storeRelease(duration);
+    _snapshotSequence.fetchAndAddRelease(1);
+}
+
+/*!
+	Returns the Canorus time currently being played or -1, if the playback is not running.
+
+	The time is interpolated between the played notes using the wall clock and the tempo
+	map, so it advances smoothly, also during ritardandos, when polled at the display
+	refresh rate. This function never blocks the
+	playback thread and is safe to call from the GUI thread, eg. to move the playback
+	cursor in CAScoreView without touching curPlaying().
+
+	\sa playbackStep()
+*/
+int CAPlayback::playbackTime()
+{
+    int seq, time, length, stamp, duration;
+    do {
+        seq = _snapshotSequence.loadAcquire();
+        time = _snapshotTime.loadAcquire();
+        length = _snapshotLength.loadAcquire();
+        stamp = _snapshotStamp.loadAcquire();
+        duration = _snapshotDuration.loadAcquire();
+    } while ((seq & 1) || seq != _snapshotSequence.loadAcquire());
+
+    if (time < 0 || length <= 0 || duration <= 0) {
+        return time;
     }
+
+    qint64 elapsed = qBound(static_cast<qint64>(0), _clock.elapsed() - stamp, static_cast<qint64>(duration));
+    return qBound(time, _tempoMap.msToTime(_tempoMap.timeToMs(time) + elapsed), time + length);
 }
 
 /*!
@@ -412,10 +456,6 @@ void CAPlayback::initStreams(CASheet* sheet)
         _repeating = false;
         loopUntilPlayable(i, true); // ignore repeats
     }
-
-    if (_sheet) {
-        updateSleepFactor(_sheet->getTempo(getInitTimeStart()));
-    }
 }
 
 /*!
@@ -8,15 +8,18 @@
 #ifndef PLAYBACK_H_
 #define PLAYBACK_H_
 
+#include <QAtomicInt>
+#include <QElapsedTimer>
 #include <QList>
 #include <QThread>
 
+#include "score/tempomap.h"
+
 class CAMidiDevice;
 class CASheet;
 class CAMusElement;
 class CAPlayable;
 class CANote;
-class CATempo;
 
 class CAPlayback : public QThread {
 #ifndef SWIG
@@ -38,6 +41,8 @@ public:
     inline CASheet* sheet() { return _sheet; }
     inline void setSheet(CASheet* s) { _sheet = s; }
     inline QList<CAPlayable*>& curPlaying() { return _curPlaying; }
+    int playbackTime();
+    inline int playbackStep() { return _snapshotTime.loadAcquire(); }
 
 #ifndef SWIG
 public slots:
@@ -56,7 +61,8 @@ private:
     void initStreams(CASheet* sheet);
     void loopUntilPlayable(int i, bool ignoreRepeats = false);
     void playSelectionImpl();
-    void updateSleepFactor(CATempo* t);
+    void sendTempo();
+    void publishTime(int time, int length, int duration);
 
     inline QList<CAMusElement*>& streamAt(int idx) { return _streamList[idx]; }
     inline const QList<QList<CAMusElement*>>& streamList() { return _streamList; }
@@ -79,7 +85,8 @@ private:
     QList<CAMusElement*> _selection;
 
     int _initTimeStart;
-    float _sleepFactor;
+    CATempoMap _tempoMap; // built in the constructor, read-only while playing
+    int _lastTempo; // last tempo sent to the midi device in microseconds per quarter
 
     QList<QList<CAMusElement*>> _streamList;
     QList<CAPlayable*> _curPlaying; // list of currently playing notes and rests
@@ -87,6 +94,14 @@ private:
     bool _repeating;
     int* _lastRepeatOpenIdx;
     int _curTime;
+
+    // Snapshot of the playback position read by the GUI thread, see playbackTime()
+    QElapsedTimer _clock; // started in the constructor, before the playback thread
+    QAtomicInt _snapshotSequence; // odd while the snapshot is being written
+    QAtomicInt _snapshotTime; // time of the current step or -1, if not playing
+    QAtomicInt _snapshotLength; // length of the current step in Canorus time
+    QAtomicInt _snapshotStamp; // _clock milliseconds when the current step started
+    QAtomicInt _snapshotDuration; // length of the current step in milliseconds
 };
 
 #endif /* PLAYBACK_H_ */
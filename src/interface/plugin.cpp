@@ -40,6 +40,7 @@ CAPlugin::CAPlugin()
     _updateUrl = "";
 
     _enabled = false;
+    _initialized = false;
 }
 
 CAPlugin::CAPlugin(QString name, QString author, QString version, QString date, QString dirName, QString homeUrl, QString updateUrl)
@@ -53,6 +54,7 @@ CAPlugin::CAPlugin(QString name, QString author, QString version, QString date,
     _updateUrl = updateUrl;
 
     _enabled = false;
+    _initialized = false;
 }
 
 CAPlugin::~CAPlugin()
@@ -82,11 +84,52 @@ bool CAPlugin::action(QString onAction, CAMainWin* mainWin, CADocument* document
     return (!error);
 }
 
+/*!
+	Calls the plugin's "onInit" actions, if they weren't called yet.
+
+	CAPluginManager::enablePlugin() defers the initialization of the scripted plugins, so
+	the interpreters are not started together with Canorus. Such plugins are initialized
+	by callAction() before their first other action is called.
+
+	Returns True, if the "onInit" actions were successfully called now or before,
+	otherwise False.
+*/
+bool CAPlugin::initialize(CAMainWin* mainWin)
+{
+    if (_initialized)
+        return true;
+
+    _initialized = true;
+    return action("onInit", mainWin);
+}
+
+/*!
+	Returns True, if any of the plugin's actions reacting on \a onAction is written in a
+	scripting language, otherwise False.
+*/
+bool CAPlugin::isScripted(QString onAction)
+{
+    QList<CAPluginAction*> actionList = _actionMap.values(onAction);
+    for (int i = 0; i < actionList.size(); i++) {
+        if (actionList[i]->lang() == "ruby" || actionList[i]->lang() == "python")
+            return true;
+    }
+
+    return false;
+}
+
 bool CAPlugin::callAction(CAPluginAction* action, CAMainWin* mainWin, CADocument* document, QEvent*, QPoint*, QString filename)
 {
     bool error = false;
 #ifndef SWIGCPP
     bool rebuildDocument = false;
+
+    // Deferred initialization of a scripted plugin, see initialize()
+    if (action->onAction() != "onInit" && action->onAction() != "onExit" && !_initialized)
+        initialize(mainWin);
+
+    // The interpreters are started when the first plugin action is called
+    CACanorus::initScripting();
 #endif
 
 #ifdef USE_RUBY
@@ -67,6 +67,17 @@ public:
     void setEnabled(bool enabled) { _enabled = enabled; }
     bool isEnabled() { return _enabled; }
 
+    /**
+		 * Calls the plugin's onInit actions, if they weren't called yet.
+		 *
+		 * @param mainWin Pointer to the current application main window.
+		 * @return True, if the onInit actions were successfully called now or before, False otherwise.
+		 */
+    bool initialize(CAMainWin* mainWin);
+    bool isInitialized() { return _initialized; }
+    void setInitialized(bool initialized) { _initialized = initialized; }
+    bool isScripted(QString onAction);
+
     QString name() { return _name; }
     QString author() { return _author; }
     QString version() { return _version; }
@@ -110,6 +121,7 @@ private:
     QString _homeUrl;
     QString _updateUrl;
     bool _enabled;
+    bool _initialized; /// onInit actions were called, scripted plugins are initialized on their first action
 
     QMultiHash<QString, CAPluginAction*> _actionMap; /// Key: onAction, Value: plugin's action
     QHash<QString, QMenu*> _menuMap; /// Map of plugin menu name -> Canorus menu object
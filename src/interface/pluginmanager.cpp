@@ -153,6 +153,9 @@ bool CAPluginManager::disablePlugins()
 /*!
 	Enables the plugin \a plugin and initializes it (action "onInit").
 
+	Scripted plugins are only initialized before their first action is called or when
+	the console is used, so the interpreters are not started with the main window.
+
 	Returns True, if the plugin was loaded successfully, otherwise False.
 
 	\sa disablePlugin()
@@ -181,7 +184,10 @@ bool CAPluginManager::enablePlugin(CAPlugin* plugin, CAMainWin* mainWin)
     }
 
     plugin->setEnabled(true);
-    return plugin->action("onInit", mainWin);
+    if (plugin->isScripted("onInit"))
+        return true; // see CAPlugin::initialize()
+
+    return plugin->initialize(mainWin);
 }
 
 /*!
@@ -197,13 +203,14 @@ bool CAPluginManager::disablePlugin(CAPlugin* plugin)
         return true;
 
     bool res = true;
-    for (int i = 0; i < CACanorus::mainWinList().size(); i++) {
+    for (int i = 0; plugin->isInitialized() && i < CACanorus::mainWinList().size(); i++) {
         if (!plugin->action("onExit", CACanorus::mainWinList()[i])) {
             res = false;
         }
     }
 
     plugin->setEnabled(false);
+    plugin->setInitialized(false);
 
     // remove plugin specific actions from generic plugins actions list
     QList<QString> actions = plugin->actionList();
@@ -8,6 +8,7 @@
 #include <QPainter>
 
 #include "layout/drawable.h"
+#include "layout/drawablearena.h"
 #include "layout/drawablecontext.h"
 #include "layout/drawablemuselement.h"
 
@@ -25,6 +26,25 @@ CADrawable::CADrawable(double x, double y)
 {
 }
 
+/*!
+	Allocates the drawable from the current drawable arena, if any.
+
+	\sa CADrawableArena
+*/
+void* CADrawable::operator new(size_t size)
+{
+    return CADrawableArena::allocate(size);
+}
+
+/*!
+	Releases the memory of the destroyed drawable.
+	Drawables of an arena are freed together by CADrawableArena::reset().
+*/
+void CADrawable::operator delete(void* p)
+{
+    CADrawableArena::release(p);
+}
+
 void CADrawable::drawHScaleHandles(QPainter* p, CADrawSettings s)
 {
     p->setPen(QPen(s.color));
@@ -45,6 +45,9 @@ public:
 
     CADrawable(double x, double y); // x and y position of an element in absolute world units
     virtual ~CADrawable() {}
+
+    static void* operator new(size_t size);
+    static void operator delete(void* p);
     virtual void draw(QPainter* p, const CADrawSettings s) = 0;
     virtual CADrawable* clone() = 0;
 
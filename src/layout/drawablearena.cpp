@@ -0,0 +1,174 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#include <new>
+
+#include "layout/drawablearena.h"
+
+/*!
+	\class CADrawableArena
+	\brief Bump allocator for the drawables of a single layout
+
+	CAScoreView::rebuild() recreates all its drawables on every change. Each view owns
+	an arena which is made current() while CALayoutEngine lays out the sheet, so the new
+	drawables are placed one after another in blocks. Allocating a drawable only moves a
+	pointer and deleting it only decrements a counter. When the view destroys the old
+	drawables, reset() releases the blocks in a single step and keeps the largest block
+	of each region for the next layout.
+
+	Drawables are bumped into separate regions by their size, rounded to the header
+	size, which in practice separates them by type. Notes, rests, staffs and so on are
+	each packed in the order they were laid out, so painting the drawables of one type
+	walks their memory forward instead of jumping between types. A region starts with a
+	FIRST_CHUNK_SIZE block and doubles it up to CHUNK_SIZE, so the rarely used types
+	don't reserve a full block each. Sizes above the last class share the last region.
+
+	Drawables may still be deleted one by one (eg. by the controllers replacing a
+	drawable) and may outlive the rebuild they were created in. Every drawable is
+	preceded by a header pointing to its generation of the arena, so the blocks of an
+	old generation are only freed when its last drawable is deleted. Drawables created
+	while no arena is current use the global allocator.
+
+	The current arena is per thread and the arena is not locked, so drawables allocated
+	from an arena must be deleted in the same thread (the GUI thread).
+
+	\sa CADrawable::operator new()
+*/
+
+thread_local CADrawableArena* CADrawableArena::_current = nullptr;
+
+CADrawableArena::CADrawableArena()
+    : _generation(nullptr)
+{
+}
+
+/*!
+	Destroys the arena. The blocks of the drawables still alive are freed when the last
+	of them is deleted.
+*/
+CADrawableArena::~CADrawableArena()
+{
+    if (_current == this) {
+        _current = nullptr;
+    }
+
+    if (_generation) {
+        _generation->retired = true;
+        if (!_generation->live) {
+            freeGeneration(_generation);
+        }
+    }
+}
+
+/*!
+	Starts a new layout. Call after the drawables of the previous layout were deleted.
+
+	If all the drawables are gone, the largest block of each region is reused and the
+	others are freed. Otherwise the old generation is freed with its last drawable.
+*/
+void CADrawableArena::reset()
+{
+    if (!_generation) {
+        return;
+    }
+
+    if (_generation->live) {
+        _generation->retired = true;
+        _generation = nullptr;
+        return;
+    }
+
+    for (CARegion& region : _generation->regions) {
+        while (region.chunks.size() > 1) {
+            ::operator delete(region.chunks.takeFirst());
+        }
+        region.used = 0;
+    }
+}
+
+/*!
+	Returns the memory for a new drawable of the given \a size from the current()
+	arena or from the global allocator, if there is no current arena.
+*/
+void* CADrawableArena::allocate(size_t size)
+{
+    size_t total = sizeof(CAHeader) + ((size + sizeof(CAHeader) - 1) / sizeof(CAHeader)) * sizeof(CAHeader);
+    CAHeader* header;
+    if (_current && total <= CHUNK_SIZE) {
+        header = static_cast<CAHeader*>(_current->bump(total));
+        header->generation = _current->_generation;
+        header->generation->live++;
+    } else {
+        header = static_cast<CAHeader*>(::operator new(total));
+        header->generation = nullptr;
+    }
+
+    return header + 1;
+}
+
+/*!
+	Releases the memory of the deleted drawable \a p.
+*/
+void CADrawableArena::release(void* p)
+{
+    if (!p) {
+        return;
+    }
+
+    CAHeader* header = static_cast<CAHeader*>(p) - 1;
+    CAGeneration* generation = header->generation;
+    if (!generation) {
+        ::operator delete(header);
+    } else if (!--generation->live && generation->retired) {
+        freeGeneration(generation);
+    }
+}
+
+void* CADrawableArena::bump(size_t size)
+{
+    if (!_generation) {
+        _generation = new CAGeneration;
+        for (CARegion& region : _generation->regions) {
+            region.capacity = 0;
+            region.used = 0;
+        }
+        _generation->live = 0;
+        _generation->retired = false;
+    }
+
+    CARegion& region = _generation->regions[sizeClass(size)];
+    if (region.used + size > region.capacity) {
+        region.capacity = region.capacity ? qMin(region.capacity * 2, size_t(CHUNK_SIZE)) : FIRST_CHUNK_SIZE;
+        while (region.capacity < size) {
+            region.capacity *= 2;
+        }
+        region.chunks << static_cast<char*>(::operator new(region.capacity));
+        region.used = 0;
+    }
+
+    void* p = region.chunks.last() + region.used;
+    region.used += size;
+    return p;
+}
+
+/*!
+	Returns the region of the drawables with the given \a size including the header.
+*/
+int CADrawableArena::sizeClass(size_t size)
+{
+    return qBound(0, int(size / sizeof(CAHeader)) - 2, SIZE_CLASSES - 1);
+}
+
+void CADrawableArena::freeGeneration(CAGeneration* generation)
+{
+    for (CARegion& region : generation->regions) {
+        for (char* chunk : region.chunks) {
+            ::operator delete(chunk);
+        }
+    }
+    delete generation;
+}
@@ -0,0 +1,60 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#ifndef DRAWABLEARENA_H_
+#define DRAWABLEARENA_H_
+
+#include <QList>
+#include <cstddef>
+
+class CADrawableArena {
+public:
+    static const size_t CHUNK_SIZE = 64 * 1024;
+    static const size_t FIRST_CHUNK_SIZE = 4 * 1024;
+    static const int SIZE_CLASSES = 32;
+
+    CADrawableArena();
+    ~CADrawableArena();
+
+    void reset();
+
+    static void* allocate(size_t size);
+    static void release(void* p);
+
+    inline static CADrawableArena* current() { return _current; }
+    inline static void setCurrent(CADrawableArena* arena) { _current = arena; }
+
+private:
+    // Blocks of the drawables of one size class
+    struct CARegion {
+        QList<char*> chunks;
+        size_t capacity; // size of the last chunk
+        size_t used; // bytes used in the last chunk
+    };
+
+    // Drawables allocated between two reset() calls
+    struct CAGeneration {
+        CARegion regions[SIZE_CLASSES];
+        int live; // drawables not deleted yet
+        bool retired; // reset() was called, free the chunks once live drops to 0
+    };
+
+    // Put in front of every drawable, so operator delete finds its generation
+    union CAHeader {
+        CAGeneration* generation; // Null for drawables allocated outside of an arena
+        std::max_align_t align;
+    };
+
+    void* bump(size_t size);
+    static int sizeClass(size_t size);
+    static void freeGeneration(CAGeneration* generation);
+
+    CAGeneration* _generation;
+    static thread_local CADrawableArena* _current;
+};
+
+#endif /* DRAWABLEARENA_H_ */
@@ -39,7 +39,6 @@ CADrawableNote::CADrawableNote(CANote* n, CADrawableContext* drawableContext, do
 
     _stemDirection = note()->actualStemDirection();
 
-    // Notehead widths are hardcoded below; it's possible to determine them at runtime using QFontMetrics, if necessary.
     switch (n->playableLength().musicLength()) {
     case CAPlayableLength::HundredTwentyEighth:
     case CAPlayableLength::SixtyFourth:
@@ -49,34 +48,31 @@ CADrawableNote::CADrawableNote(CANote* n, CADrawableContext* drawableContext, do
     case CAPlayableLength::Quarter:
         _noteHeadGlyphName = "noteheads.s2";
         _penWidth = 1.2;
-        setWidth(11);
         setHeight(10);
         break;
 
     case CAPlayableLength::Half:
         _noteHeadGlyphName = "noteheads.s1";
         _penWidth = 1.3;
-        setWidth(12);
         setHeight(10);
         break;
 
     case CAPlayableLength::Whole:
         _noteHeadGlyphName = "noteheads.s0";
         _penWidth = 0;
-        setWidth(17);
         setHeight(8);
         break;
 
     case CAPlayableLength::Breve:
         _noteHeadGlyphName = "noteheads.sM1";
         _penWidth = 0;
-        setWidth(18);
         setHeight(8);
         break;
     case CAPlayableLength::Undefined:
         fprintf(stderr, "Warning: CADrawableNote::CADrawableNote - Unhandled Length %d\n", n->playableLength().musicLength());
         break;
     }
+    setWidth(widthForLength(n->playableLength()));
     setYPos(y - height() / 2.0);
     setXPos(x);
 
@@ -122,13 +118,7 @@ CADrawableNote::CADrawableNote(CANote* n, CADrawableContext* drawableContext, do
         break;
     }
 
-    _noteHeadWidth = width();
-
-    if (n->playableLength().dotted()) {
-        setWidth(width() + 3);
-        for (int i = 0; i < n->playableLength().dotted(); i++)
-            setWidth(width() + 2);
-    }
+    _noteHeadWidth = noteHeadWidth(n->playableLength());
 
     _shadowNote = shadowNote;
 
@@ -139,6 +129,40 @@ CADrawableNote::~CADrawableNote()
 {
 }
 
+/*!
+	Returns the width of the notehead of the given playable \a length.
+*/
+double CADrawableNote::noteHeadWidth(CAPlayableLength length)
+{
+    // Notehead widths are hardcoded; it's possible to determine them at runtime using QFontMetrics, if necessary.
+    switch (length.musicLength()) {
+    case CAPlayableLength::HundredTwentyEighth:
+    case CAPlayableLength::SixtyFourth:
+    case CAPlayableLength::ThirtySecond:
+    case CAPlayableLength::Sixteenth:
+    case CAPlayableLength::Eighth:
+    case CAPlayableLength::Quarter:
+        return 11;
+    case CAPlayableLength::Half:
+        return 12;
+    case CAPlayableLength::Whole:
+        return 17;
+    case CAPlayableLength::Breve:
+        return 18;
+    default:
+        return 0;
+    }
+}
+
+/*!
+	Returns the width of the drawable note of the given playable \a length including its dots.
+	Used by the layout engine to advance the column without creating the drawable.
+*/
+double CADrawableNote::widthForLength(CAPlayableLength length)
+{
+    return noteHeadWidth(length) + (length.dotted() ? 3 + 2 * length.dotted() : 0);
+}
+
 void CADrawableNote::draw(QPainter* p, CADrawSettings s)
 {
     QFont font("Emmentaler");
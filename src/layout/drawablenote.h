@@ -32,6 +32,9 @@ public:
     void setDrawableAccidental(CADrawableAccidental* acc) { _drawableAcc = acc; }
     CADrawableAccidental* drawableAccidental() { return _drawableAcc; }
 
+    static double noteHeadWidth(CAPlayableLength length);
+    static double widthForLength(CAPlayableLength length);
+
 private:
     bool _drawLedgerLines; ///Are the ledger lines drawn or not. True when ledger lines needed, False when the note is inside the staff
     bool _shadowNote; ///Is the current note shadow note?
@@ -9,11 +9,12 @@
 #include <QPen>
 
 #include "layout/drawablenotecheckererror.h"
+#include "score/notecheckererror.h"
 
 CADrawableNoteCheckerError::CADrawableNoteCheckerError(CANoteCheckerError* nce, CADrawable* dTarget)
     : CADrawable(dTarget->xPos() - 5, dTarget->yPos() + dTarget->height() + 5)
+    , _targetElement(nce->targetElement())
 {
-    (void)nce;
     setWidth(dTarget->width() + 10);
     setHeight(5);
 }
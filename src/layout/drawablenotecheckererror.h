@@ -10,6 +10,7 @@
 
 #include "layout/drawable.h"
 
+class CAMusElement;
 class CANoteCheckerError;
 
 class CADrawableNoteCheckerError : public CADrawable {
@@ -17,6 +18,11 @@ public:
     CADrawableNoteCheckerError(CANoteCheckerError* nce, CADrawable* dTarget);
     void draw(QPainter* p, const CADrawSettings s);
     CADrawable* clone();
+
+    inline CAMusElement* targetElement() { return _targetElement; }
+
+private:
+    CAMusElement* _targetElement; // only compared, the error itself may already be deleted
 };
 
 #endif /* DRAWABLECONTEXT_H_ */
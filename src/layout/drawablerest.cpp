@@ -23,54 +23,45 @@ CADrawableRest::CADrawableRest(CARest* rest, CADrawableContext* drawableContext,
 
     switch (rest->playableLength().musicLength()) {
     case CAPlayableLength::HundredTwentyEighth:
-        setWidth(16);
         setHeight(49);
         break;
 
     case CAPlayableLength::SixtyFourth:
-        setWidth(14);
         setHeight(41);
         break;
 
     case CAPlayableLength::ThirtySecond:
-        setWidth(12);
         setHeight(33);
         setYPos(y + 2);
         break;
 
     case CAPlayableLength::Sixteenth:
-        setWidth(10);
         setHeight(24);
         setYPos(y + static_cast<CADrawableStaff*>(drawableContext)->lineSpace());
         break;
 
     case CAPlayableLength::Eighth:
-        setWidth(8);
         setHeight(17);
         setYPos(y + static_cast<CADrawableStaff*>(drawableContext)->lineSpace());
         break;
 
     case CAPlayableLength::Quarter:
-        setWidth(8);
         setHeight(20);
         setYPos(y + static_cast<CADrawableStaff*>(drawableContext)->lineSpace());
         break;
 
     case CAPlayableLength::Half:
-        setWidth(12);
         setHeight(5);
         setYPos(y + 1.5 * static_cast<CADrawableStaff*>(drawableContext)->lineSpace());
         break;
 
     case CAPlayableLength::Whole:
-        setWidth(12);
         setHeight(5);
         //values in constructor are the notehead center coords. yPos represents the top of the stem.
         setYPos(y + static_cast<CADrawableStaff*>(drawableContext)->lineSpace());
         break;
 
     case CAPlayableLength::Breve:
-        setWidth(4);
         setHeight(9);
         setYPos(y + static_cast<CADrawableStaff*>(drawableContext)->lineSpace());
         break;
@@ -80,17 +71,48 @@ CADrawableRest::CADrawableRest(CARest* rest, CADrawableContext* drawableContext,
         break;
     }
 
-    _restWidth = _width;
+    _restWidth = restWidth(rest->playableLength());
+    setWidth(widthForLength(rest->playableLength()));
+}
+
+CADrawableRest::~CADrawableRest()
+{
+}
 
-    if (rest->playableLength().dotted()) {
-        setWidth(width() + 3);
-        for (int i = 0; i < rest->playableLength().dotted(); i++)
-            setWidth(width() + 2);
+/*!
+	Returns the width of the rest symbol of the given playable \a length without dots.
+*/
+double CADrawableRest::restWidth(CAPlayableLength length)
+{
+    switch (length.musicLength()) {
+    case CAPlayableLength::HundredTwentyEighth:
+        return 16;
+    case CAPlayableLength::SixtyFourth:
+        return 14;
+    case CAPlayableLength::ThirtySecond:
+        return 12;
+    case CAPlayableLength::Sixteenth:
+        return 10;
+    case CAPlayableLength::Eighth:
+    case CAPlayableLength::Quarter:
+        return 8;
+    case CAPlayableLength::Half:
+    case CAPlayableLength::Whole:
+        return 12;
+    case CAPlayableLength::Breve:
+        return 4;
+    default:
+        return 0;
     }
 }
 
-CADrawableRest::~CADrawableRest()
+/*!
+	Returns the width of the drawable rest of the given playable \a length including its dots.
+	Used by the layout engine to advance the column without creating the drawable.
+*/
+double CADrawableRest::widthForLength(CAPlayableLength length)
 {
+    return restWidth(length) + (length.dotted() ? 3 + 2 * length.dotted() : 0);
 }
 
 CADrawableRest* CADrawableRest::clone(CADrawableContext* newContext)
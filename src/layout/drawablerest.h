@@ -21,6 +21,9 @@ public:
 
     inline CARest* rest() { return static_cast<CARest*>(_musElement); }
 
+    static double restWidth(CAPlayableLength length);
+    static double widthForLength(CAPlayableLength length);
+
 private:
     double _restWidth; ///Width of the rest itself without dots, ledger lines etc.
 };
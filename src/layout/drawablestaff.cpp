@@ -7,6 +7,7 @@
 
 #include <QDebug>
 #include <QPainter>
+#include <algorithm>
 
 #include "layout/drawablebarline.h"
 #include "layout/drawableclef.h"
@@ -138,15 +139,24 @@ int CADrawableStaff::calculatePitch(double x, double y)
     return qRound(28 - (y - yC1) / (lineSpace() / 2.0));
 }
 
+/*!
+	Returns the number of elements in the X-ordered lookup \a list placed before the given \a x.
+	Uses binary search.
+*/
+template <typename T>
+static int drawablesBefore(const QList<T*>& list, double x)
+{
+    return std::lower_bound(list.constBegin(), list.constEnd(), x,
+               [](const T* elt, double xPos) { return elt->xPos() < xPos; })
+        - list.constBegin();
+}
+
 /*!
 	Adds a clef \a clef to the clef list for faster search of the current clef in the staff.
 */
 void CADrawableStaff::addClef(CADrawableClef* clef)
 {
-    int i;
-    for (i = 0; ((i < _drawableClefList.size()) && (clef->xPos() > _drawableClefList[i]->xPos())); i++)
-        ;
-    _drawableClefList.insert(i, clef);
+    _drawableClefList.insert(drawablesBefore(_drawableClefList, clef->xPos()), clef);
 }
 
 /*!
@@ -163,11 +173,8 @@ bool CADrawableStaff::removeClef(CADrawableClef* clef)
 */
 CAClef* CADrawableStaff::getClef(double x)
 {
-    int i;
-    for (i = 0; ((i < _drawableClefList.size()) && (x > _drawableClefList[i]->xPos())); i++)
-        ;
-
-    return ((--i < 0) ? nullptr : _drawableClefList[i]->clef());
+    int i = drawablesBefore(_drawableClefList, x);
+    return (i ? _drawableClefList[i - 1]->clef() : nullptr);
 }
 
 /*!
@@ -202,10 +209,7 @@ int CADrawableStaff::getAccs(double x, int pitch)
 */
 void CADrawableStaff::addKeySignature(CADrawableKeySignature* keySig)
 {
-    int i;
-    for (i = 0; ((i < _drawableKeySignatureList.size()) && (keySig->xPos() > _drawableKeySignatureList[i]->xPos())); i++)
-        ;
-    _drawableKeySignatureList.insert(i, keySig);
+    _drawableKeySignatureList.insert(drawablesBefore(_drawableKeySignatureList, keySig->xPos()), keySig);
 }
 
 /*!
@@ -264,11 +268,8 @@ bool CADrawableStaff::removeBarline(CADrawableBarline* barline)
 */
 CAKeySignature* CADrawableStaff::getKeySignature(double x)
 {
-    int i;
-    for (i = 0; ((i < _drawableKeySignatureList.size()) && (x > _drawableKeySignatureList[i]->xPos())); i++)
-        ;
-
-    return ((--i < 0) ? nullptr : _drawableKeySignatureList[i]->keySignature());
+    int i = drawablesBefore(_drawableKeySignatureList, x);
+    return (i ? _drawableKeySignatureList[i - 1]->keySignature() : nullptr);
 }
 
 /*!
@@ -276,10 +277,7 @@ CAKeySignature* CADrawableStaff::getKeySignature(double x)
 */
 void CADrawableStaff::addTimeSignature(CADrawableTimeSignature* timeSig)
 {
-    int i;
-    for (i = 0; ((i < _drawableTimeSignatureList.size()) && (timeSig->xPos() > _drawableTimeSignatureList[i]->xPos())); i++)
-        ;
-    _drawableTimeSignatureList.insert(i, timeSig);
+    _drawableTimeSignatureList.insert(drawablesBefore(_drawableTimeSignatureList, timeSig->xPos()), timeSig);
 }
 
 /*!
@@ -296,11 +294,8 @@ bool CADrawableStaff::removeTimeSignature(CADrawableTimeSignature* timeSig)
 */
 CATimeSignature* CADrawableStaff::getTimeSignature(double x)
 {
-    int i;
-    for (i = 0; ((i < _drawableTimeSignatureList.size()) && (x > _drawableTimeSignatureList[i]->xPos())); i++)
-        ;
-
-    return ((--i < 0) ? nullptr : _drawableTimeSignatureList[i]->timeSignature());
+    int i = drawablesBefore(_drawableTimeSignatureList, x);
+    return (i ? _drawableTimeSignatureList[i - 1]->timeSignature() : nullptr);
 }
 
 void CADrawableStaff::addMElement(CADrawableMusElement* elt)
@@ -21,20 +21,29 @@ CADrawableSyllable::CADrawableSyllable(CASyllable* s, CADrawableLyricsContext* c
     : CADrawableMusElement(s, c, x, y)
 {
     setDrawableMusElementType(DrawableSyllable);
+    setWidth(widthForText(s->text()));
+    setHeight(qRound(DEFAULT_TEXT_SIZE));
+}
+
+CADrawableSyllable::~CADrawableSyllable()
+{
+}
+
+/*!
+	Returns the width of the drawable syllable with the given \a text.
+	Used by the layout engine to advance the column without creating the drawable.
+*/
+double CADrawableSyllable::widthForText(const QString& text)
+{
     QFont font("Century Schoolbook L");
     font.setPixelSize(qRound(DEFAULT_TEXT_SIZE));
     QFontMetrics fm(font);
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 11, 0))
-    int textWidth = fm.horizontalAdvance(textToDrawableText(s->text()));
+    int textWidth = fm.horizontalAdvance(textToDrawableText(text));
 #else
-    int textWidth = fm.width(textToDrawableText(s->text()));
+    int textWidth = fm.width(textToDrawableText(text));
 #endif
-    setWidth(textWidth < 11 ? 11 : textWidth); // set minimum text width at least 11 points
-    setHeight(qRound(DEFAULT_TEXT_SIZE));
-}
-
-CADrawableSyllable::~CADrawableSyllable()
-{
+    return (textWidth < 11 ? 11 : textWidth); // set minimum text width at least 11 points
 }
 
 void CADrawableSyllable::draw(QPainter* p, const CADrawSettings s)
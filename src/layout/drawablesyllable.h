@@ -23,11 +23,13 @@ public:
 
     CASyllable* syllable() { return static_cast<CASyllable*>(musElement()); }
 
+    static double widthForText(const QString& text);
+
     static const double DEFAULT_TEXT_SIZE;
     static const double DEFAULT_DASH_LENGTH;
 
 private:
-    inline const QString textToDrawableText(QString in) { return in.replace("_", " "); }
+    inline static const QString textToDrawableText(QString in) { return in.replace("_", " "); }
 };
 
 #endif /* DRAWABLESYLLABLE_H_ */
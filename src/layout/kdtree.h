@@ -8,10 +8,11 @@
 #ifndef KDTREE_H
 #define KDTREE_H
 
-#include <QMultiMap>
+#include <QList>
 #include <QRect>
+#include <QVector>
+#include <algorithm>
 #include <iostream> // debugging
-#include <limits> // max double for managing staffs with unlimited width
 
 #include "layout/drawable.h"
 #include "layout/drawablecontext.h"
@@ -22,19 +23,43 @@
 #include "score/playable.h"
 #include "score/voice.h"
 
+/*!
+	Helpers for CAKDTree to mirror the context and the voice of the drawable into its
+	lookup arrays. Drawables which aren't music elements have none.
+*/
+inline CADrawableContext* kdTreeContextOf(CADrawableMusElement* elt) { return elt->drawableContext(); }
+inline CADrawableContext* kdTreeContextOf(CADrawable*) { return nullptr; }
+inline const void* kdTreeVoiceOf(CADrawableMusElement* elt, bool& playable)
+{
+    playable = (elt->musElement() && elt->musElement()->isPlayable());
+    if (playable) {
+        return static_cast<CAPlayable*>(elt->musElement())->voice();
+    }
+    return (elt->musElement() ? elt->musElement()->context() : nullptr);
+}
+inline const void* kdTreeVoiceOf(CADrawable*, bool& playable)
+{
+    playable = false;
+    return nullptr;
+}
+
 /*!
 	\class CAKDTree
 	\brief Space partitioning structure for fast access to drawable elements on canvas
 
 	This class is a data structure focused on efficient access to the drawable
-	instances of the music elements. It is based on an interval tree and employs
-	multiple QMap instances to enable efficient query of elements in the given
-	interval, finding the next element in the same staff and mapping a music
-	element to one or more drawable instances.
+	instances of the music elements. The geometry, the context and the voice of the
+	elements are mirrored into packed arrays ordered by the X coordinate (structure of
+	arrays), so the range queries, the nearest element search and the selection tests
+	scan contiguous memory and only dereference the elements they return.
+
+	Elements are added in an arbitrary order while laying out the score. The arrays are
+	sorted when the tree is queried for the first time after the elements were added.
+	The geometry is read at that moment, so the elements should not be moved after
+	the query.
 
 	\sa CAScoreView, CADrawable
 */
-
 template <typename T>
 class CAKDTree {
 public:
@@ -54,18 +79,35 @@ public:
     double getMaxY();
 
     void clear(bool autoDelete = true);
-    inline int size() { return _mapX.size(); }
-    QList<T> list() { return _mapX.values(); }
+    inline int size() { return _elements.size(); }
+    QList<T> list();
 
 private:
     //////////////////////
     // Basic properties //
     //////////////////////
-    QMultiMap<double, T> _mapX; // List of all the drawable elements sorted by xPos()
-    QMultiMap<double, T> _mapXW; // List of all the drawable elements sorted by xPos()+width()
+    QList<T> _elements; // List of all the drawable elements in the order they were added
+    double _maxX; // The largest xPos()+width() value of any element with limited width
     double _maxY; // The largest Ypos()+height() value of any element
 
-    void calculateMaxY();
+    ////////////////////////////////////////////
+    // Lookup arrays, sorted by xPos()         //
+    // Equal positions: recently added first //
+    ////////////////////////////////////////////
+    void updateIndex();
+    bool matches(int i, CADrawableContext* context, CAVoice* voice);
+
+    bool _indexDirty;
+    QVector<T> _sorted;
+    QVector<double> _x;
+    QVector<double> _y;
+    QVector<double> _w; // 0 for elements with unlimited width (e.g. staffs)
+    QVector<double> _h;
+    QVector<CADrawableContext*> _context;
+    QVector<const void*> _voice; // voice of playable elements, context of the others
+    QVector<char> _playable;
+    QVector<int> _unlimited; // indices of the elements with unlimited width
+    double _maxWidth; // The largest width() of any element with limited width
 };
 
 /*!
@@ -74,7 +116,10 @@ private:
 template <typename T>
 CAKDTree<T>::CAKDTree()
 {
+    _maxX = 0;
     _maxY = 0;
+    _maxWidth = 0;
+    _indexDirty = false;
 }
 
 /*!
@@ -83,14 +128,11 @@ CAKDTree<T>::CAKDTree()
 template <typename T>
 void CAKDTree<T>::addElement(T elt)
 {
-    _mapX.insertMulti(elt->xPos(), elt);
-
-    if (elt->width()) {
-        // regular music element
-        _mapXW.insertMulti(elt->xPos() + elt->width(), elt);
-    } else {
-        // music element with unlimited width (e.g. staffs)
-        _mapXW.insertMulti(std::numeric_limits<double>::max(), elt);
+    _elements << elt;
+    _indexDirty = true;
+
+    if (elt->width() && elt->xPos() + elt->width() > _maxX) {
+        _maxX = elt->xPos() + elt->width();
     }
 
     if (elt->yPos() + elt->height() > _maxY) {
@@ -106,15 +148,92 @@ template <typename T>
 void CAKDTree<T>::clear(bool autoDelete)
 {
     if (autoDelete) {
-        for (typename QMultiMap<double, T>::const_iterator it = _mapX.constBegin(); it != _mapX.constEnd(); it++) {
-            delete it.value();
+        for (int i = 0; i < _elements.size(); i++) {
+            delete _elements[i];
         }
     }
 
-    _mapX.clear();
-    _mapXW.clear();
-
+    _elements.clear();
+    _sorted.clear();
+    _x.clear();
+    _y.clear();
+    _w.clear();
+    _h.clear();
+    _context.clear();
+    _voice.clear();
+    _playable.clear();
+    _unlimited.clear();
+    _indexDirty = false;
+
+    _maxX = 0;
     _maxY = 0;
+    _maxWidth = 0;
+}
+
+/*!
+	Returns the list of all the elements sorted by their X coordinate.
+*/
+template <typename T>
+QList<T> CAKDTree<T>::list()
+{
+    updateIndex();
+
+    QList<T> l;
+    l.reserve(_sorted.size());
+    for (int i = 0; i < _sorted.size(); i++) {
+        l << _sorted[i];
+    }
+    return l;
+}
+
+/*!
+	Sorts the elements added since the last query and mirrors their geometry into the
+	lookup arrays.
+*/
+template <typename T>
+void CAKDTree<T>::updateIndex()
+{
+    if (!_indexDirty) {
+        return;
+    }
+    _indexDirty = false;
+
+    const int n = _elements.size();
+    QVector<T> order;
+    order.reserve(n);
+    for (int i = n - 1; i >= 0; i--) {
+        order << _elements[i]; // recently added first among the equal positions
+    }
+    std::stable_sort(order.begin(), order.end(), [](T a, T b) { return a->xPos() < b->xPos(); });
+
+    _sorted = order;
+    _x.resize(n);
+    _y.resize(n);
+    _w.resize(n);
+    _h.resize(n);
+    _context.resize(n);
+    _voice.resize(n);
+    _playable.resize(n);
+    _unlimited.clear();
+    _maxWidth = 0;
+
+    for (int i = 0; i < n; i++) {
+        T elt = _sorted[i];
+        bool playable;
+        _x[i] = elt->xPos();
+        _y[i] = elt->yPos();
+        _w[i] = elt->width();
+        _h[i] = elt->height();
+        _context[i] = kdTreeContextOf(elt);
+        _voice[i] = kdTreeVoiceOf(elt, playable);
+        _playable[i] = playable;
+
+        if (!_w[i]) {
+            _unlimited << i;
+        } else if (_w[i] > _maxWidth) {
+            _maxWidth = _w[i];
+        }
+    }
 }
 
 /*!
@@ -124,17 +243,33 @@ void CAKDTree<T>::clear(bool autoDelete)
 template <typename T>
 QList<T> CAKDTree<T>::findInRange(double x, double y, double w, double h)
 {
+    updateIndex();
+
     QList<T> l;
+    const double xMax = x + w;
+    const double yMax = y + h;
+
+    // Elements starting left of x - _maxWidth can't reach the area
+    const int first = std::lower_bound(_x.constBegin(), _x.constEnd(), x - _maxWidth) - _x.constBegin();
+    const int last = std::lower_bound(_x.constBegin(), _x.constEnd(), xMax) - _x.constBegin();
+    const double* xs = _x.constData();
+    const double* ys = _y.constData();
+    const double* ws = _w.constData();
+    const double* hs = _h.constData();
+
+    for (int i = first; i < last; i++) {
+        // The object ends right of x, fits into the area vertically or is unlimited in height (eg. helper lines)
+        const bool hit = (ws[i] != 0) & (xs[i] + ws[i] > x) & (((ys[i] <= yMax) & (ys[i] + hs[i] >= y)) | (hs[i] == 0));
+        if (hit) {
+            l << _sorted[i];
+        }
+    }
 
-    T rightMostElt = _mapX.lowerBound(x + w).value();
-    for (typename QMultiMap<double, T>::const_iterator it = _mapXW.upperBound(x); (it != _mapXW.end()) && (it.value() != rightMostElt); it++) {
-        if (( // The object is normal and fits into the area
-                (it.value()->yPos() <= y + h) && (it.value()->yPos() + it.value()->height() >= y))
-            || ( // The object is unlimited in width (eg. contexts)
-                   (it.value()->width() == 0) && (it.value()->yPos() <= y + h) && (it.value()->yPos() + it.value()->height() >= y))
-            || ( // The object is unlimited in height (eg. helper lines)
-                   (it.value()->height() == 0))) {
-            l << it.value();
+    // The objects unlimited in width (eg. contexts)
+    for (int j = 0; j < _unlimited.size(); j++) {
+        const int i = _unlimited[j];
+        if (xs[i] < xMax && (((ys[i] <= yMax) && (ys[i] + hs[i] >= y)) || (hs[i] == 0))) {
+            l << _sorted[i];
         }
     }
 
@@ -152,6 +287,24 @@ QList<T> CAKDTree<T>::findInRange(QRect& rect)
     return findInRange(rect.x(), rect.y(), rect.width(), rect.height());
 }
 
+/*!
+	Returns True, if the element at the index \a i of the lookup arrays belongs to the given
+	\a context and \a voice. Null context or voice matches any element.
+*/
+template <typename T>
+bool CAKDTree<T>::matches(int i, CADrawableContext* context, CAVoice* voice)
+{
+    return
+        // compare contexts
+        (!context || _context[i] == context) &&
+        // compare voices
+        (!voice || (
+                       // if the element isn't playable, see if it has the same context as the voice
+                       (!_playable[i] && _voice[i] == voice->staff()) ||
+                       // if the element is playable, see if it has the exactly same voice
+                       (_playable[i] && _voice[i] == voice)));
+}
+
 /*!
 	Finds the nearest left element to the given coordinate and returns a pointer to it or 0 if none
 	found. Left elements borders are taken into account.
@@ -163,33 +316,13 @@ QList<T> CAKDTree<T>::findInRange(QRect& rect)
 template <typename T>
 T CAKDTree<T>::findNearestLeft(double x, bool timeBased, CADrawableContext* context, CAVoice* voice)
 {
-    if (_mapX.size() == 0) {
-        return 0;
-    }
-
-    typename QMultiMap<double, T>::const_iterator it = _mapX.lowerBound(x); // returns constEnd, if not found
-    while (it != _mapX.constBegin() && (it == _mapX.constEnd() || it.value()->xPos() >= x)) {
-        it--;
-    }
+    updateIndex();
 
-    if (it.value()->xPos() >= x) {
-        // no elements to the left at all
-        return 0;
-    }
-
-    do {
-        if (
-            // compare contexts
-            (!context || it.value()->drawableContext() == context) &&
-            // compare voices
-            (!voice || (
-                           // if the element isn't playable, see if it has the same context as the voice
-                           (!it.value()->musElement()->isPlayable() && it.value()->musElement()->context() == voice->staff()) ||
-                           // if the element is playable, see if it has the exactly same voice
-                           (it.value()->musElement()->isPlayable() && static_cast<CAPlayable*>(it.value()->musElement())->voice() == voice)))) {
-            return static_cast<T>(it.value());
+    for (int i = int(std::lower_bound(_x.constBegin(), _x.constEnd(), x) - _x.constBegin()) - 1; i >= 0; i--) {
+        if (matches(i, context, voice)) {
+            return _sorted[i];
         }
-    } while ((it--) != _mapX.constBegin());
+    }
 
     // no regular elements to the left exists
     return 0;
@@ -206,19 +339,11 @@ T CAKDTree<T>::findNearestLeft(double x, bool timeBased, CADrawableContext* cont
 template <typename T>
 T CAKDTree<T>::findNearestRight(double x, bool timeBased, CADrawableContext* context, CAVoice* voice)
 {
-    typename QMultiMap<double, T>::const_iterator it = _mapX.upperBound(x);
-
-    for (; it != _mapX.constEnd(); it++) {
-        if (
-            // compare contexts
-            (!context || it.value()->drawableContext() == context) &&
-            // compare voices
-            (!voice || (
-                           // if the element isn't playable, see if it has the same context as the voice
-                           (!it.value()->musElement()->isPlayable() && it.value()->musElement()->context() == voice->staff()) ||
-                           // if the element is playable, see if it has the exactly same voice
-                           (it.value()->musElement()->isPlayable() && static_cast<CAPlayable*>(it.value()->musElement())->voice() == voice)))) {
-            return static_cast<T>(it.value());
+    updateIndex();
+
+    for (int i = std::upper_bound(_x.constBegin(), _x.constEnd(), x) - _x.constBegin(); i < _x.size(); i++) {
+        if (matches(i, context, voice)) {
+            return _sorted[i];
         }
     }
 
@@ -237,17 +362,19 @@ T CAKDTree<T>::findNearestRight(double x, bool timeBased, CADrawableContext* con
 template <typename T>
 T CAKDTree<T>::findNearestUp(double y)
 {
-    if (_mapX.isEmpty())
-        return 0;
-
-    T elt = 0;
-    for (typename QMultiMap<double, T>::const_iterator it = _mapX.constBegin(); it != _mapX.constEnd(); it++) {
-        if (((!elt) || ((it.value()->yPos() + it.value()->height()) > (elt->yPos() + elt->height())))
-            && ((it.value()->yPos() + it.value()->height()) < y)) {
-            elt = it.value();
+    updateIndex();
+
+    int nearest = -1;
+    double nearestBottom = 0;
+    for (int i = 0; i < _y.size(); i++) {
+        const double bottom = _y[i] + _h[i];
+        if ((nearest == -1 || bottom > nearestBottom) && bottom < y) {
+            nearest = i;
+            nearestBottom = bottom;
         }
     }
-    return elt;
+
+    return (nearest == -1 ? 0 : _sorted[nearest]);
 }
 
 /*!
@@ -261,37 +388,27 @@ T CAKDTree<T>::findNearestUp(double y)
 template <typename T>
 T CAKDTree<T>::findNearestDown(double y)
 {
-    if (_mapX.isEmpty())
-        return 0;
+    updateIndex();
 
-    T elt = 0;
-    for (typename QMultiMap<double, T>::const_iterator it = _mapX.constBegin(); it != _mapX.constEnd(); it++) {
-        if (((!elt) || (it.value()->yPos() < elt->yPos())) && (it.value()->yPos() > y)) {
-            elt = it.value();
+    int nearest = -1;
+    for (int i = 0; i < _y.size(); i++) {
+        if ((nearest == -1 || _y[i] < _y[nearest]) && _y[i] > y) {
+            nearest = i;
         }
     }
 
-    return elt;
+    return (nearest == -1 ? 0 : _sorted[nearest]);
 }
 
 /*!
 	Returns the max X coordinate of the end of the most-right element.
+	Contexts with unlimited width are not taken into account.
 	This value is read from buffer, so the calculation time is constant.
 */
 template <typename T>
 double CAKDTree<T>::getMaxX()
 {
-    if (_mapXW.constEnd() == _mapXW.constBegin())
-        return 0.0;
-    for (typename QMultiMap<double, T>::const_iterator it = (--_mapXW.constEnd());
-         it != _mapXW.constBegin();
-         it--) {
-        if (it.key() != std::numeric_limits<double>::max()) {
-            // don't take contexts unlimited length into account
-            return it.key();
-        }
-    }
-    return 0;
+    return _maxX;
 }
 
 /*!
@@ -304,22 +421,6 @@ double CAKDTree<T>::getMaxY()
     return _maxY;
 }
 
-/*!
-	Used internally for the maxX and maxY properties to update.
-	Calculates the largest X and Y coordinates among all ends of elements and store it locally.
-	This operation takes O(n) time complexity where n is number of elements in the tree.
-*/
-template <typename T>
-void CAKDTree<T>::calculateMaxY()
-{
-    _maxY = 0;
-    for (typename QMultiMap<double, T>::iterator it = _mapX.begin(); it != _mapX.end(); it++) {
-        if (it.value()->yPos() + it.value()->height() > _maxY) {
-            _maxY = it.value()->yPos() + it.value()->height();
-        }
-    }
-}
-
 #endif
 
 /*!
@@ -332,8 +433,3 @@ void CAKDTree<T>::calculateMaxY()
 	Returns the element with index \a i in the tree.
 	If the element doesn't exist (eg. index out of bounds), returns 0.
 */
-
-/*!
-	\fn QList<T>& CAKDTree<T>:list()
-	Returns the pointer to the list of all the elements.
-*/
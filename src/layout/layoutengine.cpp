@@ -85,6 +85,7 @@ void CALayoutEngine::reposit(CAScoreView* v)
 {
     //int i;
     CASheet* sheet = v->sheet();
+    v->timeAxis()->clear();
 
     //list of all the music element lists (ie. streams) taken from all the contexts
     QList<QList<CAMusElement*>> musStreamList; // streams music elements
@@ -446,6 +447,9 @@ void CALayoutEngine::reposit(CAScoreView* v)
         for (unsigned int i = 0; i < streams; i++)
             streamsX[i] = maxX;
 
+        // Remember the column of the noteheads for time <-> X coordinate conversions
+        v->timeAxis()->addAnchor(timeStart, maxX);
+
         // Align support elements (accidentals, function key names) to the right
         for (int i = 0; i < lastDFMKeyNames.size(); i++)
             lastDFMKeyNames[i]->setXPos(maxX - lastDFMKeyNames[i]->neededWidth() - 2);
@@ -464,6 +468,13 @@ void CALayoutEngine::reposit(CAScoreView* v)
 
                 switch (elt->musElementType()) {
                 case CAMusElement::Note: {
+                    if (!materialise(elt, streamsX[i], v, lastAccidentals)) {
+                        // only the column width is needed, see CAScoreView::setVirtualLayout()
+                        if (static_cast<CANote*>(elt)->isLastInChord())
+                            streamsX[i] += (CADrawableNote::widthForLength(static_cast<CANote*>(elt)->playableLength()) + MINIMUM_SPACE);
+                        break;
+                    }
+
                     newElt = new CADrawableNote(
                         static_cast<CANote*>(elt),
                         drawableContext,
@@ -617,10 +628,17 @@ void CALayoutEngine::reposit(CAScoreView* v)
                         streamsX[i] += (newElt->neededWidth() + MINIMUM_SPACE);
 
                     placeMarks(newElt, v, static_cast<int>(i));
-
                     break;
                 }
                 case CAMusElement::Rest: {
+                    if (!materialise(elt, streamsX[i], v, lastAccidentals)) {
+                        // only the column width is needed, see CAScoreView::setVirtualLayout()
+                        if (drawableContext->drawableContextType() == CADrawableContext::DrawableStaff)
+                            streamsX[i] += CADrawableRest::widthForLength(static_cast<CARest*>(elt)->playableLength());
+                        streamsX[i] += MINIMUM_SPACE;
+                        break;
+                    }
+
                     newElt = new CADrawableRest(
                         static_cast<CARest*>(elt),
                         drawableContext,
@@ -657,7 +675,6 @@ void CALayoutEngine::reposit(CAScoreView* v)
                     }
 
                     placeMarks(newElt, v, static_cast<int>(i));
-
                     break;
                 }
                 case CAMusElement::MidiNote: {
@@ -675,6 +692,18 @@ void CALayoutEngine::reposit(CAScoreView* v)
                     break;
                 }
                 case CAMusElement::Syllable: {
+                    CAMusElement* prevSyllable = drawableContext->context()->previous(elt);
+                    CADrawableMusElement* prevDSyllable = (prevSyllable ? v->findMElement(prevSyllable) : nullptr);
+                    if (prevDSyllable) {
+                        prevDSyllable->setWidth(streamsX[i] - prevDSyllable->xPos());
+                    }
+
+                    if (!materialise(elt, streamsX[i], v, lastAccidentals)) {
+                        // only the column width is needed, see CAScoreView::setVirtualLayout()
+                        streamsX[i] += (CADrawableSyllable::widthForText(static_cast<CASyllable*>(elt)->text()) + MINIMUM_SPACE);
+                        break;
+                    }
+
                     /// \todo replace raw pointer with shared or unique pointer
                     newElt = new CADrawableSyllable(
                         static_cast<CASyllable*>(elt),
@@ -682,14 +711,8 @@ void CALayoutEngine::reposit(CAScoreView* v)
                         streamsX[i],
                         drawableContext->yPos() + qRound(CADrawableLyricsContext::DEFAULT_TEXT_VERTICAL_SPACING));
 
-                    CAMusElement* prevSyllable = drawableContext->context()->previous(elt);
-                    CADrawableMusElement* prevDSyllable = (prevSyllable ? v->findMElement(prevSyllable) : nullptr);
-                    if (prevDSyllable) {
-                        prevDSyllable->setWidth(newElt->xPos() - prevDSyllable->xPos());
-                    }
-
-                    v->addMElement(newElt);
                     streamsX[i] += (newElt->neededWidth() + MINIMUM_SPACE);
+                    v->addMElement(newElt);
                     break;
                 }
                 case CAMusElement::FiguredBassMark: {
@@ -983,6 +1006,17 @@ void CALayoutEngine::reposit(CAScoreView* v)
         }
     }
 
+    // close the time axis at the end of the longest stream
+    int sheetTimeEnd = 0;
+    int sheetEndX = 0;
+    for (unsigned int i = 0; i < streams; i++) {
+        if (musStreamList[static_cast<int>(i)].size()) {
+            sheetTimeEnd = qMax(sheetTimeEnd, musStreamList[static_cast<int>(i)].last()->timeEnd());
+        }
+        sheetEndX = qMax(sheetEndX, streamsX[i]);
+    }
+    v->timeAxis()->addAnchor(sheetTimeEnd, sheetEndX);
+
     // reposit the scalable elements (eg. crescendo)
     for (int i = 0; i < scalableElts.size(); i++) {
         scalableElts[i]->setXPos(v->timeToCoords(scalableElts[i]->musElement()->timeStart()));
@@ -1054,6 +1088,47 @@ void CALayoutEngine::placeMarks(CADrawableMusElement* e, CAScoreView* v, int str
     }
 }
 
+/*!
+	Returns True, if the drawable of the music element \a musElt placed at \a x should be
+	created in the score view \a v.
+
+	In virtual layout, the drawables of notes, rests and syllables outside the materialised
+	area of the view are not created at all. Their columns are advanced by the widths
+	computed from the music element alone (eg. CADrawableNote::widthForLength()). They
+	are created, if other drawables refer to them (ties, slurs, tuplets, marks, note
+	checker errors) or if they have an accidental in \a accidentals, because
+	CADrawableStaff::getAccs() looks for the last altered note in the bar.
+
+	\sa CAScoreView::setVirtualLayout()
+*/
+bool CALayoutEngine::materialise(CAMusElement* musElt, double x, CAScoreView* v, const QList<CADrawableAccidental*>& accidentals)
+{
+    if (v->isMaterialised(x, musElt) || !musElt->markList().isEmpty() || !musElt->noteCheckerErrorList().isEmpty()) {
+        return true;
+    }
+
+    switch (musElt->musElementType()) {
+    case CAMusElement::Note: {
+        CANote* note = static_cast<CANote*>(musElt);
+        if (note->tieStart() || note->tieEnd() || note->slurStart() || note->slurEnd() || note->phrasingSlurStart() || note->phrasingSlurEnd() || note->tuplet()) {
+            return true;
+        }
+
+        for (int i = 0; i < accidentals.size(); i++) {
+            if (accidentals[i]->musElement() == note) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+    case CAMusElement::Rest:
+        return static_cast<CARest*>(musElt)->tuplet();
+    default:
+        return false;
+    }
+}
+
 void CALayoutEngine::placeNoteCheckerErrors(CADrawableMusElement* dMusElt, CAScoreView* v)
 {
     QList<CANoteCheckerError*> ncErrors = dMusElt->musElement()->noteCheckerErrorList();
@@ -11,15 +11,18 @@
 #include <QList>
 
 class CAScoreView;
+class CAMusElement;
 class CADrawableMusElement;
+class CADrawableAccidental;
 
 class CALayoutEngine {
 public:
     static void reposit(CAScoreView* v);
+    static void placeNoteCheckerErrors(CADrawableMusElement*, CAScoreView*);
 
 private:
     static void placeMarks(CADrawableMusElement*, CAScoreView*, int);
-    static void placeNoteCheckerErrors(CADrawableMusElement*, CAScoreView*);
+    static bool materialise(CAMusElement*, double, CAScoreView*, const QList<CADrawableAccidental*>&);
     static int* streamsRehersalMarks;
     static QList<CADrawableMusElement*> scalableElts;
 };
@@ -0,0 +1,447 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QSvgGenerator>
+#include <limits>
+
+#include "layout/drawablebarline.h"
+#include "layout/drawablecontext.h"
+#include "layout/drawablemuselement.h"
+#include "layout/drawableslur.h"
+#include "layout/drawablestaff.h"
+#include "layout/pagelayout.h"
+#include "score/rest.h"
+#include "widgets/scoreview.h"
+
+/*!
+	\class CAPageLayout
+	\brief Breaks the laid out sheet into systems and pages
+
+	CALayoutEngine places the whole sheet into a single, infinitely wide system. This
+	class cuts that system into lines at the barlines and stacks the lines on pages, so
+	the sheet can be previewed, printed and exported to PDF (exportPdf()) or SVG
+	(exportSvg()) without running an external typesetter.
+
+	The lines are broken in the Knuth-Plass way: every measure is a box of its laid out
+	width and the breaks minimise the sum of the demerits of all the lines, instead of
+	greedily filling each line. The cost of the optimal breaking up to each measure is
+	kept, so calling layout() again after an edit only recomputes the lines ending after
+	the first measure which changed its width.
+
+	Each line, except the last one, is stretched to the full page width. Lines after the
+	first one start with the current clefs and key signatures. Slurs and ties crossing a
+	line break are split into a part on each line.
+
+	The score view passed to layout() provides the drawable elements and needs to exist
+	until the pages are rendered. It should not use the virtual layout.
+
+	\code
+	  CAScoreView view(sheet);
+	  view.rebuild();
+	  CAPageLayout pageLayout;
+	  pageLayout.layout(&view);
+	  pageLayout.exportPdf("preview.pdf");
+	\endcode
+
+	\sa CALayoutEngine, CAPreviewCtl
+*/
+
+const double CAPageLayout::DEFAULT_PAGE_WIDTH = 1100;
+const double CAPageLayout::DEFAULT_MARGIN = 60;
+const double CAPageLayout::DEFAULT_SYSTEM_SPACING = 40;
+const int CAPageLayout::PDF_RESOLUTION = 300;
+
+static const double PREFIX_SPACING = 5; // space around the repeated clefs and key signatures
+static const double LINE_PENALTY = 10; // added to the badness of every line, favours fewer lines
+static const double OVERFULL_DEMERITS = 1e10; // single measure wider than the line
+
+CAPageLayout::CAPageLayout()
+    : _view(nullptr)
+    , _pageSize(QPageSize::A4)
+    , _pageWidth(DEFAULT_PAGE_WIDTH)
+    , _margin(DEFAULT_MARGIN)
+    , _systemSpacing(DEFAULT_SYSTEM_SPACING)
+    , _lineWidth(0)
+    , _prefixWidth(0)
+    , _reusedMeasures(0)
+    , _yTop(0)
+    , _yBottom(0)
+    , _systemsPerPage(1)
+{
+}
+
+/*!
+	Sets the paper size used by exportPdf() and the page proportions.
+	Call layout() afterwards.
+*/
+void CAPageLayout::setPageSize(const QPageSize& size)
+{
+    _pageSize = size;
+}
+
+/*!
+	Breaks the sheet laid out in the view \a v into systems and pages.
+
+	The line breaks of the measures before the first measure which changed its width
+	since the last call are reused, see reusedMeasures().
+*/
+void CAPageLayout::layout(CAScoreView* v)
+{
+    _view = v;
+
+    QVector<double> oldMeasureX = _measureX;
+    double oldPrefixWidth = _prefixWidth;
+    double oldLineWidth = _lineWidth;
+    updateMeasures();
+    _lineWidth = pageWidth() - 2 * _margin;
+
+    int firstChanged = 0;
+    if (qAbs(_lineWidth - oldLineWidth) < 0.01 && qAbs(_prefixWidth - oldPrefixWidth) < 0.01) {
+        int n = qMin(oldMeasureX.size(), _measureX.size()) - 1;
+        while (firstChanged < n && qAbs((oldMeasureX[firstChanged + 1] - oldMeasureX[firstChanged]) - (_measureX[firstChanged + 1] - _measureX[firstChanged])) < 0.01) {
+            firstChanged++;
+        }
+    }
+    breakLines(firstChanged, qMax(oldMeasureX.size() - 1, 0));
+
+    double height = _yBottom - _yTop;
+    _systemsPerPage = qMax(static_cast<int>((pageHeight() - 2 * _margin + _systemSpacing) / (height + _systemSpacing)), 1);
+}
+
+/*!
+	Reads the measure boundaries and the vertical extent of the drawable elements.
+	Measures end after the barlines of the staff with most barlines. Dotted barlines
+	are not used for breaking.
+*/
+void CAPageLayout::updateMeasures()
+{
+    _measureX.clear();
+    _prefixWidth = 0;
+    _yTop = _yBottom = 0;
+    if (!_view) {
+        return;
+    }
+
+    const QList<CADrawableContext*> contexts = _view->drawableCList().list();
+    const QList<CADrawableMusElement*> elts = _view->drawableMList().list();
+
+    _yTop = std::numeric_limits<double>::max();
+    _yBottom = -std::numeric_limits<double>::max();
+    for (CADrawableContext* c : contexts) {
+        _yTop = qMin(_yTop, c->yPos());
+        _yBottom = qMax(_yBottom, c->yPos() + c->height());
+    }
+
+    double maxX = 0;
+    QHash<CADrawableContext*, double> clefWidth, keySigWidth;
+    for (CADrawableMusElement* e : elts) {
+        _yTop = qMin(_yTop, e->yPos());
+        _yBottom = qMax(_yBottom, e->yPos() + e->height());
+        maxX = qMax(maxX, e->xPos() + e->width());
+
+        if (e->musElement() && e->musElement()->musElementType() == CAMusElement::Clef) {
+            clefWidth[e->drawableContext()] = qMax(clefWidth.value(e->drawableContext()), e->width());
+        } else if (e->musElement() && e->musElement()->musElementType() == CAMusElement::KeySignature) {
+            keySigWidth[e->drawableContext()] = qMax(keySigWidth.value(e->drawableContext()), e->width());
+        }
+    }
+    if (_yTop > _yBottom) {
+        _yTop = _yBottom = 0;
+    }
+
+    for (CADrawableContext* c : contexts) {
+        if (c->drawableContextType() == CADrawableContext::DrawableStaff) {
+            _prefixWidth = qMax(_prefixWidth, clefWidth.value(c) + keySigWidth.value(c) + 3 * PREFIX_SPACING);
+        }
+    }
+
+    _measureX << 0;
+    QMap<int, CADrawableBarline*> barlines = _view->computeBarlinePositions(false);
+    for (CADrawableBarline* b : barlines) {
+        if (b->xPos() + b->width() > _measureX.last()) {
+            _measureX << b->xPos() + b->width();
+        }
+    }
+    if (maxX > _measureX.last() + 1) {
+        _measureX << maxX;
+    }
+    if (_measureX.size() < 2) {
+        _measureX.clear();
+    }
+}
+
+/*!
+	Returns the demerits of a line made of the measures from \a i to \a j, excluding \a j.
+*/
+double CAPageLayout::demerits(int i, int j)
+{
+    double natural = _measureX[j] - _measureX[i];
+    double available = _lineWidth - (i ? _prefixWidth : 0);
+    if (natural > available) {
+        return OVERFULL_DEMERITS;
+    }
+    if (j == measureCount()) {
+        return 0; // the last line is not stretched
+    }
+
+    double ratio = (available - natural) / natural;
+    double badness = 100 * ratio * ratio * ratio;
+    return (LINE_PENALTY + badness) * (LINE_PENALTY + badness);
+}
+
+/*!
+	Finds the optimal line breaks and creates the systems.
+
+	The costs of the lines ending at or before the measure \a firstChanged don't depend
+	on the changed measures and are reused. The cost of the last line is computed
+	differently, so it is recomputed when the number of measures changed from
+	\a oldMeasureCount.
+*/
+void CAPageLayout::breakLines(int firstChanged, int oldMeasureCount)
+{
+    int n = measureCount();
+    int start = (n == oldMeasureCount) ? firstChanged + 1 : qMax(firstChanged, 1);
+    _reusedMeasures = start - 1;
+
+    _cost.resize(n + 1);
+    _lineStart.resize(n + 1);
+    _cost[0] = 0;
+    for (int j = start; j <= n; j++) {
+        _cost[j] = std::numeric_limits<double>::max();
+        for (int i = j - 1; i >= 0; i--) {
+            if (j - i > 1 && systemWidth(i, j) > _lineWidth) {
+                break; // lines only get wider
+            }
+            double cost = _cost[i] + demerits(i, j);
+            if (cost < _cost[j]) {
+                _cost[j] = cost;
+                _lineStart[j] = i;
+            }
+        }
+    }
+
+    _systems.clear();
+    for (int j = n; j > 0; j = _lineStart[j]) {
+        CASystem system;
+        system.firstMeasure = _lineStart[j];
+        system.endMeasure = j;
+        system.prefixWidth = system.firstMeasure ? _prefixWidth : 0;
+
+        double natural = _measureX[j] - _measureX[system.firstMeasure];
+        double available = _lineWidth - system.prefixWidth;
+        system.stretch = (j == n && natural <= available) ? 1 : available / natural;
+        _systems.prepend(system);
+    }
+}
+
+/*!
+	Draws the current clefs and key signatures at the beginning of the \a system.
+*/
+void CAPageLayout::drawPrefix(QPainter* p, const CASystem& system, double zoom)
+{
+    double x0 = _measureX[system.firstMeasure];
+    for (CADrawableContext* c : _view->drawableCList().list()) {
+        if (c->drawableContextType() != CADrawableContext::DrawableStaff) {
+            continue;
+        }
+
+        CADrawableStaff* staff = static_cast<CADrawableStaff*>(c);
+        double x = PREFIX_SPACING;
+        QList<CADrawableMusElement*> signs;
+        signs << _view->findMElement(staff->getClef(x0)) << _view->findMElement(staff->getKeySignature(x0));
+        for (CADrawableMusElement* sign : signs) {
+            if (!sign) {
+                continue;
+            }
+            CADrawSettings s = {
+                zoom,
+                qRound(x * zoom),
+                qRound((sign->yPos() - _yTop) * zoom),
+                qRound(_lineWidth * zoom), qRound((_yBottom - _yTop) * zoom),
+                Qt::black,
+                0,
+                0
+            };
+            sign->draw(p, s);
+            x += sign->width() + PREFIX_SPACING;
+        }
+    }
+}
+
+/*!
+	Draws the part of the \a slur or tie within the \a system. The part is redrawn as a
+	slur of its own, so a slur crossing a line break ends at the end of the line and
+	continues after the clefs of the next line, instead of being clipped.
+*/
+void CAPageLayout::drawSlur(QPainter* p, CADrawableSlur* slur, const CASystem& system, double zoom)
+{
+    double xStart = _measureX[system.firstMeasure];
+    double xEnd = _measureX[system.endMeasure];
+    if (slur->x2() <= xStart || slur->x1() >= xEnd) {
+        return; // drawn by another system
+    }
+    if (!slur->slur()->isVisible()) {
+        return;
+    }
+
+    bool startsHere = (slur->x1() >= xStart);
+    bool endsHere = (slur->x2() <= xEnd);
+    double x1 = startsHere ? system.prefixWidth + (slur->x1() - xStart) * system.stretch : system.prefixWidth;
+    double x2 = endsHere ? system.prefixWidth + (slur->x2() - xStart) * system.stretch : system.prefixWidth + (xEnd - xStart) * system.stretch;
+    double y1 = startsHere ? slur->y1() : slur->y2();
+    double y2 = endsHere ? slur->y2() : slur->y1();
+
+    CADrawableSlur part(slur->slur(), slur->drawableContext(), x1, y1, (x1 + x2) / 2, slur->yMid(), x2, y2);
+    CADrawSettings s = {
+        zoom,
+        qRound(part.xPos() * zoom),
+        qRound((part.yPos() - _yTop) * zoom),
+        qRound(_lineWidth * zoom), qRound((_yBottom - _yTop) * zoom),
+        slur->slur()->color().isValid() ? slur->slur()->color() : QColor(Qt::black),
+        0,
+        0
+    };
+    part.draw(p, s);
+}
+
+/*!
+	Draws the \a page using the painter \a p at the given \a zoom level, that is the
+	number of device pixels per world unit.
+*/
+void CAPageLayout::renderPage(QPainter* p, int page, double zoom)
+{
+    if (!_view) {
+        return;
+    }
+
+    double height = _yBottom - _yTop;
+    const QList<CADrawableContext*> contexts = _view->drawableCList().list();
+    for (int i = page * _systemsPerPage; i < qMin((page + 1) * _systemsPerPage, _systems.size()); i++) {
+        const CASystem& system = _systems[i];
+        double top = _margin + (i - page * _systemsPerPage) * (height + _systemSpacing);
+        double xStart = _measureX[system.firstMeasure];
+        double xEnd = _measureX[system.endMeasure];
+        double width = system.prefixWidth + (xEnd - xStart) * system.stretch;
+
+        p->save();
+        p->translate(_margin * zoom, top * zoom);
+        p->setClipRect(QRectF(0, -_systemSpacing / 2 * zoom, _lineWidth * zoom, (height + _systemSpacing) * zoom));
+
+        for (CADrawableContext* c : contexts) {
+            CADrawSettings s = {
+                zoom,
+                0,
+                qRound((c->yPos() - _yTop) * zoom),
+                qRound(width * zoom), qRound(height * zoom),
+                Qt::black,
+                0,
+                0
+            };
+            c->draw(p, s);
+        }
+
+        if (system.firstMeasure) {
+            drawPrefix(p, system, zoom);
+        }
+
+        for (CADrawableMusElement* e : _view->drawableMList().findInRange(xStart, _yTop, xEnd - xStart, height)) {
+            CAMusElement* elt = e->musElement();
+            if (e->drawableMusElementType() == CADrawableMusElement::DrawableSlur) {
+                drawSlur(p, static_cast<CADrawableSlur*>(e), system, zoom);
+                continue;
+            }
+            if (e->xPos() < xStart || e->xPos() >= xEnd) {
+                continue; // belongs to the neighbouring system
+            }
+            if (elt && ((elt->musElementType() == CAMusElement::Rest && static_cast<CARest*>(elt)->restType() == CARest::Hidden) || !elt->isVisible())) {
+                continue;
+            }
+
+            double x = system.prefixWidth + (e->xPos() - xStart) * system.stretch;
+            CADrawSettings s = {
+                zoom,
+                qRound(x * zoom),
+                qRound((e->yPos() - _yTop) * zoom),
+                qRound(width * zoom), qRound(height * zoom),
+                (elt && elt->color().isValid()) ? elt->color() : QColor(Qt::black),
+                0,
+                0
+            };
+            if (e->isHScalable()) {
+                // elements spanning over other elements are stretched together with the measures
+                p->save();
+                p->translate(s.x, 0);
+                p->scale(system.stretch, 1);
+                s.x = 0;
+                e->draw(p, s);
+                p->restore();
+            } else {
+                e->draw(p, s);
+            }
+        }
+
+        p->restore();
+    }
+}
+
+/*!
+	Writes all the pages to the PDF file \a fileName.
+
+	Returns True, if the file was written; otherwise False.
+*/
+bool CAPageLayout::exportPdf(const QString& fileName)
+{
+    QPdfWriter writer(fileName);
+    writer.setPageSize(_pageSize);
+    writer.setPageMargins(QMarginsF(0, 0, 0, 0));
+    writer.setResolution(PDF_RESOLUTION);
+    writer.setCreator("Canorus");
+
+    QPainter p;
+    if (!p.begin(&writer)) {
+        return false;
+    }
+
+    double zoom = writer.width() / pageWidth();
+    for (int page = 0; page < pageCount(); page++) {
+        if (page) {
+            writer.newPage();
+        }
+        renderPage(&p, page, zoom);
+    }
+
+    return p.end();
+}
+
+/*!
+	Writes the \a page to the SVG file \a fileName. One world unit is one pixel.
+
+	Returns True, if the file was written; otherwise False.
+*/
+bool CAPageLayout::exportSvg(const QString& fileName, int page)
+{
+    QSize size(qRound(pageWidth()), qRound(pageHeight()));
+    QSvgGenerator generator;
+    generator.setFileName(fileName);
+    generator.setSize(size);
+    generator.setViewBox(QRect(QPoint(0, 0), size));
+    generator.setTitle(QObject::tr("Page %1").arg(page + 1));
+
+    QPainter p;
+    if (!p.begin(&generator)) {
+        return false;
+    }
+    p.fillRect(QRect(QPoint(0, 0), size), Qt::white);
+    renderPage(&p, page, 1);
+
+    return p.end();
+}
@@ -0,0 +1,83 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#ifndef PAGELAYOUT_H_
+#define PAGELAYOUT_H_
+
+#include <QList>
+#include <QPageSize>
+#include <QSizeF>
+#include <QString>
+#include <QVector>
+
+class QPainter;
+class CADrawableSlur;
+class CAScoreView;
+
+class CAPageLayout {
+public:
+    CAPageLayout();
+
+    void layout(CAScoreView* v);
+    void renderPage(QPainter* p, int page, double zoom);
+    bool exportPdf(const QString& fileName);
+    bool exportSvg(const QString& fileName, int page = 0);
+
+    inline int pageCount() const { return _systems.size() ? (_systems.size() - 1) / _systemsPerPage + 1 : 0; }
+    inline int systemCount() const { return _systems.size(); }
+    inline int measureCount() const { return qMax(_measureX.size() - 1, 0); }
+    inline int reusedMeasures() const { return _reusedMeasures; }
+
+    inline const QPageSize& pageSize() const { return _pageSize; }
+    void setPageSize(const QPageSize& size);
+    inline double pageWidth() const { return _pageWidth; }
+    inline double pageHeight() const { return _pageWidth * _pageSize.size(QPageSize::Point).height() / _pageSize.size(QPageSize::Point).width(); }
+    inline double margin() const { return _margin; }
+    inline void setMargin(double margin) { _margin = margin; }
+    inline double systemSpacing() const { return _systemSpacing; }
+    inline void setSystemSpacing(double spacing) { _systemSpacing = spacing; }
+
+    static const double DEFAULT_PAGE_WIDTH; // in world units, where a staff is 37 units high
+    static const double DEFAULT_MARGIN;
+    static const double DEFAULT_SYSTEM_SPACING;
+    static const int PDF_RESOLUTION;
+
+private:
+    struct CASystem {
+        int firstMeasure;
+        int endMeasure; // first measure of the next system
+        double stretch; // horizontal scale of the measures to fill the line
+        double prefixWidth; // width of the repeated clefs and key signatures
+    };
+
+    void updateMeasures();
+    void breakLines(int firstChanged, int oldMeasureCount);
+    double demerits(int i, int j);
+    double systemWidth(int i, int j) { return _measureX[j] - _measureX[i] + (i ? _prefixWidth : 0); }
+    void drawPrefix(QPainter* p, const CASystem& system, double zoom);
+    void drawSlur(QPainter* p, CADrawableSlur* slur, const CASystem& system, double zoom);
+
+    CAScoreView* _view; // laid out view, needs to exist while rendering
+    QPageSize _pageSize;
+    double _pageWidth;
+    double _margin;
+    double _systemSpacing;
+
+    QVector<double> _measureX; // world X of the measure starts, followed by the end of the last measure
+    QVector<double> _cost; // minimal demerits of the lines ending before the given measure
+    QVector<int> _lineStart; // first measure of the last line in the optimal solution of _cost
+    double _lineWidth; // line width used by _cost
+    double _prefixWidth;
+    int _reusedMeasures; // measures whose line breaks were kept by the last layout()
+
+    double _yTop; // vertical extent of the content in world units
+    double _yBottom;
+    QList<CASystem> _systems;
+    int _systemsPerPage;
+};
+
+#endif /* PAGELAYOUT_H_ */
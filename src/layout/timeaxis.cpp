@@ -0,0 +1,112 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#include <QtGlobal>
+#include <algorithm>
+
+#include "layout/timeaxis.h"
+
+/*!
+	\class CATimeAxis
+	\brief Mapping between the Canorus time and the X coordinates of the laid out sheet
+
+	The layout engine adds an anchor for every column of the sheet it places, the
+	Canorus time of the column and the X coordinate of its noteheads, and closes the
+	axis with the end of the sheet. Times and coordinates in between are linearly
+	interpolated, so both conversions are a binary search over two compact arrays.
+
+	Every score view has its own axis, see CAScoreView::timeAxis(), because views of
+	the same sheet may be laid out differently. It is filled by CALayoutEngine::reposit()
+	and used by the view for the playback cursor and mouse positions.
+
+	\sa CAScoreView::timeToCoords(), CAScoreView::coordsToTime()
+*/
+
+CATimeAxis::CATimeAxis()
+{
+}
+
+/*!
+	Removes all the anchors.
+	Usually called before laying out the sheet again.
+*/
+void CATimeAxis::clear()
+{
+    _times.clear();
+    _xs.clear();
+}
+
+/*!
+	Appends the column at the given Canorus \a time and X coordinate \a x.
+	Anchors should be added in time order. Anchors with time earlier or equal to the
+	last one are ignored, coordinates left of the last one are moved to it, so the axis
+	stays monotone.
+*/
+void CATimeAxis::addAnchor(int time, double x)
+{
+    if (!_times.isEmpty() && time <= _times.last()) {
+        return;
+    }
+
+    _times << time;
+    _xs << (_xs.isEmpty() ? x : qMax(x, _xs.last()));
+}
+
+/*!
+	Returns the X coordinate for the given Canorus \a time.
+	Returns -1, if such a time doesn't exist in the sheet.
+*/
+double CATimeAxis::timeToCoords(int time)
+{
+    if (_times.isEmpty() || time > _times.last()) {
+        return -1;
+    }
+
+    int i = std::upper_bound(_times.constBegin(), _times.constEnd(), time) - _times.constBegin();
+    if (i == 0) {
+        return _xs.first();
+    }
+    if (i == _times.size() || _times[i - 1] == time) {
+        return _xs[i - 1];
+    }
+
+    return _xs[i - 1] + (_xs[i] - _xs[i - 1]) * (time - _times[i - 1]) / static_cast<double>(_times[i] - _times[i - 1]);
+}
+
+/*!
+	Returns the Canorus time for the given X coordinate \a x.
+	Coordinates right of the sheet end return the time of the end.
+
+	Anchors with times in \a skippedTimes are ignored and the time is interpolated
+	between their neighbours. This is used for the columns of the elements being dragged.
+
+	Returns 0, if the axis is empty.
+*/
+int CATimeAxis::coordsToTime(double x, const QSet<int>& skippedTimes)
+{
+    int i = std::upper_bound(_xs.constBegin(), _xs.constEnd(), x) - _xs.constBegin();
+    int left = i - 1;
+    while (left >= 0 && skippedTimes.contains(_times[left])) {
+        left--;
+    }
+    int right = i;
+    while (right < _times.size() && skippedTimes.contains(_times[right])) {
+        right++;
+    }
+
+    if (left < 0 && right == _times.size()) {
+        return 0;
+    }
+    if (left < 0) {
+        return _times[right];
+    }
+    if (right == _times.size()) {
+        return _times[left];
+    }
+
+    return qRound(_times[left] + (_times[right] - _times[left]) * ((x - _xs[left]) / (_xs[right] - _xs[left])));
+}
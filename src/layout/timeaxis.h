@@ -0,0 +1,33 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#ifndef TIMEAXIS_H_
+#define TIMEAXIS_H_
+
+#include <QSet>
+#include <QVector>
+
+class CATimeAxis {
+public:
+    CATimeAxis();
+
+    void clear();
+    void addAnchor(int time, double x);
+
+    inline int anchorCount() { return _times.size(); }
+    inline int anchorTime(int i) { return _times[i]; }
+    inline double anchorX(int i) { return _xs[i]; }
+
+    double timeToCoords(int time);
+    int coordsToTime(double x, const QSet<int>& skippedTimes = QSet<int>());
+
+private:
+    QVector<int> _times; // increasing
+    QVector<double> _xs; // non-decreasing
+};
+
+#endif /* TIMEAXIS_H_ */
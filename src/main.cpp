@@ -9,10 +9,13 @@
 #include <QFile>
 #include <QFont>
 #include <QSplashScreen>
+#include <QTimer>
 
 // Python.h needs to be loaded first!
 #include "canorus.h"
+#include "core/batchconverter.h"
 #include "core/settings.h"
+#include "core/startuptrace.h"
 #include "interface/pluginmanager.h"
 #include "ui/mainwin.h"
 #include "ui/settingsdialog.h"
@@ -41,13 +44,6 @@ void catch_sig(int)
 */
 int main(int argc, char* argv[])
 {
-    QApplication mainApp(argc, argv);
-
-#ifdef Q_WS_X11
-    signal(SIGINT, catch_sig);
-    signal(SIGQUIT, catch_sig);
-#endif
-
 #ifdef Q_OS_WIN
     // Enable console output on Windows
     if (AttachConsole(ATTACH_PARENT_PROCESS)) {
@@ -55,6 +51,34 @@ int main(int argc, char* argv[])
         freopen("CONOUT$", "w", stderr);
     }
 #endif
+
+    // Convert the files passed in command line without starting the GUI
+    if (CABatchConverter::isRequested(argc, argv)) {
+        QCoreApplication convertApp(argc, argv);
+        CACanorus::initMain();
+        CACanorus::initSearchPaths();
+        CACanorus::initSettings();
+
+        CABatchConverter converter;
+        if (!converter.parseArguments(convertApp.arguments())) {
+            CABatchConverter::printUsage();
+            return CABatchConverter::USAGE_ERROR;
+        }
+
+        int ret = converter.convert();
+        CACanorus::cleanUp();
+        return ret;
+    }
+
+    CAStartupTrace::start(argc, argv);
+    QApplication mainApp(argc, argv);
+    CAStartupTrace::phase("application");
+
+#ifdef Q_WS_X11
+    signal(SIGINT, catch_sig);
+    signal(SIGQUIT, catch_sig);
+#endif
+
     CACanorus::initSearchPaths();
 
     QPixmap splashPixmap(400, 300);
@@ -74,37 +98,35 @@ int main(int argc, char* argv[])
         return 0;
 
     splash.show();
+    CAStartupTrace::phase("splash screen");
 
     // Load system translation if found
     CACanorus::initTranslations();
-
-    // Init MIDI devices
-    CACanorus::initPlayback();
+    CAStartupTrace::phase("translations");
 
     // Load config file
     bool firstTime = !QFile::exists(CASettings::defaultSettingsPath() + "/canorus.ini");
     CASettingsDialog::CASettingsPage showSettingsPage = CACanorus::initSettings();
+    CAStartupTrace::phase("settings");
 
-    // Enable scripting and plugins subsystem
-    splash.showMessage(QObject::tr("Initializing Scripting engine", "splashScreen"), Qt::AlignBottom | Qt::AlignLeft, Qt::white);
-    mainApp.processEvents();
-    CACanorus::initScripting();
+    // MIDI devices, scripting and help are initialized on first use.
+    // Only open MIDI now if the MIDI keyboard input is set up.
+    if (CACanorus::settings()->midiInPort() != CASettings::DEFAULT_MIDI_IN_PORT) {
+        CACanorus::initPlayback();
+        CAStartupTrace::phase("MIDI input");
+    }
 
     // Finds all the plugins
     splash.showMessage(QObject::tr("Reading Plugins", "splashScreen"), Qt::AlignBottom | Qt::AlignLeft, Qt::white);
     mainApp.processEvents();
     CAPluginManager::readPlugins();
+    CAStartupTrace::phase("plugins");
 
     // Initialize autosave
     splash.showMessage(QObject::tr("Initializing Automatic recovery", "splashScreen"), Qt::AlignBottom | Qt::AlignLeft, Qt::white);
     mainApp.processEvents();
     CACanorus::initAutoRecovery();
 
-    // Initialize help
-    splash.showMessage(QObject::tr("Initializing Help", "splashScreen"), Qt::AlignBottom | Qt::AlignLeft, Qt::white);
-    mainApp.processEvents();
-    CACanorus::initHelp();
-
     // Initialize undo/redo stacks
     splash.showMessage(QObject::tr("Initializing Undo/Redo framework", "splashScreen"), Qt::AlignBottom | Qt::AlignLeft, Qt::white);
     mainApp.processEvents();
@@ -114,11 +136,13 @@ int main(int argc, char* argv[])
     splash.showMessage(QObject::tr("Loading fonts", "splashScreen"), Qt::AlignBottom | Qt::AlignLeft, Qt::white);
     mainApp.processEvents();
     CACanorus::initFonts();
+    CAStartupTrace::phase("fonts");
 
     // Check for any crashed Canorus sessions and open the recovery files
     splash.showMessage(QObject::tr("Searching for recovery documents", "splashScreen"), Qt::AlignBottom | Qt::AlignLeft, Qt::white);
     mainApp.processEvents();
     CACanorus::autoRecovery()->openRecovery();
+    CAStartupTrace::phase("recovery documents");
 
     // Creates a main window of a document to open if passed in command line
     splash.showMessage(QObject::tr("Initializing Main window", "splashScreen"), Qt::AlignBottom | Qt::AlignLeft, Qt::white);
@@ -150,10 +174,13 @@ int main(int argc, char* argv[])
     }
     splash.close();
 
+    CAStartupTrace::phase("main window");
+
     // Show settings dialog, if needed (eg. MIDI setup when running Canorus for the first time)
     if (showSettingsPage != CASettingsDialog::UndefinedSettings) {
         CASettingsDialog(showSettingsPage, CACanorus::mainWinList()[0]);
     }
 
+    QTimer::singleShot(0, &CAStartupTrace::finish);
     return mainApp.exec();
 }
@@ -0,0 +1,31 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#include "score/chord.h"
+#include "score/note.h"
+
+/*!
+	\class CAChord
+	\brief Notes sharing the same time slot in a voice
+
+	Every note inserted into a voice belongs to exactly one chord. A single note forms a
+	chord of size 1. The notes are kept in the same order as in the voice's music element
+	list, so first() identifies the chord and contains chord-level marks.
+
+	Chords are created and destroyed by CAVoice when inserting or removing notes. Use
+	CANote::chord() to get the chord of a note.
+
+	\sa CAVoice::addNoteToChord(), CANote::getChord()
+*/
+
+/*!
+	Creates a new chord consisting of a single \a note.
+*/
+CAChord::CAChord(CANote* note)
+{
+    _noteList << note;
+}
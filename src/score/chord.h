@@ -0,0 +1,31 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#ifndef CHORD_H_
+#define CHORD_H_
+
+#include <QList>
+
+class CANote;
+
+class CAChord {
+    friend class CAVoice; // maintains the notes when inserting and removing them
+
+public:
+    CAChord(CANote* note);
+
+    inline const QList<CANote*>& noteList() { return _noteList; }
+    inline CANote* first() { return _noteList.first(); }
+    inline CANote* last() { return _noteList.last(); }
+    inline int size() { return _noteList.size(); }
+    inline int indexOf(CANote* note) { return _noteList.indexOf(note); }
+
+private:
+    QList<CANote*> _noteList; // notes in the voice order, usually bottom-up
+};
+
+#endif /* CHORD_H_ */
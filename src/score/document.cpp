@@ -24,12 +24,15 @@
 	\sa CASheet
 */
 
+QAtomicInt CADocument::_lastRevision;
+
 /*!
 	Creates an empty document.
 
 	\sa addSheet()
 */
 CADocument::CADocument()
+    : _revision(_lastRevision.fetchAndAddRelaxed(1) + 1)
 {
     setDateCreated(QDateTime::currentDateTime());
     setDateLastModified(QDateTime::currentDateTime());
@@ -70,6 +73,22 @@ CADocument* CADocument::clone()
     return newDocument;
 }
 
+/*!
+	Marks the document as modified or saved.
+
+	Modifying the document also gives it a new revision(), so others (eg.
+	CAAutoRecovery) can tell whether the document changed since they last
+	looked at it. Revisions are unique among all documents, so a new document
+	never gets the revision of a deleted one.
+*/
+void CADocument::setModified(bool m)
+{
+    _modified = m;
+    if (m) {
+        _revision = _lastRevision.fetchAndAddRelaxed(1) + 1;
+    }
+}
+
 /*!
 	Clears and destroys the document.
 
@@ -8,6 +8,7 @@
 #ifndef DOCUMENT_H_
 #define DOCUMENT_H_
 
+#include <QAtomicInt>
 #include <QDateTime>
 #include <QList>
 #include <QString>
@@ -70,7 +71,8 @@ public:
     CAArchive* archive() { return _archive; }
 
     void setFileName(const QString fileName) { _fileName = fileName; } // not saved!
-    void setModified(bool m) { _modified = m; }
+    void setModified(bool m);
+    inline unsigned int revision() { return _revision; }
     void setArchive(CAArchive* a) { _archive = a; }
 
 private:
@@ -95,6 +97,8 @@ private:
     ////////////////////////////////////////////////////
     QString _fileName; // absolute filename of the document
     bool _modified; // unsaved changes
+    unsigned int _revision; // changed on every modification, unique among documents
+    static QAtomicInt _lastRevision;
     CAArchive* _archive; // pointer to existing archive, if it exists
 };
 #endif /* DOCUMENT_H_ */
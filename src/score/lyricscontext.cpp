@@ -5,6 +5,8 @@
 	Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE.GPL for details.
 */
 
+#include <algorithm>
+
 #include "score/lyricscontext.h"
 #include "score/syllable.h"
 #include "score/voice.h"
@@ -22,6 +24,9 @@
     If the user wants to create multiple stanzas, it should create multiple lyrics contexts - one for each stanza.
     \param _stanzaNumber stores the stanza number. If _stanzaNumber equals 0, no number is printed (default).
 
+	Every syllable knows its index in the context, see CASyllable::slot(), so next() and
+	previous() don't need to search the list.
+
 	\sa _syllableMap, CASyllable
 */
 
@@ -87,7 +92,7 @@ CAMusElement* CALyricsContext::next(CAMusElement* elt)
     if (elt->musElementType() != CAMusElement::Syllable)
         return nullptr;
 
-    int i = _syllableList.indexOf(static_cast<CASyllable*>(elt));
+    int i = syllableIndex(static_cast<CASyllable*>(elt));
     if (i != -1 && ++i < _syllableList.size())
         return _syllableList[i];
     else
@@ -99,7 +104,7 @@ CAMusElement* CALyricsContext::previous(CAMusElement* elt)
     if (elt->musElementType() != CAMusElement::Syllable)
         return nullptr;
 
-    int i = _syllableList.indexOf(static_cast<CASyllable*>(elt));
+    int i = syllableIndex(static_cast<CASyllable*>(elt));
     if (i != -1 && --i > -1)
         return _syllableList[i];
     else
@@ -114,24 +119,27 @@ bool CALyricsContext::remove(CAMusElement* elt)
     if (!elt || elt->musElementType() != CAMusElement::Syllable)
         return false;
 
-    bool success = false;
-    success = _syllableList.removeAll(static_cast<CASyllable*>(elt));
+    int i = syllableIndex(static_cast<CASyllable*>(elt));
+    if (i == -1)
+        return false;
 
-    if (success)
-        delete elt;
+    _syllableList.removeAt(i);
+    updateSlots(i);
+    delete elt;
 
-    return success;
+    return true;
 }
 
 CAMusElement *CALyricsContext::insertEmptyElement(int timeStart)
 {
-    int i;
-    for (i = 0; i < _syllableList.size() && _syllableList[i]->timeStart() < timeStart; i++)
-        ;
+    int i = syllableLowerBound(timeStart);
     CASyllable *newSyl = new CASyllable("", ((i > 0) ? (_syllableList[i - 1]->hyphenStart()) : (false)), ((i > 0) ? (_syllableList[i - 1]->melismaStart()) : (false)), this, timeStart, 1);
     _syllableList.insert(i, newSyl);
-    for (i++; i < _syllableList.size(); i++)
+    newSyl->setSlot(i);
+    for (i++; i < _syllableList.size(); i++) {
         _syllableList[i]->setTimeStart(_syllableList[i]->timeStart() + 1);
+        _syllableList[i]->setSlot(i);
+    }
 
     return newSyl;
 }
@@ -140,21 +148,38 @@ CAMusElement *CALyricsContext::insertEmptyElement(int timeStart)
     Keeps the content and order of the syllables, but changes startTimes and lengths according to the notes in associatedVoice.
     This function is usually called when associatedVoice is changed or the whole lyricsContext is initialized for the first time.
     If the notes and syllables aren't synchronized (too little syllables for notes) it adds empty syllables.
+
+    \sa repositionElements(int)
 */
 void CALyricsContext::repositionElements()
+{
+    repositionElements(0);
+}
+
+/*!
+    Same as repositionElements(), but only updates the syllables from the given \a timeStart on.
+    Call this after a note at \a timeStart was inserted, changed or removed. Syllables before it
+    are expected to be already synchronized with the chords.
+*/
+void CALyricsContext::repositionElements(int timeStart)
 {
     if (associatedVoice()) {
-        QList<CANote*> noteList = associatedVoice()->getNoteList();
+        const QList<CAMusElement*>& musElementList = associatedVoice()->musElementList();
+
+        // chords before timeStart have the same syllables as before the change
+        int i = std::lower_bound(musElementList.constBegin(), musElementList.constEnd(), timeStart,
+                    [](const CAMusElement* elt, int t) { return elt->timeStart() < t; })
+            - musElementList.constBegin();
+        int j = syllableLowerBound(timeStart);
 
         // synchronize syllable times with notes
-        int i, j;
-        for (i = 0, j = 0; i < noteList.size() && j < _syllableList.size(); i++, j++) {
-            if (!noteList[i]->isFirstInChord()) { // skip until the first note in the chord
-                j--;
+        for (; i < musElementList.size() && j < _syllableList.size(); i++) {
+            if (musElementList[i]->musElementType() != CAMusElement::Note || !static_cast<CANote*>(musElementList[i])->isFirstInChord()) { // skip until the first note in the chord
                 continue;
             }
-            _syllableList[j]->setTimeStart(noteList[i]->timeStart());
-            _syllableList[j]->setTimeLength(noteList[i]->timeLength());
+            _syllableList[j]->setTimeStart(musElementList[i]->timeStart());
+            _syllableList[j]->setTimeLength(musElementList[i]->timeLength());
+            j++;
         }
 
         // CASE 1: more syllables than chords
@@ -176,11 +201,11 @@ void CALyricsContext::repositionElements()
         }
 
         // CASE 2: more chords than syllables
-        for (; i < noteList.size(); i++) { // add empty syllables at the end, if missing
-            if (!noteList[i]->isFirstInChord()) { // skip until the first note in the chord
+        for (; i < musElementList.size(); i++) { // add empty syllables at the end, if missing
+            if (musElementList[i]->musElementType() != CAMusElement::Note || !static_cast<CANote*>(musElementList[i])->isFirstInChord()) { // skip until the first note in the chord
                 continue;
             }
-            insertEmptyElement(noteList[i]->timeStart());
+            insertEmptyElement(musElementList[i]->timeStart());
         }
     }
 }
@@ -193,10 +218,8 @@ void CALyricsContext::repositionElements()
 */
 CASyllable* CALyricsContext::removeSyllableAtTimeStart(int timeStart)
 {
-    int i;
-    for (i = 0; i < _syllableList.size() && _syllableList[i]->timeStart() != timeStart; i++)
-        ;
-    if (i < _syllableList.size()) {
+    int i = syllableLowerBound(timeStart);
+    if (i < _syllableList.size() && _syllableList[i]->timeStart() == timeStart) {
         CASyllable* syllable = _syllableList[i];
 
         // update times
@@ -204,6 +227,7 @@ CASyllable* CALyricsContext::removeSyllableAtTimeStart(int timeStart)
             _syllableList[j]->setTimeStart(_syllableList[j]->timeStart() - syllable->timeLength());
 
         delete _syllableList.takeAt(i);
+        updateSlots(i);
         return syllable;
     } else {
         return nullptr;
@@ -220,16 +244,17 @@ CASyllable* CALyricsContext::removeSyllableAtTimeStart(int timeStart)
 */
 bool CALyricsContext::addSyllable(CASyllable* syllable, bool replace)
 {
-    int i;
-    for (i = 0; i < _syllableList.size() && _syllableList[i]->timeStart() < syllable->timeStart(); i++)
-        ;
+    int i = syllableLowerBound(syllable->timeStart());
     //int s = _syllableList.size();
     if (i < _syllableList.size() && replace) {
         delete _syllableList.takeAt(i);
     }
     _syllableList.insert(i, syllable);
-    for (i++; i < _syllableList.size(); i++)
+    syllable->setSlot(i);
+    for (i++; i < _syllableList.size(); i++) {
         _syllableList[i]->setTimeStart(_syllableList[i]->timeStart() + syllable->timeLength());
+        _syllableList[i]->setSlot(i);
+    }
 
     return true;
 }
@@ -240,10 +265,8 @@ bool CALyricsContext::addSyllable(CASyllable* syllable, bool replace)
  */
 CASyllable* CALyricsContext::syllableAtTimeStart(int timeStart)
 {
-    int i;
-    for (i = 0; i < _syllableList.size() && _syllableList[i]->timeStart() != timeStart; i++)
-        ;
-    if (i < _syllableList.size())
+    int i = syllableLowerBound(timeStart);
+    if (i < _syllableList.size() && _syllableList[i]->timeStart() == timeStart)
         return _syllableList[i];
     else
         return nullptr;
@@ -263,3 +286,36 @@ void CALyricsContext::setAssociatedVoice(CAVoice* v)
     _associatedVoice = v;
     repositionElements();
 }
+
+/*!
+	Returns the index of the syllable \a s in this context or -1, if it's not part of it.
+	Uses the slot stored in the syllable.
+ */
+int CALyricsContext::syllableIndex(CASyllable* s)
+{
+    int i = s->slot();
+    if (i >= 0 && i < _syllableList.size() && _syllableList[i] == s)
+        return i;
+
+    return -1;
+}
+
+/*!
+	Returns the index of the first syllable starting at or after the given \a timeStart.
+	Uses binary search.
+ */
+int CALyricsContext::syllableLowerBound(int timeStart)
+{
+    return std::lower_bound(_syllableList.constBegin(), _syllableList.constEnd(), timeStart,
+               [](const CASyllable* s, int t) { return s->timeStart() < t; })
+        - _syllableList.constBegin();
+}
+
+/*!
+	Updates the slots of the syllables starting at index \a from after the list changed.
+ */
+void CALyricsContext::updateSlots(int from)
+{
+    for (int i = from; i < _syllableList.size(); i++)
+        _syllableList[i]->setSlot(i);
+}
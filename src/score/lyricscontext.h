@@ -29,6 +29,7 @@ public:
     bool remove(CAMusElement*);
     CAMusElement *insertEmptyElement(int timeStart);
     void repositionElements();
+    void repositionElements(int timeStart);
     void clear();
 
     inline const QList<CASyllable*>& syllableList() { return _syllableList; }
@@ -45,7 +46,11 @@ public:
     inline void setCustomStanzaName(QString name) { _customStanzaName = name; }
 
 private:
-    QList<CASyllable*> _syllableList;
+    int syllableIndex(CASyllable* s);
+    int syllableLowerBound(int timeStart);
+    void updateSlots(int from);
+
+    QList<CASyllable*> _syllableList; // sorted by time, syllable slot() is its index
     CAVoice* _associatedVoice;
     int _stanzaNumber;
     QString _customStanzaName;
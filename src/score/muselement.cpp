@@ -6,12 +6,15 @@
 */
 
 #include "score/muselement.h"
+#include "core/slotpool.h"
 #include "score/articulation.h"
 #include "score/context.h"
 #include "score/mark.h"
 #include "score/notecheckererror.h"
 #include "score/playable.h"
+#include "score/sheet.h"
 #include "score/staff.h"
+#include "score/tempomap.h"
 
 /*!
 	\class CAMusElement
@@ -39,11 +42,11 @@
 CAMusElement::CAMusElement(CAContext* context, int time, int length)
 {
     _context = context;
+    _extra = nullptr; // no marks, errors, name and invalid color by default
     _timeStart = time;
     _timeLength = length;
     _musElementType = CAMusElement::Undefined;
     _visible = true;
-    _color = QColor(); // invalid color by default
 }
 
 /*!
@@ -52,11 +55,11 @@ CAMusElement::CAMusElement(CAContext* context, int time, int length)
 */
 CAMusElement::~CAMusElement()
 {
-    while (!_markList.isEmpty()) {
-        if (!_markList.first()->isCommon() || musElementType() != CAMusElement::Note) {
-            delete _markList.takeFirst();
+    while (_extra && !_extra->markList.isEmpty()) {
+        if (!_extra->markList.first()->isCommon() || musElementType() != CAMusElement::Note) {
+            delete _extra->markList.takeFirst();
         } else {
-            _markList.takeFirst();
+            _extra->markList.takeFirst();
         }
     }
 
@@ -64,11 +67,99 @@ CAMusElement::~CAMusElement()
     if (context() && !isPlayable())
         context()->remove(this);
 
-    while (_noteCheckerErrorList.size()) {
-        delete _noteCheckerErrorList.front(); // also removes instances from _noteCheckerErrorList and CASheet->noteCheckerErrorList
+    while (_extra && _extra->noteCheckerErrorList.size()) {
+        delete _extra->noteCheckerErrorList.front(); // also removes instances from noteCheckerErrorList and CASheet->noteCheckerErrorList
+    }
+
+    delete _extra;
+}
+
+/*!
+	Returns the pool music elements are allocated from.
+	It is never destroyed, because elements may outlive the static destructors.
+*/
+CASlotPool* CAMusElement::pool()
+{
+    static CASlotPool* pool = new CASlotPool();
+    return pool;
+}
+
+/*!
+	Allocates the music element from the shared element pool.
+
+	\sa CASlotPool
+*/
+void* CAMusElement::operator new(size_t size)
+{
+    return pool()->allocate(size);
+}
+
+/*!
+	Returns the memory of the destroyed music element of the given \a size to the pool.
+*/
+void CAMusElement::operator delete(void* p, size_t size)
+{
+    pool()->release(p, size);
+}
+
+/*!
+	Returns the list of note checker errors assigned to the music element.
+*/
+const QList<CANoteCheckerError*>& CAMusElement::noteCheckerErrorList()
+{
+    static const QList<CANoteCheckerError*> empty;
+    return _extra ? _extra->noteCheckerErrorList : empty;
+}
+
+/*!
+	Returns the tempo map of the sheet the element belongs to or a map with the default
+	tempo, if the element is not part of a sheet.
+*/
+static CATempoMap* tempoMapOf(CAMusElement* elt)
+{
+    static CATempoMap defaultMap;
+    if (elt->context() && elt->context()->sheet()) {
+        return elt->context()->sheet()->tempoMap();
+    }
+
+    return &defaultMap;
+}
+
+/*!
+	Returns the start of the element in miliseconds from the beginning of the sheet.
+	Tempo and ritardando marks are taken into account.
+
+	\sa CASheet::tempoMap(), timeStart()
+*/
+int CAMusElement::realTimeStart()
+{
+    return qRound(tempoMapOf(this)->timeToMs(timeStart()));
+}
+
+/*!
+	Marks the tempo map of the sheet the element belongs to out of date.
+	Call when changing the timing of a tempo or ritardando mark.
+
+	\sa CASheet::invalidateTempoMap()
+*/
+void CAMusElement::invalidateTempoMap()
+{
+    if (context() && context()->sheet()) {
+        context()->sheet()->invalidateTempoMap();
     }
 }
 
+/*!
+	Returns the length of the element in miliseconds.
+
+	\sa realTimeStart(), timeLength()
+*/
+int CAMusElement::realTimeLength()
+{
+    CATempoMap* map = tempoMapOf(this);
+    return qRound(map->timeToMs(timeEnd()) - map->timeToMs(timeStart()));
+}
+
 /*!
 	Returns true, if the current element is playable; otherwise false.
 	Playable elements are music elements with _timeLength variable greater
@@ -169,7 +260,7 @@ CAMusElement::CAMusElementType CAMusElement::musElementTypeFromString(const QStr
 */
 void CAMusElement::addMark(CAMark* mark)
 {
-    if (!mark || _markList.contains(mark))
+    if (!mark || markList().contains(mark))
         return;
 
     int l;
@@ -180,7 +271,21 @@ void CAMusElement::addMark(CAMark* mark)
             ; // Articulation marks must be sorted by their articulation mark type.
     }
 
-    _markList.insert(l, mark);
+    extra()->markList.insert(l, mark);
+
+    if (mark->markType() == CAMark::Tempo || mark->markType() == CAMark::Ritardando) {
+        invalidateTempoMap();
+    }
+}
+
+/*!
+	Removes the \a mark from the mark list without deleting it.
+*/
+void CAMusElement::removeMark(CAMark* mark)
+{
+    if (_extra && _extra->markList.removeAll(mark) && (mark->markType() == CAMark::Tempo || mark->markType() == CAMark::Ritardando)) {
+        invalidateTempoMap();
+    }
 }
 
 /*!
@@ -278,7 +383,7 @@ void CAMusElement::addMarks(QList<CAMark*> marks)
 	\fn CAMusElement::setName(QString name)
 	Sets the name of the music element to \a name.
 
-	\sa _name, name()
+	\sa _extra, name()
 */
 
 /*!
@@ -333,9 +438,10 @@ void CAMusElement::addMarks(QList<CAMark*> marks)
 */
 
 /*!
-	\var CAMusElement::_name
-	Specific name of the music element in QString.
-	Names are optional and are not necessary unique.
+	\var CAMusElement::_extra
+	Marks, note checker errors, color and name of the music element.
+	Most of the elements have none of them, so the structure is only allocated when
+	one of them is set. Names are optional and are not necessary unique.
 
-	\sa name(), setName()
+	\sa name(), color(), markList(), noteCheckerErrorList()
 */
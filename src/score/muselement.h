@@ -17,6 +17,15 @@ class CAMusElement;
 class CAPlayable;
 class CAMark;
 class CANoteCheckerError;
+class CASlotPool;
+
+// Rarely used properties of CAMusElement, allocated on first use
+struct CAMusElementExtra {
+    QList<CAMark*> markList;
+    QList<CANoteCheckerError*> noteCheckerErrorList;
+    QColor color;
+    QString name;
+};
 
 class CAMusElement {
 public:
@@ -41,6 +50,12 @@ public:
     CAMusElement(CAContext* context, int timeStart, int timeLength = 0);
     virtual ~CAMusElement();
 
+#ifndef SWIG
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size);
+    static CASlotPool* pool();
+#endif
+
     virtual CAMusElement* clone(CAContext* context = nullptr) = 0;
     virtual int compare(CAMusElement* elt) = 0;
 
@@ -55,27 +70,40 @@ public:
     inline void setTimeLength(int length) { _timeLength = length; }
     inline int timeEnd() { return timeStart() + timeLength(); }
 
-    inline virtual int realTimeStart() { return _timeStart; } // TODO: calculates and returns time in miliseconds
-    inline virtual int realTimeLength() { return _timeLength; } // TODO: calculates and returns time in miliseconds
-    inline int realTimeEnd() { return realTimeStart() + realTimeLength(); } // TODO: calculates and returns time in miliseconds
+    virtual int realTimeStart();
+    virtual int realTimeLength();
+    inline int realTimeEnd() { return realTimeStart() + realTimeLength(); }
+    void invalidateTempoMap();
 
-    inline const QString name() { return _name; }
-    inline void setName(const QString name) { _name = name; }
+    inline const QString name() { return _extra ? _extra->name : QString(); }
+    inline void setName(const QString name)
+    {
+        if (_extra || !name.isEmpty())
+            extra()->name = name;
+    }
 
     inline bool isVisible() { return _visible; }
     inline void setVisible(const bool v) { _visible = v; }
 
-    inline const QColor color() { return _color; }
-    inline void setColor(const QColor c) { _color = c; }
+    inline const QColor color() { return _extra ? _extra->color : QColor(); }
+    inline void setColor(const QColor c)
+    {
+        if (_extra || c.isValid())
+            extra()->color = c;
+    }
 
-    inline const QList<CAMark*> markList() { return _markList; }
+    inline const QList<CAMark*> markList() { return _extra ? _extra->markList : QList<CAMark*>(); }
     void addMark(CAMark* mark);
     void addMarks(QList<CAMark*> marks);
-    inline void removeMark(CAMark* mark) { _markList.removeAll(mark); }
+    void removeMark(CAMark* mark);
 
-    inline const QList<CANoteCheckerError*>& noteCheckerErrorList() { return _noteCheckerErrorList; }
-    inline void addNoteCheckerError(CANoteCheckerError* nce) { _noteCheckerErrorList << nce; }
-    inline void removeNoteCheckerError(CANoteCheckerError* nce) { _noteCheckerErrorList.removeAll(nce); }
+    const QList<CANoteCheckerError*>& noteCheckerErrorList();
+    inline void addNoteCheckerError(CANoteCheckerError* nce) { extra()->noteCheckerErrorList << nce; }
+    inline void removeNoteCheckerError(CANoteCheckerError* nce)
+    {
+        if (_extra)
+            _extra->noteCheckerErrorList.removeAll(nce);
+    }
 
     bool isPlayable();
 
@@ -84,15 +112,18 @@ public:
 
 protected:
     inline void setMusElementType(CAMusElementType type) { _musElementType = type; }
+    inline CAMusElementExtra* extra()
+    {
+        if (!_extra)
+            _extra = new CAMusElementExtra;
+        return _extra;
+    }
 
-    CAMusElementType _musElementType;
-    QList<CAMark*> _markList;
-    QList<CANoteCheckerError*> _noteCheckerErrorList;
     CAContext* _context;
+    CAMusElementExtra* _extra; // marks, note checker errors, color and name, Null until set
+    CAMusElementType _musElementType;
     int _timeStart;
     int _timeLength;
     bool _visible;
-    QColor _color;
-    QString _name;
 };
 #endif /* MUSELEMENT_H_ */
@@ -17,8 +17,9 @@
 
 	This class represents every note in the score. It inherits the base class CAPlayable.
 
-	Chords in Canorus don't have its own class, but are represented as a list of notes.
-	The first note in the chord identifies it and contains chord-level marks.
+	Notes sharing the same time slot in a voice are grouped into a CAChord, which is
+	maintained by the voice. The first note in the chord identifies it and contains
+	chord-level marks.
 */
 
 /*!
@@ -34,6 +35,7 @@ CANote::CANote(CADiatonicPitch pitch, CAPlayableLength length, CAVoice* voice, i
     _musElementType = CAMusElement::Note;
     _forceAccidentals = false;
     _stemDirection = StemPreferred;
+    _chord = nullptr;
 
     setTieStart(nullptr);
     setSlurStart(nullptr);
@@ -108,16 +110,7 @@ int CANote::notePosition()
 {
     CAClef* clef = nullptr;
     if (voice() && voice()->staff()) {
-        // find the corresponding clef
-        int i = 0;
-        while (i < voice()->staff()->clefRefs().size() && staff()->clefRefs()[i]->timeStart() <= timeStart()) {
-            i++;
-        }
-        i--;
-
-        if (i >= 0) {
-            clef = static_cast<CAClef*>(voice()->staff()->clefRefs()[i]);
-        }
+        clef = voice()->staff()->clefAt(timeStart());
     }
 
     return (diatonicPitch().noteName() + (clef ? clef->c1() : -2) - 28);
@@ -164,17 +157,7 @@ const QString CANote::generateNoteName(int pitch, int accs)
 */
 bool CANote::isPartOfChord()
 {
-    int idx = voice()->musElementList().indexOf(this);
-
-    // is there a note with the same start time after ours?
-    if (idx + 1 < voice()->musElementList().size() && voice()->musElementList()[idx + 1]->musElementType() == CAMusElement::Note && voice()->musElementList()[idx + 1]->timeStart() == _timeStart)
-        return true;
-
-    // is there a note with the same start time before ours?
-    if (idx > 0 && voice()->musElementList()[idx - 1]->musElementType() == CAMusElement::Note && voice()->musElementList()[idx - 1]->timeStart() == _timeStart)
-        return true;
-
-    return false;
+    return _chord && _chord->size() > 1;
 }
 
 /*!
@@ -182,13 +165,7 @@ bool CANote::isPartOfChord()
 */
 bool CANote::isFirstInChord()
 {
-    int idx = voice()->musElementList().indexOf(this);
-
-    //is there a note with the same start time before ours?
-    if (idx > 0 && voice()->musElementList()[idx - 1]->musElementType() == CAMusElement::Note && voice()->musElementList()[idx - 1]->timeStart() == _timeStart)
-        return false;
-
-    return true;
+    return !_chord || _chord->first() == this;
 }
 
 /*!
@@ -196,37 +173,24 @@ bool CANote::isFirstInChord()
 */
 bool CANote::isLastInChord()
 {
-    int idx = voice()->musElementList().indexOf(this);
-
-    //is there a note with the same start time after ours?
-    if (idx + 1 < voice()->musElementList().size() && voice()->musElementList()[idx + 1]->musElementType() == CAMusElement::Note && voice()->musElementList()[idx + 1]->timeStart() == _timeStart)
-        return false;
-
-    return true;
+    return !_chord || _chord->last() == this;
 }
 
 /*!
-	Generates a list of notes with the same start time - the whole chord - in the current voice.
+	Returns the list of notes in the chord of this note.
 	Notes in chord keep the order present in the voice. This is usually bottom-up.
 
 	Returns a single element in the list - only the note itself, if the note isn't part of the chord.
 
-	\sa CAVoice::addNoteToChord()
+	\sa chord(), CAVoice::addNoteToChord()
 */
 QList<CANote*> CANote::getChord()
 {
-    QList<CANote*> list;
-    int idx = voice()->musElementList().indexOf(this) - 1;
-
-    while (idx >= 0 && voice()->musElementList()[idx]->musElementType() == CAMusElement::Note && voice()->musElementList()[idx]->timeStart() == timeStart())
-        idx--;
-
-    for (idx++;
-         (idx >= 0 && idx < voice()->musElementList().size()) && (voice()->musElementList()[idx]->musElementType() == CAMusElement::Note) && (voice()->musElementList()[idx]->timeStart() == timeStart());
-         idx++)
-        list << static_cast<CANote*>(voice()->musElementList()[idx]);
+    if (!_chord) {
+        return QList<CANote*>() << this;
+    }
 
-    return list;
+    return _chord->noteList();
 }
 
 int CANote::compare(CAMusElement* elt)
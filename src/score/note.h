@@ -8,6 +8,7 @@
 #ifndef NOTE_H_
 #define NOTE_H_
 
+#include "score/chord.h"
 #include "score/diatonicpitch.h"
 #include "score/muselement.h"
 #include "score/playable.h"
@@ -16,6 +17,8 @@
 class CAVoice;
 
 class CANote : public CAPlayable {
+    friend class CAVoice; // sets the chord when inserting and removing the note
+
 public:
     enum CAStemDirection {
         StemUndefined = -1,
@@ -64,6 +67,7 @@ public:
 
     void updateTies();
 
+    inline CAChord* chord() { return _chord; }
     bool isPartOfChord();
     bool isLastInChord();
     bool isFirstInChord();
@@ -83,6 +87,7 @@ private:
     CADiatonicPitch _diatonicPitch;
     CAStemDirection _stemDirection;
     bool _forceAccidentals; // Always draw notes accidentals.
+    CAChord* _chord; // Chord in the voice, Null if the note isn't inserted in any
 
     ////////////////////
     // Slurs and ties //
@@ -16,13 +16,18 @@
 
 	CANoteCheckerError is a class corresponding to the error, warning, hint etc.
 	in the score, produced by the CANoteChecker.
+
+	The hash() identifies the content the error was found in, eg. the bar for the
+	"bar duration incorrect" error. CANoteChecker keeps the error as long as the hash
+	doesn't change.
 	
 	\sa CANoteChecker, CADrawableNoteCheckerError
 */
 
-CANoteCheckerError::CANoteCheckerError(CAMusElement* targetElement, QString message)
+CANoteCheckerError::CANoteCheckerError(CAMusElement* targetElement, QString message, uint hash)
     : _targetElement(targetElement)
     , _message(message)
+    , _hash(hash)
 {
     targetElement->addNoteCheckerError(this);
 }
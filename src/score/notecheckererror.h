@@ -14,11 +14,16 @@ class CAMusElement;
 
 class CANoteCheckerError {
 public:
-    CANoteCheckerError(CAMusElement* targetElement, QString message);
+    CANoteCheckerError(CAMusElement* targetElement, QString message, uint hash = 0);
     ~CANoteCheckerError();
 
+    inline CAMusElement* targetElement() { return _targetElement; }
+    inline const QString& message() { return _message; }
+    inline uint hash() { return _hash; }
+
 private:
     CAMusElement* _targetElement;
     QString _message;
+    uint _hash; // content of the checked bar or element when the error was found
 };
 #endif /* NOTECHECKERERROR_H_ */
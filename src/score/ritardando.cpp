@@ -31,6 +31,12 @@ CARitardando::~CARitardando()
 {
 }
 
+void CARitardando::setFinalTempo(const int t)
+{
+    _finalTempo = t;
+    invalidateTempoMap();
+}
+
 CARitardando* CARitardando::clone(CAMusElement* elt)
 {
     return new CARitardando(finalTempo(), (elt->isPlayable()) ? static_cast<CAPlayable*>(elt) : nullptr, timeLength(), ritardandoType());
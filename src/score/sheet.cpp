@@ -34,6 +34,9 @@
 	Creats a new sheet named \a name with parent document \a doc.
 */
 CASheet::CASheet(const QString name, CADocument* doc)
+    : _staffListValid(0)
+    , _voiceListValid(0)
+    , _tempoMapValid(0)
 {
     _name = name;
     _document = doc;
@@ -88,6 +91,7 @@ CAStaff* CASheet::addStaff()
     s->addVoice();
 
     _contextList.append(s);
+    invalidateStaffList();
 
     return s;
 }
@@ -100,6 +104,7 @@ void CASheet::clear()
     }
 
     _contextList.clear();
+    invalidateStaffList();
 }
 
 /*!
@@ -143,7 +148,7 @@ QString CASheet::findUniqueContextName(const QString mask)
 QList<CAPlayable*> CASheet::getChord(int time)
 {
     QList<CAPlayable*> chordList;
-    QList<CAStaff*> staffs = staffList();
+    const QList<CAStaff*>& staffs = staffList();
     for (int i = staffs.size() - 1; i >= 0; i--) {
         chordList << staffs[i]->getChord(time);
     }
@@ -157,8 +162,9 @@ QList<CAPlayable*> CASheet::getChord(int time)
 CATempo* CASheet::getTempo(int time)
 {
     CATempo* tempo = nullptr;
-    for (int i = 0; i < staffList().size(); i++) {
-        CATempo* t = staffList()[i]->getTempo(time);
+    const QList<CAStaff*>& staffs = staffList();
+    for (int i = 0; i < staffs.size(); i++) {
+        CATempo* t = staffs[i]->getTempo(time);
         if (t && (!tempo || t->timeStart() > tempo->timeStart())) {
             tempo = t;
         }
@@ -169,30 +175,100 @@ CATempo* CASheet::getTempo(int time)
 
 /*!
 	Returns the list of all the voices in the sheets staffs.
+
+	The list is cached and only regenerated after a context or a voice has been added
+	or removed, so calling this in loops is cheap. The returned reference stays valid
+	for the lifetime of the sheet, but its content changes when the sheet is modified.
+
+	The regeneration is locked, so the list may be read from several threads at once
+	(eg. the note checker and the playback), as long as the sheet isn't modified meanwhile.
+
+	\sa staffList(), invalidateVoiceList()
 */
-QList<CAVoice*> CASheet::voiceList()
+const QList<CAVoice*>& CASheet::voiceList()
 {
-    QList<CAVoice*> list;
-    QList<CAStaff*> staffs = staffList();
-    for (int i = 0; i < staffs.size(); i++)
-        list << staffs[i]->voiceList();
+    if (!_voiceListValid.loadAcquire()) {
+        const QList<CAStaff*>& staffs = staffList();
+
+        QMutexLocker locker(&_listMutex);
+        if (!_voiceListValid.loadAcquire()) {
+            _voiceList.clear();
+            for (int i = 0; i < staffs.size(); i++)
+                _voiceList << staffs[i]->voiceList();
 
-    return list;
+            _voiceListValid.storeRelease(1);
+        }
+    }
+
+    return _voiceList;
 }
 
-QList<CAStaff*> CASheet::staffList()
+/*!
+	Returns the list of all the staffs in the sheet in the order of contexts.
+	The list is cached the same way as voiceList().
+
+	\sa invalidateStaffList()
+*/
+const QList<CAStaff*>& CASheet::staffList()
 {
-    QList<CAStaff*> staffList;
+    if (!_staffListValid.loadAcquire()) {
+        QMutexLocker locker(&_listMutex);
+        if (!_staffListValid.loadAcquire()) {
+            _staffList.clear();
+            for (int i = 0; i < _contextList.size(); i++) {
+                if (_contextList[i]->contextType() == CAContext::Staff) {
+                    _staffList << static_cast<CAStaff*>(_contextList[i]);
+                }
+            }
 
-    for (int i = 0; i < _contextList.size(); i++) {
-        if (_contextList[i]->contextType() == CAContext::Staff) {
-            staffList << static_cast<CAStaff*>(_contextList[i]);
+            _staffListValid.storeRelease(1);
         }
     }
 
-    return staffList;
+    return _staffList;
 }
 
+/*!
+	Returns the map between the Canorus time and miliseconds of the sheet.
+
+	The map is rebuilt from the tempo and ritardando marks on the first call after
+	invalidateTempoMap(), so it doesn't depend on the sheet being laid out. The rebuild
+	is locked the same way as voiceList().
+
+	\sa CATempoMap, CAMusElement::realTimeStart()
+*/
+CATempoMap* CASheet::tempoMap()
+{
+    if (!_tempoMapValid.loadAcquire()) {
+        QMutexLocker locker(&_tempoMapMutex);
+        if (!_tempoMapValid.loadAcquire()) {
+            _tempoMap.rebuild(this);
+            _tempoMapValid.storeRelease(1);
+        }
+    }
+
+    return &_tempoMap;
+}
+
+/*!
+	\fn void CASheet::invalidateTempoMap()
+	Marks the tempo map out of date.
+	Called automatically when tempo or ritardando marks are added, removed or changed and
+	when the voices change the timing of their elements.
+*/
+
+/*!
+	\fn void CASheet::invalidateStaffList()
+	Marks the cached staff and voice lists out of date.
+	Called automatically when the contexts are added or removed through the sheet.
+*/
+
+/*!
+	\fn void CASheet::invalidateVoiceList()
+	Marks the cached voice list out of date.
+	Called automatically by CAStaff when its voices are added or removed.
+*/
+
 /*!
 	Inserts the given context \a c after the context \a after.
  */
@@ -204,6 +280,7 @@ void CASheet::insertContextAfter(CAContext* after, CAContext* c)
     } else {
         _contextList.insert(idx + 1, c);
     }
+    invalidateStaffList();
 }
 
 /*!
@@ -8,11 +8,14 @@
 #ifndef SHEET_H_
 #define SHEET_H_
 
+#include <QAtomicInt>
 #include <QList>
+#include <QMutex>
 #include <QString>
 
 #include "score/context.h"
 #include "score/staff.h"
+#include "score/tempomap.h"
 
 class CADocument;
 class CAPlayable;
@@ -28,15 +31,38 @@ public:
 
     inline const QList<CAContext*>& contextList() { return _contextList; }
     CAContext* findContext(const QString name);
-    inline void insertContext(int pos, CAContext* c) { _contextList.insert(pos, c); }
+    inline void insertContext(int pos, CAContext* c)
+    {
+        _contextList.insert(pos, c);
+        invalidateStaffList();
+    }
     void insertContextAfter(CAContext* after, CAContext* c);
-    inline void addContext(CAContext* c) { _contextList << c; }
-    inline void removeContext(CAContext* c) { _contextList.removeAll(c); }
+    inline void addContext(CAContext* c)
+    {
+        _contextList << c;
+        invalidateStaffList();
+    }
+    inline void removeContext(CAContext* c)
+    {
+        _contextList.removeAll(c);
+        invalidateStaffList();
+    }
     QString findUniqueContextName(QString mask);
 
     CAStaff* addStaff();
-    QList<CAStaff*> staffList(); // generated list
-    QList<CAVoice*> voiceList(); // generated list
+    const QList<CAStaff*>& staffList(); // cached list
+    const QList<CAVoice*>& voiceList(); // cached list
+    inline void invalidateStaffList()
+    {
+        _staffListValid.storeRelease(0);
+        _voiceListValid.storeRelease(0);
+        _tempoMapValid.storeRelease(0);
+    }
+    inline void invalidateVoiceList()
+    {
+        _voiceListValid.storeRelease(0);
+        _tempoMapValid.storeRelease(0);
+    }
 
     QList<CAPlayable*> getChord(int time);
     CATempo* getTempo(int time);
@@ -51,13 +77,24 @@ public:
     void clearNoteCheckerErrors();
     inline QList<CANoteCheckerError*>& noteCheckerErrorList() { return _noteCheckerErrorList; }
 
+    CATempoMap* tempoMap(); // cached map
+    inline void invalidateTempoMap() { _tempoMapValid.storeRelease(0); }
+
     void clear();
 
 private:
     QList<CAContext*> _contextList;
+    QList<CAStaff*> _staffList; // staffs in _contextList, rebuilt on demand
+    QList<CAVoice*> _voiceList; // voices of _staffList, rebuilt on demand
+    QAtomicInt _staffListValid;
+    QAtomicInt _voiceListValid;
+    QMutex _listMutex; // Serializes rebuilding the cached lists, they may be read from other threads
     CADocument* _document;
     QList<CANoteCheckerError*> _noteCheckerErrorList;
 
     QString _name;
+    CATempoMap _tempoMap; // Time <-> miliseconds, rebuilt on demand
+    QAtomicInt _tempoMapValid;
+    QMutex _tempoMapMutex; // Serializes rebuilding the tempo map
 };
 #endif /*SHEET_H_*/
@@ -8,10 +8,14 @@
 #include <QtDebug>
 
 #include <QPainter>
+#include <algorithm>
 #include <iostream>
 
+#include "score/clef.h"
+#include "score/keysignature.h"
 #include "score/note.h"
 #include "score/rest.h" // used for voice synchronization
+#include "score/sheet.h"
 #include "score/staff.h"
 #include "score/tempo.h"
 #include "score/tuplet.h"
@@ -213,6 +217,36 @@ CAVoice* CAStaff::addVoice()
     return voice;
 }
 
+/*!
+	Appends the existing \a voice to the staff.
+*/
+void CAStaff::addVoice(CAVoice* voice)
+{
+    _voiceList << voice;
+    if (sheet())
+        sheet()->invalidateVoiceList();
+}
+
+/*!
+	Inserts the existing \a voice at the position \a idx.
+*/
+void CAStaff::insertVoice(int idx, CAVoice* voice)
+{
+    _voiceList.insert(idx, voice);
+    if (sheet())
+        sheet()->invalidateVoiceList();
+}
+
+/*!
+	Removes the \a voice from the staff without deleting it.
+*/
+void CAStaff::removeVoice(CAVoice* voice)
+{
+    _voiceList.removeAll(voice);
+    if (sheet())
+        sheet()->invalidateVoiceList();
+}
+
 /*!
 	Returns the pointer to the element right next to the given \a elt in any of the voice.
 
@@ -347,6 +381,64 @@ CATempo* CAStaff::getTempo(int time)
     return tempo;
 }
 
+/*!
+	Returns the index of the first element in the time-ordered signature references \a refs
+	(eg. clefRefs()) starting at or after the given \a time.
+	Uses binary search.
+
+	\sa refsUpperBound()
+*/
+int CAStaff::refsLowerBound(const QList<CAMusElement*>& refs, int time)
+{
+    return std::lower_bound(refs.constBegin(), refs.constEnd(), time,
+               [](const CAMusElement* elt, int t) { return elt->timeStart() < t; })
+        - refs.constBegin();
+}
+
+/*!
+	Returns the index of the first element in the time-ordered signature references \a refs
+	starting after the given \a time.
+	Uses binary search.
+
+	\sa refsLowerBound()
+*/
+int CAStaff::refsUpperBound(const QList<CAMusElement*>& refs, int time)
+{
+    return std::upper_bound(refs.constBegin(), refs.constEnd(), time,
+               [](int t, const CAMusElement* elt) { return t < elt->timeStart(); })
+        - refs.constBegin();
+}
+
+/*!
+	Returns the clef in effect at the given \a time or Null, if no clef is placed before.
+	If several clefs start at the same time, the last one is returned.
+*/
+CAClef* CAStaff::clefAt(int time)
+{
+    int i = refsUpperBound(_clefList, time);
+    return (i ? static_cast<CAClef*>(_clefList[i - 1]) : nullptr);
+}
+
+/*!
+	Returns the key signature in effect at the given \a time or Null, if no key signature
+	is placed before.
+*/
+CAKeySignature* CAStaff::keySignatureAt(int time)
+{
+    int i = refsUpperBound(_keySignatureList, time);
+    return (i ? static_cast<CAKeySignature*>(_keySignatureList[i - 1]) : nullptr);
+}
+
+/*!
+	Returns the time signature in effect at the given \a time or Null, if no time signature
+	is placed before.
+*/
+CATimeSignature* CAStaff::timeSignatureAt(int time)
+{
+    int i = refsUpperBound(_timeSignatureList, time);
+    return (i ? static_cast<CATimeSignature*>(_timeSignatureList[i - 1]) : nullptr);
+}
+
 /*!
 	Fixes voices inconsistency:
 	1) If any of the voices include signs (key sigs, clefs etc.) which aren't present in all voices,
@@ -362,6 +454,8 @@ CATempo* CAStaff::getTempo(int time)
 	slow down the import filter.
 
 	\return True, if everything was ok. False, if fixes were needed.
+
+	\sa synchronizeVoices(int, int)
 */
 bool CAStaff::synchronizeVoices()
 {
@@ -377,25 +471,127 @@ bool CAStaff::synchronizeVoices()
     _timeSignatureList.clear();
     _barlineList.clear();
 
-    int timeStart = 0;
-    bool done = false;
-    bool changesMade = false;
-
     // first fix any inconsistencies inside a voice
     for (int i = 0; i < voiceList().size(); i++)
         voiceList()[i]->synchronizeMusElements();
 
+    QList<CAMusElement*> signs;
+    int endTime = -1;
+    bool changesMade = synchronizeVoicesFrom(0, -1, pidx, plastPlayable, signs, endTime);
+
+    // populate the references lists
+    for (int j = 0; j < signs.size(); j++) {
+        QList<CAMusElement*>* refs = signRefs(signs[j]);
+        if (refs) {
+            *refs << signs[j];
+        }
+    }
+
+    delete[] pidx;
+    delete[] plastPlayable;
+    return changesMade;
+}
+
+/*!
+	Fixes voices inconsistency like synchronizeVoices(), but only around the shared signs
+	inserted or changed between \a timeStart and \a timeEnd.
+
+	The voices are re-aligned from the last shared sign before \a timeStart until the first
+	shared sign after \a timeEnd, which is already present in all the voices. If rests
+	needed to be inserted and the following elements moved, the synchronization continues
+	until the end of the staff. The references lists (eg. clefRefs()) are patched in place.
+
+	Use this after inserting or removing a single sign. Inserting a barline in bar 400 only
+	re-aligns bars 399 and 400 instead of the whole staff. Shared marks of the chords are not
+	fixed, call synchronizeVoices() after bigger changes.
+
+	\return True, if everything was ok. False, if fixes were needed.
+*/
+bool CAStaff::synchronizeVoices(int timeStart, int timeEnd)
+{
+    // start at the last shared sign before the edit, the voices are aligned there
+    int fromTime = 0;
+    QList<CAMusElement*>* refsLists[] = { &_clefList, &_keySignatureList, &_timeSignatureList, &_barlineList };
+    for (int j = 0; j < 4; j++) {
+        int i = refsLowerBound(*refsLists[j], timeStart);
+        if (i) {
+            fromTime = qMax(fromTime, refsLists[j]->at(i - 1)->timeStart());
+        }
+    }
+
+    int* pidx = new int[voiceList().size()];
+    CAMusElement** plastPlayable = new CAMusElement*[voiceList().size()];
+    for (int i = 0; i < voiceList().size(); i++) {
+        const QList<CAMusElement*>& list = voiceList()[i]->musElementList();
+        pidx[i] = refsLowerBound(list, fromTime) - 1; // music elements are sorted by time as well
+
+        int j = pidx[i];
+        while (j >= 0 && !list[j]->isPlayable())
+            j--;
+        plastPlayable[i] = (j >= 0 ? list[j] : nullptr);
+    }
+
+    QList<CAMusElement*> signs;
+    int endTime = -1;
+    bool changesMade = synchronizeVoicesFrom(fromTime, timeEnd, pidx, plastPlayable, signs, endTime);
+
+    // replace the references of the re-aligned range
+    for (int j = 0; j < signs.size(); j++) {
+        QList<CAMusElement*>* refs = signRefs(signs[j]);
+        if (refs) {
+            refs->removeAll(signs[j]); // the sign may have been moved
+        }
+    }
+    for (int j = 0; j < 4; j++) {
+        QList<CAMusElement*>& refs = *refsLists[j];
+        int first = refsLowerBound(refs, fromTime);
+        int last = (endTime == -1 ? refs.size() : refsUpperBound(refs, endTime));
+        refs.erase(refs.begin() + first, refs.begin() + qMax(first, last));
+    }
+    for (int j = signs.size() - 1; j >= 0; j--) {
+        QList<CAMusElement*>* refs = signRefs(signs[j]);
+        if (refs) {
+            refs->insert(refsLowerBound(*refs, fromTime), signs[j]);
+        }
+    }
+
+    delete[] pidx;
+    delete[] plastPlayable;
+    return changesMade;
+}
+
+/*!
+	Walks the voices column by column starting at \a timeStart and the voice indices \a pidx
+	and the last playable elements \a plastPlayable at that time and fixes their
+	inconsistencies. The shared signs met are appended to \a signs in time order.
+
+	If \a stopTime is not -1, the walk stops at the first consistent column of shared signs
+	after \a stopTime, if no elements were moved in between. Its time is stored in \a endTime.
+	Otherwise the walk continues until the end of the staff and \a endTime is -1.
+
+	\sa synchronizeVoices()
+*/
+bool CAStaff::synchronizeVoicesFrom(int timeStart, int stopTime, int* pidx, CAMusElement** plastPlayable, QList<CAMusElement*>& signs, int& endTime)
+{
+    bool done = false;
+    bool changesMade = false;
+    bool shifted = false; // were any playable elements moved
+    endTime = -1;
+
     while (!done) {
         QList<CAMusElement*> sharedList; // list of shared music elements having the same time-start sorted by voice number
+        QList<int> gatheredCount; // number of shared elements found in each voice
 
         // gather shared elements into sharedList and remove them from the voice at new timeStart
         for (int i = 0; i < voiceList().size(); i++) {
+            gatheredCount << 0;
             // don't increase pidx[i], if the next element is not-playable
             while (pidx[i] < voiceList()[i]->musElementList().size() - 1 && !voiceList()[i]->musElementList()[pidx[i] + 1]->isPlayable() && (voiceList()[i]->musElementList()[pidx[i] + 1]->timeStart() == timeStart)) {
                 if (!sharedList.contains(voiceList()[i]->musElementList()[pidx[i] + 1])) {
                     sharedList << voiceList()[i]->musElementList()[pidx[i] + 1];
                 }
                 voiceList()[i]->_musElementList.removeAt(pidx[i] + 1);
+                gatheredCount[i]++;
             }
         }
 
@@ -410,25 +606,7 @@ bool CAStaff::synchronizeVoices()
                     // or the first one after the sharedList in second pass
             }
 
-            // populate the references lists
-            for (int j = 0; j < sharedList.size(); j++) {
-                switch (sharedList[j]->musElementType()) {
-                case CAMusElement::KeySignature:
-                    _keySignatureList << sharedList[j];
-                    break;
-                case CAMusElement::TimeSignature:
-                    _timeSignatureList << sharedList[j];
-                    break;
-                case CAMusElement::Clef:
-                    _clefList << sharedList[j];
-                    break;
-                case CAMusElement::Barline:
-                    _barlineList << sharedList[j];
-                    break;
-                default:
-                    break;
-                }
-            }
+            signs << sharedList;
 
         } else {
             for (int i = 0; i < voiceList().size(); i++) {
@@ -459,6 +637,7 @@ bool CAStaff::synchronizeVoices()
                     for (int k = 0; k < restList.size(); k++)
                         voiceList()[i]->_musElementList.insert(pidx[i]++, restList[k]); // insert the missing rests, rests are added in back, pidx++
                     voiceList()[i]->updateTimes(pidx[i], gapLength, false); // increase playable timeStarts
+                    shifted = true;
                     if (restList.size()) {
                         plastPlayable[i] = restList.last();
                     } else {
@@ -480,6 +659,7 @@ bool CAStaff::synchronizeVoices()
                 for (int k = 0; k < restList.size(); k++)
                     voiceList()[j]->_musElementList.insert(pidx[j]++, restList[k]); // insert the missing rests, rests are added in back, pidx++
                 voiceList()[j]->updateTimes(pidx[j], gapLength, false); // increase playable timeStarts
+                shifted = true;
                 if (restList.size()) {
                     plastPlayable[j] = restList.last();
                 } else {
@@ -496,6 +676,12 @@ bool CAStaff::synchronizeVoices()
             }
         }
 
+        // the rest of the staff is untouched, if all the voices share the same signs again and nothing was shifted
+        if (stopTime != -1 && timeStart > stopTime && sharedList.size() && !shifted && gatheredCount.count(sharedList.size()) == gatheredCount.size()) {
+            endTime = timeStart;
+            break;
+        }
+
         // shortest time is delta between the current elements and the nearest one in the future
         int shortestTime = -1;
 
@@ -513,10 +699,29 @@ bool CAStaff::synchronizeVoices()
                 done = false;
     }
 
-    delete[] pidx;
     return changesMade;
 }
 
+/*!
+	Returns the references list for the given shared \a sign or Null, if signs of that type
+	are not referenced.
+*/
+QList<CAMusElement*>* CAStaff::signRefs(CAMusElement* sign)
+{
+    switch (sign->musElementType()) {
+    case CAMusElement::KeySignature:
+        return &_keySignatureList;
+    case CAMusElement::TimeSignature:
+        return &_timeSignatureList;
+    case CAMusElement::Clef:
+        return &_clefList;
+    case CAMusElement::Barline:
+        return &_barlineList;
+    default:
+        return nullptr;
+    }
+}
+
 /*!
 	Places a barline in front of the element, if needed and the element is the
 	last element in the staff.
@@ -550,7 +755,7 @@ bool CAStaff::placeAutoBar(CAPlayable* elt)
     if (t) {
         if ((b ? (b->timeStart()) : 0) + t->barDuration() <= elt->timeStart()) {
             elt->voice()->insert(elt, new CABarline(CABarline::Single, elt->staff(), elt->timeStart()));
-            elt->staff()->synchronizeVoices();
+            elt->staff()->synchronizeVoices(elt->timeStart(), elt->timeStart());
 
             return true;
         }
@@ -21,6 +21,9 @@ class CAContext;
 class CAVoice;
 class CANote;
 class CATempo;
+class CAClef;
+class CAKeySignature;
+class CATimeSignature;
 
 class CAStaff : public CAContext {
 public:
@@ -33,10 +36,10 @@ public:
     CAStaff* clone(CASheet* s);
 
     inline const QList<CAVoice*>& voiceList() { return _voiceList; }
-    inline void addVoice(CAVoice* voice) { _voiceList << voice; }
-    inline void insertVoice(int idx, CAVoice* voice) { _voiceList.insert(idx, voice); }
+    void addVoice(CAVoice* voice);
+    void insertVoice(int idx, CAVoice* voice);
     CAVoice* addVoice();
-    inline void removeVoice(CAVoice* voice) { _voiceList.removeAll(voice); }
+    void removeVoice(CAVoice* voice);
     CAVoice* findVoice(const QString name);
 
     CAMusElement* next(CAMusElement* elt);
@@ -54,6 +57,7 @@ public:
     CATempo* getTempo(int time);
 
     bool synchronizeVoices();
+    bool synchronizeVoices(int timeStart, int timeEnd);
 
     static bool placeAutoBar(CAPlayable* elt);
 
@@ -63,7 +67,17 @@ public:
     inline QList<CAMusElement*>& timeSignatureRefs() { return _timeSignatureList; }
     inline QList<CAMusElement*>& barlineRefs() { return _barlineList; }
 
+    // Signature timeline, binary search over the references above
+    CAClef* clefAt(int time);
+    CAKeySignature* keySignatureAt(int time);
+    CATimeSignature* timeSignatureAt(int time);
+    static int refsLowerBound(const QList<CAMusElement*>& refs, int time);
+    static int refsUpperBound(const QList<CAMusElement*>& refs, int time);
+
 private:
+    bool synchronizeVoicesFrom(int timeStart, int stopTime, int* pidx, CAMusElement** plastPlayable, QList<CAMusElement*>& signs, int& endTime);
+    QList<CAMusElement*>* signRefs(CAMusElement* sign);
+
     QList<CAVoice*> _voiceList;
 
     int _numberOfLines;
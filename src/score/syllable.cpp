@@ -35,6 +35,7 @@ CASyllable::CASyllable(QString text, bool hyphen, bool melisma, CALyricsContext*
     setHyphenStart(hyphen);
     setMelismaStart(melisma);
     setAssociatedVoice(voice);
+    setSlot(-1);
 }
 
 CASyllable::~CASyllable()
@@ -32,6 +32,8 @@ public:
     inline void setAssociatedVoice(CAVoice* v) { _associatedVoice = v; }
 
     inline CALyricsContext* lyricsContext() { return static_cast<CALyricsContext*>(_context); }
+    inline int slot() { return _slot; }
+    inline void setSlot(int slot) { _slot = slot; }
 
     CASyllable* clone(CAContext* context);
     int compare(CAMusElement*);
@@ -40,6 +42,7 @@ private:
     bool _hyphenStart, _melismaStart;
     QString _text;
     CAVoice* _associatedVoice; // per-syllable associated voice, 0 if preferred (parent's voice)
+    int _slot; // index in the syllable list of the lyrics context, -1 if not added yet
 };
 
 #endif /* SYLLABLE_H_ */
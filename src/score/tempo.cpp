@@ -26,6 +26,18 @@ CATempo::~CATempo()
 {
 }
 
+void CATempo::setBpm(unsigned char bpm)
+{
+    _bpm = bpm;
+    invalidateTempoMap();
+}
+
+void CATempo::setBeat(CAPlayableLength l)
+{
+    _beat = l;
+    invalidateTempoMap();
+}
+
 CATempo* CATempo::clone(CAMusElement* elt)
 {
     return new CATempo(beat(), bpm(), elt);
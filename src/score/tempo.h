@@ -20,9 +20,9 @@ public:
     int compare(CAMusElement* elt);
 
     inline unsigned char bpm() { return _bpm; }
-    inline void setBpm(unsigned char bpm) { _bpm = bpm; }
+    void setBpm(unsigned char bpm);
     inline CAPlayableLength beat() { return _beat; }
-    inline void setBeat(CAPlayableLength l) { _beat = l; }
+    void setBeat(CAPlayableLength l);
 
 private:
     CAPlayableLength _beat;
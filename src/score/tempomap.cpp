@@ -0,0 +1,213 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#include <QtGlobal>
+#include <algorithm>
+#include <cmath>
+
+#include "score/mark.h"
+#include "score/playablelength.h"
+#include "score/ritardando.h"
+#include "score/sheet.h"
+#include "score/tempo.h"
+#include "score/tempomap.h"
+#include "score/voice.h"
+
+/*!
+	\class CATempoMap
+	\brief Mapping between the Canorus time and the real time in miliseconds
+
+	The map is a time sorted list of segments, each starting at a tempo change with the
+	miliseconds elapsed from the beginning of the sheet. Tempo marks start segments
+	with a constant tempo, ritardando and accellerando marks start segments where the
+	tempo changes linearly towards their final tempo. Converting the time in either
+	direction is a binary search followed by a closed form integration of the segment.
+
+	Without any tempo marks, the tempo is DEFAULT_BPM quarters per minute, the same as
+	the default tempo of MIDI files.
+
+	Every sheet has its own map, see CASheet::tempoMap(). It is rebuilt on the first
+	access after the tempo marks or the timing of the sheet changed and used by
+	CAMusElement::realTimeStart(). CAPlayback keeps its own copy for timing the playback
+	and placing the playback cursor.
+
+	\sa CATimeAxis
+*/
+
+const int CATempoMap::DEFAULT_BPM = 120;
+
+CATempoMap::CATempoMap()
+{
+    clear();
+}
+
+/*!
+	Removes all the tempo changes and sets the default tempo.
+*/
+void CATempoMap::clear()
+{
+    _segments.clear();
+    _beatLength = CAPlayableLength::playableLengthToTimeLength(CAPlayableLength::Quarter);
+    addTempo(0, DEFAULT_BPM, _beatLength);
+}
+
+/*!
+	Clears the map and adds all the tempo and ritardando marks of the given \a sheet.
+*/
+void CATempoMap::rebuild(CASheet* sheet)
+{
+    QList<CAMark*> marks;
+    const QList<CAVoice*>& voices = sheet->voiceList();
+    for (int i = 0; i < voices.size(); i++) {
+        const QList<CAMusElement*>& elts = voices[i]->musElementList();
+        for (int j = 0; j < elts.size(); j++) {
+            const QList<CAMark*>& markList = elts[j]->markList();
+            for (int k = 0; k < markList.size(); k++) {
+                if (markList[k]->markType() == CAMark::Tempo || markList[k]->markType() == CAMark::Ritardando) {
+                    marks << markList[k];
+                }
+            }
+        }
+    }
+
+    // tempos first, so ritardandos starting at the same time start from the new tempo
+    std::stable_sort(marks.begin(), marks.end(), [](CAMark* a, CAMark* b) {
+        if (a->timeStart() != b->timeStart()) {
+            return a->timeStart() < b->timeStart();
+        }
+        return a->markType() == CAMark::Tempo && b->markType() != CAMark::Tempo;
+    });
+
+    clear();
+    for (int i = 0; i < marks.size(); i++) {
+        if (marks[i]->markType() == CAMark::Tempo) {
+            CATempo* t = static_cast<CATempo*>(marks[i]);
+            addTempo(t->timeStart(), t->bpm(), CAPlayableLength::playableLengthToTimeLength(t->beat()));
+        } else {
+            CARitardando* r = static_cast<CARitardando*>(marks[i]);
+            addRitardando(r->timeStart(), r->timeLength(), r->finalTempo());
+        }
+    }
+}
+
+/*!
+	Sets the tempo to \a bpm beats of \a beatLength Canorus time per minute starting at
+	the given \a time. Changes should be added in time order, any changes at or after
+	\a time are replaced.
+*/
+void CATempoMap::addTempo(int time, int bpm, int beatLength)
+{
+    if (bpm <= 0 || beatLength <= 0) {
+        return;
+    }
+
+    _beatLength = beatLength;
+    addSegment(time, beatLength * bpm / 60000.0, 0);
+}
+
+/*!
+	Linearly changes the tempo from the current one to \a finalBpm beats per minute
+	during \a timeLength starting at the given \a time. The beat of the last tempo
+	change is used. Changes should be added in time order.
+*/
+void CATempoMap::addRitardando(int time, int timeLength, int finalBpm)
+{
+    if (finalBpm <= 0 || timeLength <= 0) {
+        return;
+    }
+
+    double rate = rateAt(time);
+    double finalRate = _beatLength * finalBpm / 60000.0;
+    addSegment(time, rate, (finalRate - rate) / timeLength);
+    addSegment(time + timeLength, finalRate, 0);
+}
+
+/*!
+	Returns the miliseconds elapsed from the beginning of the sheet until the given
+	Canorus \a time.
+*/
+double CATempoMap::timeToMs(int time)
+{
+    const CATempoSegment& s = _segments[segmentAt(time)];
+    return s.ms + duration(s, time - s.time);
+}
+
+/*!
+	Returns the Canorus time played after the given \a ms miliseconds.
+*/
+int CATempoMap::msToTime(double ms)
+{
+    int i = std::upper_bound(_segments.constBegin(), _segments.constEnd(), ms,
+                [](double m, const CATempoSegment& s) { return m < s.ms; })
+        - _segments.constBegin();
+    const CATempoSegment& s = _segments[qMax(i - 1, 0)];
+
+    double delta = qMax(ms - s.ms, 0.0);
+    if (qAbs(s.slope) < 1e-12) {
+        return s.time + qRound(delta * s.rate);
+    }
+
+    return s.time + qRound(s.rate * (std::exp(s.slope * delta) - 1) / s.slope);
+}
+
+/*!
+	Returns the tempo at the given \a time in quarters per minute.
+*/
+double CATempoMap::tempoAt(int time)
+{
+    return rateAt(time) * 60000.0 / CAPlayableLength::playableLengthToTimeLength(CAPlayableLength::Quarter);
+}
+
+/*!
+	Appends a segment starting at \a time, removing the segments starting later.
+*/
+void CATempoMap::addSegment(int time, double rate, double slope)
+{
+    while (!_segments.isEmpty() && _segments.last().time >= time) {
+        _segments.removeLast();
+    }
+
+    CATempoSegment s;
+    s.time = _segments.isEmpty() ? 0 : time;
+    s.ms = _segments.isEmpty() ? 0 : _segments.last().ms + duration(_segments.last(), time - _segments.last().time);
+    s.rate = rate;
+    s.slope = slope;
+    _segments << s;
+}
+
+/*!
+	Returns the index of the segment containing the given \a time.
+*/
+int CATempoMap::segmentAt(int time)
+{
+    int i = std::upper_bound(_segments.constBegin(), _segments.constEnd(), time,
+                [](int t, const CATempoSegment& s) { return t < s.time; })
+        - _segments.constBegin();
+    return qMax(i - 1, 0);
+}
+
+/*!
+	Returns the Canorus time per milisecond at the given \a time.
+*/
+double CATempoMap::rateAt(int time)
+{
+    const CATempoSegment& s = _segments[segmentAt(time)];
+    return s.rate + s.slope * qMax(time - s.time, 0);
+}
+
+/*!
+	Returns the miliseconds needed to play \a length Canorus time from the start of the
+	segment \a s.
+*/
+double CATempoMap::duration(const CATempoSegment& s, int length)
+{
+    if (qAbs(s.slope) < 1e-12) {
+        return length / s.rate;
+    }
+
+    return std::log(1 + s.slope * length / s.rate) / s.slope;
+}
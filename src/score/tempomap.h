@@ -0,0 +1,50 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#ifndef TEMPOMAP_H_
+#define TEMPOMAP_H_
+
+#include <QVector>
+
+class CASheet;
+
+class CATempoMap {
+public:
+    CATempoMap();
+
+    void clear();
+    void rebuild(CASheet* sheet);
+    void addTempo(int time, int bpm, int beatLength);
+    void addRitardando(int time, int timeLength, int finalBpm);
+
+    inline int changeCount() { return _segments.size(); }
+
+    double timeToMs(int time);
+    int msToTime(double ms);
+    double tempoAt(int time);
+
+    static const int DEFAULT_BPM; // quarters per minute without any tempo marks
+
+private:
+    // Part of the time axis with linearly changing tempo
+    struct CATempoSegment {
+        int time; // start in Canorus time
+        double ms; // start in miliseconds
+        double rate; // Canorus time per milisecond at the start
+        double slope; // change of the rate per Canorus time
+    };
+
+    void addSegment(int time, double rate, double slope);
+    int segmentAt(int time);
+    double rateAt(int time);
+    static double duration(const CATempoSegment& s, int length);
+
+    QVector<CATempoSegment> _segments; // increasing time, first one starts at 0
+    int _beatLength; // beat of the last added tempo, used for ritardandos
+};
+
+#endif /* TEMPOMAP_H_ */
@@ -174,6 +174,7 @@ void CATuplet::assignNoteSlurs(QList<QList<CASlur*>> noteSlurs)
 void CATuplet::assignTimes()
 {
     resetTimes();
+    noteList().front()->invalidateTempoMap();
 
     CAVoice* voice = noteList().front()->voice();
     CAMusElement* next = nullptr;
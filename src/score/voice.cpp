@@ -7,6 +7,7 @@
 
 #include "score/voice.h"
 #include "interface/mididevice.h"
+#include "score/chord.h"
 #include "score/clef.h"
 #include "score/keysignature.h"
 #include "score/lyricscontext.h"
@@ -15,6 +16,7 @@
 #include "score/note.h"
 #include "score/playable.h"
 #include "score/rest.h"
+#include "score/sheet.h"
 #include "score/slur.h"
 #include "score/staff.h"
 #include "score/tempo.h"
@@ -34,7 +36,10 @@
 	Creates a new voice named \a name, in \a staff, \a voiceNumber and \a stemDirection of notes stems.
 	Voice number starts at 1.
 */
+QAtomicInt CAVoice::_lastRevision;
+
 CAVoice::CAVoice(const QString name, CAStaff* staff, CANote::CAStemDirection stemDirection)
+    : _revision(_lastRevision.fetchAndAddRelaxed(1) + 1)
 {
     _staff = staff;
     _name = name;
@@ -197,6 +202,93 @@ bool CAVoice::insert(CAMusElement* eltAfter, CAMusElement* elt, bool addToChord)
     return res;
 }
 
+/*!
+	Inserts the new elements \a elts before the given \a eltAfter in a single pass. If \a eltAfter
+	is null, the elements are appended.
+
+	The elements should be sorted as they appear in the voice and their timeStarts should be
+	relative to the insertion point. A note starting at the same time as the note before it is
+	added to that note's chord. Elements after the insertion point are shifted only once for the
+	total length of the inserted playables.
+
+	This is used when pasting from the clipboard, where inserting elements one by one would
+	search the voice and update the times for every element.
+
+	Returns True, if \a eltAfter was found and the elements were inserted; otherwise False.
+
+	\note Due to speed issues, voices are NOT synchronized. User should manually call
+	CAStaff::synchronizeVoices().
+
+	\sa insert(CAMusElement*, CAMusElement*, bool)
+*/
+bool CAVoice::insert(CAMusElement* eltAfter, const QList<CAMusElement*>& elts)
+{
+    if (eltAfter && eltAfter->musElementType() == CAMusElement::Note && static_cast<CANote*>(eltAfter)->getChord().size()) // if eltAfter is note, it should always be the FIRST note in the chord
+        eltAfter = static_cast<CANote*>(eltAfter)->getChord().front();
+
+    int idx = eltAfter ? _musElementList.indexOf(eltAfter) : _musElementList.size();
+    if (idx == -1)
+        return false;
+
+    int timeStart = eltAfter ? eltAfter->timeStart() : lastTimeEnd();
+    int length = 0;
+    bool clefInserted = false;
+
+    QList<CAMusElement*> list = _musElementList.mid(0, idx);
+    list.reserve(_musElementList.size() + elts.size());
+
+    CANote* prevNote = nullptr;
+    for (CAMusElement* elt : elts) {
+        elt->setTimeStart(timeStart + elt->timeStart());
+        CANote* note = (elt->musElementType() == CAMusElement::Note) ? static_cast<CANote*>(elt) : nullptr;
+
+        if (note && prevNote && prevNote->timeStart() == note->timeStart()) {
+            // add a note to chord, notes in a chord are sorted by pitch rising
+            CAChord* chord = prevNote->chord();
+            int i;
+            for (i = 0; i < chord->size() && chord->noteList()[i]->diatonicPitch().noteName() < note->diatonicPitch().noteName(); i++)
+                ;
+            list.insert(list.size() - chord->size() + i, note);
+            chord->_noteList.insert(i, note);
+            note->_chord = chord;
+            note->setPlayableLength(prevNote->playableLength());
+            note->setTimeLength(prevNote->timeLength());
+            note->setStemDirection(prevNote->stemDirection());
+        } else {
+            list << elt;
+            if (note)
+                note->_chord = new CAChord(note);
+            if (elt->isPlayable())
+                length = qMax(length, elt->timeEnd() - timeStart);
+            else if (elt->musElementType() == CAMusElement::Clef)
+                clefInserted = true;
+        }
+        prevNote = note;
+
+        for (int j = 0; j < elt->markList().size(); j++)
+            elt->markList()[j]->setTimeStart(elt->timeStart());
+    }
+
+    list += _musElementList.mid(idx);
+    _musElementList = list;
+    updateTimes(idx + elts.size(), length, true);
+
+    for (CAMusElement* elt : elts) {
+        if (!elt->isPlayable())
+            addStaffRef(elt);
+    }
+
+    // calculate note positions in staff when inserting a new clef
+    if (clefInserted) {
+        for (int i = idx; i < musElementList().size(); i++) {
+            if (musElementList()[i]->musElementType() == CAMusElement::Note)
+                static_cast<CANote*>(musElementList()[i])->setDiatonicPitch(static_cast<CANote*>(musElementList()[i])->diatonicPitch());
+        }
+    }
+
+    return true;
+}
+
 /*!
 	Inserts a note/rest in a tuplet/voice. If the result should not be a chord the element
 	found will be deleted and replaced. This function probably should also work for non
@@ -315,6 +407,7 @@ CAKeySignature* CAVoice::getKeySig(CAMusElement* elt)
 bool CAVoice::remove(CAMusElement* elt, bool updateSigns)
 {
     if (_musElementList.contains(elt)) { // if the search element is found
+        changed();
         if (!elt->isPlayable() && staff()) { // element is shared - remove it from all the voices
             for (int i = 0; i < staff()->voiceList().size(); i++) {
                 staff()->voiceList()[i]->_musElementList.removeAll(elt);
@@ -367,6 +460,9 @@ bool CAVoice::remove(CAMusElement* elt, bool updateSigns)
                 updateTimes(musElementList().indexOf(elt) + 1, elt->timeLength() * (-1), updateSigns); // shift back timeStarts of playable elements after it
             }
 
+            if (elt->musElementType() == CAMusElement::Note) {
+                removeNoteFromChord(static_cast<CANote*>(elt));
+            }
             _musElementList.removeAll(elt); // removes the element from the voice music element list
         }
 
@@ -401,7 +497,24 @@ bool CAVoice::insertMusElement(CAMusElement* eltAfter, CAMusElement* elt)
         // eltBefore found, insert it
         _musElementList.insert(i, elt);
     }
+    changed();
+
+    if (elt->musElementType() == CAMusElement::Note) {
+        static_cast<CANote*>(elt)->_chord = new CAChord(static_cast<CANote*>(elt));
+    }
 
+    addStaffRef(elt);
+
+    return true;
+}
+
+/*!
+	Adds the newly inserted sign \a elt to the staff references of its type, if any.
+
+	\sa CAStaff::keySignatureRefs()
+*/
+void CAVoice::addStaffRef(CAMusElement* elt)
+{
     CAMusElement* next = nextByType(elt->musElementType(), elt);
     QList<CAMusElement*>* refs = nullptr;
 
@@ -419,24 +532,21 @@ bool CAVoice::insertMusElement(CAMusElement* eltAfter, CAMusElement* elt)
     if (refs) {
         int idxInRefs = refs->indexOf(next);
         if (idxInRefs == -1) {
-            // we want to append the element
-            idxInRefs = refs->size();
+            // last sign of its type in this voice, other voices may already have later ones
+            idxInRefs = CAStaff::refsUpperBound(*refs, elt->timeStart());
         }
 
         if (!refs->contains(elt)) {
             refs->insert(idxInRefs, elt);
         }
     }
-
-    return true;
 }
 
 /*!
 	Adds a \a note to an already existing \a referenceNote chord or a single note and
 	creates a chord out of it.
 	Notes in a chord always need to be sorted by pitch rising.
-	Chord in Canorus isn't its own structure but simply a list of notes sharing the
-	same start time.
+	The \a note joins the CAChord of the \a referenceNote.
 
 	The inserted \a note properteis timeStart, timeLength, dotted and playableLength
 	change according to other notes in the chord.
@@ -452,14 +562,16 @@ bool CAVoice::addNoteToChord(CANote* note, CANote* referenceNote)
     if (idx == -1)
         return false;
 
-    QList<CANote*> chord = referenceNote->getChord();
-    idx = _musElementList.indexOf(chord.first());
+    CAChord* chord = referenceNote->chord();
+    idx = _musElementList.indexOf(chord->first());
 
     int i;
-    for (i = 0; i < chord.size() && chord[i]->diatonicPitch().noteName() < note->diatonicPitch().noteName(); i++)
+    for (i = 0; i < chord->size() && chord->noteList()[i]->diatonicPitch().noteName() < note->diatonicPitch().noteName(); i++)
         ;
 
     _musElementList.insert(idx + i, note);
+    chord->_noteList.insert(i, note);
+    note->_chord = chord;
     note->setPlayableLength(referenceNote->playableLength());
     note->setTimeLength(referenceNote->timeLength());
     note->setTimeStart(referenceNote->timeStart());
@@ -468,6 +580,23 @@ bool CAVoice::addNoteToChord(CANote* note, CANote* referenceNote)
     return true;
 }
 
+/*!
+	Removes the \a note from its chord. The chord is destroyed when its last note is removed.
+*/
+void CAVoice::removeNoteFromChord(CANote* note)
+{
+    CAChord* chord = note->_chord;
+    if (!chord) {
+        return;
+    }
+
+    chord->_noteList.removeOne(note);
+    if (!chord->size()) {
+        delete chord;
+    }
+    note->_chord = nullptr;
+}
+
 /*!
 	Returns the pitch of the last note in the voice (default) or of the first note in
 	the last chord, if \a inChord is true.
@@ -939,6 +1068,7 @@ CAPlayable* CAVoice::previousPlayable(int timeStart)
 */
 bool CAVoice::updateTimes(int idx, int length, bool signsToo)
 {
+    changed();
     for (int i = idx; i < musElementList().size(); i++)
         if (signsToo || musElementList()[i]->isPlayable()) {
             musElementList()[i]->setTimeStart(musElementList()[i]->timeStart() + length);
@@ -951,6 +1081,24 @@ bool CAVoice::updateTimes(int idx, int length, bool signsToo)
     return true; // What to return ? Maybe if some music element times were actually set
 }
 
+/*!
+	Called when the elements of the voice and their marks were inserted, removed or moved
+	in time. Gives the voice a new revision() and marks the tempo map of the sheet out of
+	date.
+
+	Revisions are unique among all voices, so a new voice never gets the revision of a
+	deleted one.
+
+	\sa CASheet::tempoMap(), CANoteChecker
+*/
+void CAVoice::changed()
+{
+    _revision = _lastRevision.fetchAndAddRelaxed(1) + 1;
+    if (staff() && staff()->sheet()) {
+        staff()->sheet()->invalidateTempoMap();
+    }
+}
+
 /*!
 	Fixes any inconsistencies between music elements:
 	1) If a common (shared) mark is present only in non-first note of the chord, it's moved and assigned
@@ -1062,20 +1210,9 @@ CATempo* CAVoice::getTempo(int time)
 */
 QList<CAMusElement*> CAVoice::getKeySignature(int startTime)
 {
-
-    QList<CAMusElement*> eltList;
-    int i;
-    // seek to the start of the music elements with the given time
-    for (i = 0; i < staff()->keySignatureRefs().size() && staff()->keySignatureRefs()[i]->timeStart() < startTime; i++)
-        ;
-
-    // create a list of music elements with the given time
-    while (i < staff()->keySignatureRefs().size() && staff()->keySignatureRefs()[i]->timeStart() == startTime) {
-        eltList << staff()->keySignatureRefs()[i];
-        i++;
-    }
-
-    return eltList;
+    QList<CAMusElement*>& refs = staff()->keySignatureRefs();
+    int i = CAStaff::refsLowerBound(refs, startTime);
+    return refs.mid(i, CAStaff::refsUpperBound(refs, startTime) - i);
 }
 
 /*!
@@ -1085,20 +1222,9 @@ QList<CAMusElement*> CAVoice::getKeySignature(int startTime)
 */
 QList<CAMusElement*> CAVoice::getTimeSignature(int startTime)
 {
-
-    QList<CAMusElement*> eltList;
-    int i;
-    // seek to the start of the music elements with the given time
-    for (i = 0; i < staff()->timeSignatureRefs().size() && staff()->timeSignatureRefs()[i]->timeStart() < startTime; i++)
-        ;
-
-    // create a list of music elements with the given time
-    while (i < staff()->timeSignatureRefs().size() && staff()->timeSignatureRefs()[i]->timeStart() == startTime) {
-        eltList << staff()->timeSignatureRefs()[i];
-        i++;
-    }
-
-    return eltList;
+    QList<CAMusElement*>& refs = staff()->timeSignatureRefs();
+    int i = CAStaff::refsLowerBound(refs, startTime);
+    return refs.mid(i, CAStaff::refsUpperBound(refs, startTime) - i);
 }
 
 /*!
@@ -1108,89 +1234,78 @@ QList<CAMusElement*> CAVoice::getTimeSignature(int startTime)
 */
 QList<CAMusElement*> CAVoice::getClef(int startTime)
 {
-
-    QList<CAMusElement*> eltList;
-    int i;
-    // seek to the start of the music elements with the given time
-    for (i = 0; i < staff()->clefRefs().size() && staff()->clefRefs()[i]->timeStart() < startTime; i++)
-        ;
-
-    // create a list of music elements with the given time
-    while (i < staff()->clefRefs().size() && staff()->clefRefs()[i]->timeStart() == startTime) {
-        eltList << staff()->clefRefs()[i];
-        i++;
-    }
-
-    return eltList;
+    QList<CAMusElement*>& refs = staff()->clefRefs();
+    int i = CAStaff::refsLowerBound(refs, startTime);
+    return refs.mid(i, CAStaff::refsUpperBound(refs, startTime) - i);
 }
 
 /*!
 	Returns a list of pointers to key signatures which are at or left (not past)
 	the given \a startTime.
 	This is useful for querying for eg. which key signature is in effect before a certain
-	point in time.
+	point in time. The list is copied, use keySignatureAt() to get the one in effect.
 */
 QList<CAMusElement*> CAVoice::getPreviousKeySignature(int startTime)
 {
-
-    QList<CAMusElement*> eltList;
-    int i;
-    // seek to the most right of the music elements with the given time
-    for (i = staff()->keySignatureRefs().size() - 1;
-         i >= 0 && staff()->keySignatureRefs()[i]->timeStart() > startTime; i--)
-        ;
-    // create a list of music elements not past the given time
-    while (i >= 0 && staff()->keySignatureRefs()[i]->timeStart() <= startTime) {
-        eltList.prepend(staff()->keySignatureRefs()[i]);
-        i--;
-    }
-    return eltList;
+    QList<CAMusElement*>& refs = staff()->keySignatureRefs();
+    return refs.mid(0, CAStaff::refsUpperBound(refs, startTime));
 }
 
 /*!
-	Returns a list of pointers to key signatures which are at or left (not past)
+	Returns a list of pointers to time signatures which are at or left (not past)
 	the given \a startTime.
-	This is useful for querying for eg. which key signature is in effect before a certain
-	point in time.
+	This is useful for querying for eg. which time signature is in effect before a certain
+	point in time. The list is copied, use timeSignatureAt() to get the one in effect.
 */
 QList<CAMusElement*> CAVoice::getPreviousTimeSignature(int startTime)
 {
-
-    QList<CAMusElement*> eltList;
-    int i;
-    // seek to the most right of the music elements with the given time
-    for (i = staff()->timeSignatureRefs().size() - 1;
-         i >= 0 && staff()->timeSignatureRefs()[i]->timeStart() > startTime; i--)
-        ;
-    // create a list of music elements not past the given time
-    while (i >= 0 && staff()->timeSignatureRefs()[i]->timeStart() <= startTime) {
-        eltList.prepend(staff()->timeSignatureRefs()[i]);
-        i--;
-    }
-    return eltList;
+    QList<CAMusElement*>& refs = staff()->timeSignatureRefs();
+    return refs.mid(0, CAStaff::refsUpperBound(refs, startTime));
 }
 
 /*!
 	Returns a list of pointers to clefs which are at or left (not past)
 	the given \a startTime.
 	This is useful for querying for eg. which clef is in effect before a certain
-	point in time.
+	point in time. The list is copied, use clefAt() to get the one in effect.
 */
 QList<CAMusElement*> CAVoice::getPreviousClef(int startTime)
 {
+    QList<CAMusElement*>& refs = staff()->clefRefs();
+    return refs.mid(0, CAStaff::refsUpperBound(refs, startTime));
+}
 
-    QList<CAMusElement*> eltList;
-    int i;
-    // seek to the most right of the music elements with the given time
-    for (i = staff()->clefRefs().size() - 1;
-         i >= 0 && staff()->clefRefs()[i]->timeStart() > startTime; i--)
-        ;
-    // create a list of music elements not past the given time
-    while (i >= 0 && staff()->clefRefs()[i]->timeStart() <= startTime) {
-        eltList.prepend(staff()->clefRefs()[i]);
-        i--;
-    }
-    return eltList;
+/*!
+	Returns the clef in effect at the given \a time or Null, if no clef is placed before.
+	Uses binary search in the staff's references.
+
+	\sa CAStaff::clefAt()
+*/
+CAClef* CAVoice::clefAt(int time)
+{
+    return (staff() ? staff()->clefAt(time) : nullptr);
+}
+
+/*!
+	Returns the key signature in effect at the given \a time or Null, if no key signature
+	is placed before. Uses binary search in the staff's references.
+
+	\sa CAStaff::keySignatureAt()
+*/
+CAKeySignature* CAVoice::keySignatureAt(int time)
+{
+    return (staff() ? staff()->keySignatureAt(time) : nullptr);
+}
+
+/*!
+	Returns the time signature in effect at the given \a time or Null, if no time signature
+	is placed before. Uses binary search in the staff's references.
+
+	\sa CAStaff::timeSignatureAt()
+*/
+CATimeSignature* CAVoice::timeSignatureAt(int time)
+{
+    return (staff() ? staff()->timeSignatureAt(time) : nullptr);
 }
 
 /*!
@@ -1213,6 +1328,14 @@ QList<CAMusElement*> CAVoice::getPreviousClef(int startTime)
 	\sa staff()
 */
 
+/*!
+	\fn CAVoice::revision()
+	Returns the revision of the voice contents. It changes whenever the music elements
+	are inserted, removed or moved in time.
+
+	\sa CANoteChecker
+*/
+
 /*!
 	\fn CAVoice::voiceNumber()
 	Voice number in the staff starting at 1.
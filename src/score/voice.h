@@ -8,6 +8,7 @@
 #ifndef VOICE_H_
 #define VOICE_H_
 
+#include <QAtomicInt>
 #include <QList> // music elements container
 
 #include "score/muselement.h"
@@ -28,6 +29,7 @@ public:
     ~CAVoice();
     inline CAStaff* staff() { return _staff; }
     inline void setStaff(CAStaff* staff) { _staff = staff; }
+    inline unsigned int revision() { return _revision; }
     void clear();
     CAVoice* clone(CAStaff* newStaff = nullptr);
     void cloneVoiceProperties(CAVoice* v);
@@ -37,6 +39,7 @@ public:
     /////////////////////////////////////////
     void append(CAMusElement* elt, bool addToChord = false);
     bool insert(CAMusElement* eltAfter, CAMusElement* elt, bool addToChord = false);
+    bool insert(CAMusElement* eltAfter, const QList<CAMusElement*>& elts);
     bool remove(CAMusElement* elt, bool updateSignsTimes = true);
     CAPlayable* insertInTupletAndVoiceAt(CAPlayable* p, CAPlayable* n);
     bool synchronizeMusElements();
@@ -88,6 +91,9 @@ public:
     QList<CAMusElement*> getPreviousKeySignature(int startTime);
     QList<CAMusElement*> getPreviousTimeSignature(int startTime);
     QList<CAMusElement*> getPreviousClef(int startTime);
+    CAClef* clefAt(int time);
+    CAKeySignature* keySignatureAt(int time);
+    CATimeSignature* timeSignatureAt(int time);
 
     ////////////////
     // Properties //
@@ -118,12 +124,17 @@ public:
 
 private:
     bool addNoteToChord(CANote* note, CANote* referenceNote);
+    void removeNoteFromChord(CANote* note);
     bool insertMusElement(CAMusElement* before, CAMusElement* elt);
+    void addStaffRef(CAMusElement* elt);
     bool updateTimes(int idx, int length, bool signsToo = false);
+    void changed();
 
     // list of all the music elements
     QList<CAMusElement*> _musElementList;
     CAStaff* _staff; // parent staff
+    unsigned int _revision; // changed when elements are inserted, removed or moved, unique among voices
+    static QAtomicInt _lastRevision;
 
     CANote::CAStemDirection _stemDirection;
     QList<CALyricsContext*> _lyricsContextList;
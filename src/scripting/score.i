@@ -8,6 +8,7 @@
 %{
 #include "score/document.h"
 #include "score/sheet.h"
+#include "score/tempomap.h"
 
 #include "score/context.h"
 #include "score/staff.h"
@@ -41,6 +42,7 @@
 %}
 
 %include "score/document.h"
+%include "score/tempomap.h"
 %include "score/sheet.h"
 
 %include "score/context.h"
@@ -0,0 +1,168 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#include <QBuffer>
+#include <QtTest>
+
+#include <memory>
+#include <zlib.h>
+
+#include "core/archive.h"
+#include "export/canexport.h"
+#include "import/canimport.h"
+#include "score/document.h"
+
+/*!
+	\class CAArchiveBenchmark
+	\brief Save-time benchmark of the .can archive
+
+	Measures a complete CACanExport of the shipped examples with the default
+	settings, and the compression step alone on a larger synthetic archive with
+	serial and parallel compression. Run with -iterations to get stable numbers.
+
+	The compressed archive is inflated by zlib as by any gzip reader and compared with
+	the uncompressed tar byte for byte, so the header, the comment, the trailer with the
+	combined checksum and the final block of the parallel compression are checked too.
+*/
+class CAArchiveBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void saveDocument_data();
+    void saveDocument();
+    void writeArchive_data();
+    void writeArchive();
+
+private:
+    static QByteArray gunzip(const QByteArray& data, QByteArray& comment);
+};
+
+// Gives the test the uncompressed tar of the archive
+class CATarArchive : public CAArchive {
+public:
+    QByteArray tar()
+    {
+        QBuffer tar;
+        _tar->open(tar);
+        _tar->write(tar);
+        _tar->close(tar);
+        return tar.data();
+    }
+};
+
+void CAArchiveBenchmark::saveDocument_data()
+{
+    QTest::addColumn<QString>("fileName");
+
+    for (const QString& example : { QString("all features test.can"), QString("come_again.can"), QString("jingle bells.can") })
+        QTest::newRow(qPrintable(example)) << example;
+}
+
+void CAArchiveBenchmark::saveDocument()
+{
+    QFETCH(QString, fileName);
+
+    CACanImport import;
+    import.setStreamFromFile(QString(CANORUS_EXAMPLES_DIR) + "/" + fileName);
+    import.importDocument(false);
+    std::unique_ptr<CADocument> doc(import.importedDocument());
+    QVERIFY(import.status() == 0 && doc);
+
+    QBuffer out;
+    QBENCHMARK
+    {
+        out.setData(QByteArray());
+        out.open(QIODevice::WriteOnly);
+        CACanExport exp;
+        exp.setStreamToDevice(&out);
+        exp.exportDocument(doc.get(), false);
+        out.close();
+        QCOMPARE(exp.status(), 0);
+    }
+}
+
+void CAArchiveBenchmark::writeArchive_data()
+{
+    QTest::addColumn<int>("level");
+    QTest::addColumn<bool>("parallel");
+
+    for (int level : { 1, 6, 9 }) {
+        QTest::newRow(qPrintable(QString("level %1, serial").arg(level))) << level << false;
+        QTest::newRow(qPrintable(QString("level %1, parallel").arg(level))) << level << true;
+    }
+}
+
+void CAArchiveBenchmark::writeArchive()
+{
+    QFETCH(int, level);
+    QFETCH(bool, parallel);
+
+    // A CanorusML-like payload of a few MB, large enough to be split into many blocks.
+    QByteArray score;
+    for (int i = 0; score.size() < 8 * 1024 * 1024; i++)
+        score += QString("<note pitch=\"%1\" accs=\"0\" playable-length=\"%2\" dotted=\"0\" time-start=\"%3\"/>\n")
+                     .arg(i % 56)
+                     .arg(1 << (i % 5))
+                     .arg(i * 256)
+                     .toLatin1();
+
+    CATarArchive archive;
+    archive.addFile("content.xml", score);
+    archive.setCompressionLevel(level);
+    archive.setParallelCompression(parallel);
+
+    QBuffer out;
+    QBENCHMARK
+    {
+        out.setData(QByteArray());
+        QVERIFY(archive.write(out) > 0);
+    }
+    QVERIFY(!archive.error());
+
+    QByteArray comment;
+    QByteArray tar = gunzip(out.data(), comment);
+    QVERIFY(comment.startsWith("Canorus Archive v"));
+    QCOMPARE(tar.size(), archive.tar().size());
+    QVERIFY(tar == archive.tar());
+}
+
+/*!
+	Inflates the gzip file \a data and returns its content or an empty array on an
+	error. The gzip comment is stored in \a comment.
+*/
+QByteArray CAArchiveBenchmark::gunzip(const QByteArray& data, QByteArray& comment)
+{
+    z_stream strm = z_stream();
+    gz_header header = gz_header();
+    char commentBuffer[64] = {};
+    header.comment = reinterpret_cast<Bytef*>(commentBuffer);
+    header.comm_max = sizeof(commentBuffer) - 1;
+
+    if (inflateInit2(&strm, 31) != Z_OK || inflateGetHeader(&strm, &header) != Z_OK)
+        return QByteArray();
+
+    QByteArray result;
+    char buffer[16384];
+    strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+    strm.avail_in = data.size();
+    int ret;
+    do {
+        strm.next_out = reinterpret_cast<Bytef*>(buffer);
+        strm.avail_out = sizeof(buffer);
+        ret = inflate(&strm, Z_NO_FLUSH); // checks the crc32 and the size in the trailer
+        result.append(buffer, sizeof(buffer) - strm.avail_out);
+    } while (ret == Z_OK);
+
+    // the last block must be final and no data may follow the trailer
+    const bool ok = ret == Z_STREAM_END && !strm.avail_in && header.done == 1;
+    inflateEnd(&strm);
+    comment = commentBuffer;
+    return ok ? result : QByteArray();
+}
+
+QTEST_GUILESS_MAIN(CAArchiveBenchmark)
+#include "archivebenchmark.moc"
@@ -0,0 +1,90 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#include <QtTest>
+
+#include "core/slotpool.h"
+#include "score/document.h"
+#include "score/note.h"
+#include "score/sheet.h"
+#include "score/staff.h"
+#include "score/voice.h"
+
+/*!
+	\class CAElementPoolBenchmark
+	\brief Memory and time benchmark of the music element pool
+
+	Measures the memory the pool takes per note of a large voice, the time to create
+	and delete the notes of a voice, and checks the blocks are released when the
+	document is closed.
+*/
+class CAElementPoolBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void memoryPerNote();
+    void createNotes();
+    void releaseBlocks();
+
+private:
+    static void fillVoice(CAVoice* voice, int notes);
+
+    static const int NOTES = 100000;
+};
+
+void CAElementPoolBenchmark::fillVoice(CAVoice* voice, int notes)
+{
+    for (int i = 0; i < notes; i++)
+        voice->append(new CANote(CADiatonicPitch(28 + i % 7), CAPlayableLength(CAPlayableLength::Quarter), voice, 0));
+}
+
+void CAElementPoolBenchmark::memoryPerNote()
+{
+    CASlotPool* pool = CAMusElement::pool();
+    const size_t chunks = pool->allocatedChunks();
+    const size_t used = pool->usedBytes();
+
+    CADocument doc;
+    fillVoice(doc.addSheet()->addStaff()->voiceList().first(), NOTES);
+
+    const double reserved = double(pool->allocatedChunks() - chunks) * CASlotPool::CHUNK_SIZE / NOTES;
+    const double slot = double(pool->usedBytes() - used) / NOTES;
+    qInfo("sizeof(CANote) %d bytes, slot %.1f bytes, pool blocks %.1f bytes per note",
+        int(sizeof(CANote)), slot, reserved);
+    QTest::setBenchmarkResult(reserved, QTest::BytesAllocated);
+
+    // notes fill whole slots without a per-allocation header, blocks are nearly full
+    QVERIFY(slot >= sizeof(CANote) && slot < sizeof(CANote) + CASlotPool::SLOT_ALIGN);
+    QVERIFY(reserved < slot * 1.05);
+}
+
+void CAElementPoolBenchmark::createNotes()
+{
+    QBENCHMARK
+    {
+        CADocument doc;
+        fillVoice(doc.addSheet()->addStaff()->voiceList().first(), 10000);
+    }
+}
+
+void CAElementPoolBenchmark::releaseBlocks()
+{
+    CASlotPool* pool = CAMusElement::pool();
+    const size_t chunks = pool->allocatedChunks();
+    const size_t used = pool->usedBytes();
+
+    CADocument* doc = new CADocument();
+    fillVoice(doc->addSheet()->addStaff()->voiceList().first(), NOTES);
+    QVERIFY(pool->allocatedChunks() > chunks + 10);
+
+    delete doc;
+    QCOMPARE(pool->usedBytes(), used);
+    QVERIFY(pool->allocatedChunks() <= chunks + 1); // a single empty block is kept for the next notes
+}
+
+QTEST_GUILESS_MAIN(CAElementPoolBenchmark)
+#include "elementpoolbenchmark.moc"
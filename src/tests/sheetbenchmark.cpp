@@ -0,0 +1,151 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#include <QtTest>
+
+#include <thread>
+#include <vector>
+
+#include "score/document.h"
+#include "score/note.h"
+#include "score/sheet.h"
+#include "score/staff.h"
+#include "score/tempo.h"
+#include "score/voice.h"
+
+/*!
+	\class CASheetBenchmark
+	\brief Benchmark of the cached staff and voice lists of CASheet
+
+	Compares reading the cached CASheet::voiceList() with regenerating it after every
+	change of the sheet, also through CASheet::getTempo() as called by the playback on
+	a 40-staff sheet, and checks the lists are regenerated once when read from several
+	threads at the same time.
+*/
+class CASheetBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void voiceList_data();
+    void voiceList();
+    void getTempo_data();
+    void getTempo();
+    void concurrentVoiceList();
+
+private:
+    static CASheet* createSheet(CADocument* doc, int staffs, int voices);
+};
+
+CASheet* CASheetBenchmark::createSheet(CADocument* doc, int staffs, int voices)
+{
+    CASheet* sheet = doc->addSheet();
+    for (int i = 0; i < staffs; i++) {
+        CAStaff* staff = sheet->addStaff();
+        for (int j = 1; j < voices; j++)
+            staff->addVoice();
+    }
+
+    return sheet;
+}
+
+void CASheetBenchmark::voiceList_data()
+{
+    QTest::addColumn<int>("staffs");
+    QTest::addColumn<bool>("cached");
+
+    for (int staffs : { 4, 16, 64 }) {
+        QTest::newRow(qPrintable(QString("%1 staffs, cached").arg(staffs))) << staffs << true;
+        QTest::newRow(qPrintable(QString("%1 staffs, regenerated").arg(staffs))) << staffs << false;
+    }
+}
+
+void CASheetBenchmark::voiceList()
+{
+    QFETCH(int, staffs);
+    QFETCH(bool, cached);
+
+    CADocument doc;
+    CASheet* sheet = createSheet(&doc, staffs, 2);
+
+    int voices = 0;
+    QBENCHMARK
+    {
+        // the layout engine, playback and note checker read the list once per element
+        for (int i = 0; i < 1000; i++) {
+            if (!cached)
+                sheet->invalidateStaffList();
+            voices += sheet->voiceList().size();
+        }
+    }
+    QVERIFY(voices > 0);
+    QCOMPARE(sheet->voiceList().size(), staffs * 2);
+}
+
+void CASheetBenchmark::getTempo_data()
+{
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("40 staffs, cached") << true;
+    QTest::newRow("40 staffs, regenerated") << false;
+}
+
+void CASheetBenchmark::getTempo()
+{
+    QFETCH(bool, cached);
+
+    CADocument doc;
+    CASheet* sheet = createSheet(&doc, 40, 2);
+
+    // bars of quarter notes in every voice, a new tempo every four bars in the first one
+    const int notes = 256;
+    for (CAVoice* voice : sheet->voiceList()) {
+        for (int i = 0; i < notes; i++) {
+            CANote* note = new CANote(CADiatonicPitch(28 + i % 7), CAPlayableLength(CAPlayableLength::Quarter), voice, 0);
+            voice->append(note);
+            if (voice == sheet->voiceList().first() && !(i % 16))
+                note->addMark(new CATempo(CAPlayableLength(CAPlayableLength::Quarter), 60 + i / 16, note));
+        }
+    }
+
+    const int timeEnd = sheet->voiceList().first()->lastTimeEnd();
+    int bpm = 0;
+    QBENCHMARK
+    {
+        // the playback looks up the tempo at every chord it plays
+        for (int time = 0; time < timeEnd; time += timeEnd / notes) {
+            if (!cached)
+                sheet->invalidateStaffList();
+            CATempo* tempo = sheet->getTempo(time);
+            bpm += tempo ? tempo->bpm() : 0;
+        }
+    }
+    QVERIFY(bpm > 0);
+    QCOMPARE(int(sheet->getTempo(timeEnd - 1)->bpm()), 60 + (notes - 1) / 16);
+}
+
+void CASheetBenchmark::concurrentVoiceList()
+{
+    CADocument doc;
+    CASheet* sheet = createSheet(&doc, 32, 3);
+
+    for (int round = 0; round < 100; round++) {
+        sheet->invalidateStaffList();
+
+        std::vector<int> sizes(4);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < sizes.size(); t++)
+            threads.emplace_back([sheet, &sizes, t]() { sizes[t] = sheet->voiceList().size() + sheet->staffList().size(); });
+        for (std::thread& thread : threads)
+            thread.join();
+
+        for (int size : sizes)
+            QCOMPARE(size, 32 * 3 + 32);
+    }
+}
+
+QTEST_GUILESS_MAIN(CASheetBenchmark)
+#include "sheetbenchmark.moc"
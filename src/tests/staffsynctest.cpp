@@ -0,0 +1,181 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#include <QtTest>
+
+#include "score/barline.h"
+#include "score/clef.h"
+#include "score/document.h"
+#include "score/keysignature.h"
+#include "score/note.h"
+#include "score/rest.h"
+#include "score/sheet.h"
+#include "score/staff.h"
+#include "score/timesignature.h"
+#include "score/voice.h"
+
+/*!
+	\class CAStaffSyncTest
+	\brief Test of the ranged CAStaff::synchronizeVoices()
+
+	Inserts a clef or a barline in the middle of a staff with two voices and compares
+	the voices and the references lists after synchronizeVoices(timeStart, timeEnd)
+	with a full synchronizeVoices() of an identical staff, once with the sign aligned
+	in both voices and once overlapping a note of the other voice, so rests are inserted.
+*/
+class CAStaffSyncTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void synchronizeVoices_data();
+    void synchronizeVoices();
+
+private:
+    static CAStaff* createStaff(CASheet* sheet);
+    static CAMusElement* insertSign(CAStaff* staff, const QString& sign, int voice, int playable);
+    static QStringList describe(CAStaff* staff);
+    static int restCount(CAStaff* staff);
+
+    static const int BARS = 10;
+};
+
+/*!
+	Creates a staff of BARS bars with quarter notes in the first voice and half notes
+	in the second one, synchronized by a full synchronizeVoices().
+*/
+CAStaff* CAStaffSyncTest::createStaff(CASheet* sheet)
+{
+    CAStaff* staff = sheet->addStaff();
+    CAVoice* upper = staff->voiceList().first();
+    CAVoice* lower = staff->addVoice();
+
+    upper->append(new CAClef(CAClef::Treble, staff, 0));
+    upper->append(new CAKeySignature(CADiatonicKey(0, CADiatonicKey::Major), staff, 0));
+    upper->append(new CATimeSignature(4, 4, staff, 0));
+    for (int bar = 0; bar < BARS; bar++) {
+        for (int i = 0; i < 4; i++)
+            upper->append(new CANote(CADiatonicPitch(30 + i), CAPlayableLength(CAPlayableLength::Quarter), upper, 0));
+        for (int i = 0; i < 2; i++)
+            lower->append(new CANote(CADiatonicPitch(23 + i), CAPlayableLength(CAPlayableLength::Half), lower, 0));
+        upper->append(new CABarline(CABarline::Single, staff, 0));
+    }
+    staff->synchronizeVoices();
+
+    return staff;
+}
+
+/*!
+	Inserts a new \a sign ("clef" or "barline") in the given \a voice of the \a staff
+	before its playable element with the index \a playable, as CAMainWin does.
+*/
+CAMusElement* CAStaffSyncTest::insertSign(CAStaff* staff, const QString& sign, int voice, int playable)
+{
+    CAVoice* v = staff->voiceList()[voice];
+    CAMusElement* right = nullptr;
+    for (int i = 0, p = 0; i < v->musElementList().size() && !right; i++) {
+        if (v->musElementList()[i]->isPlayable() && p++ == playable)
+            right = v->musElementList()[i];
+    }
+
+    CAMusElement* elt;
+    if (sign == "clef")
+        elt = new CAClef(CAClef::Bass, staff, 0);
+    else
+        elt = new CABarline(CABarline::Single, staff, 0);
+    v->insert(right, elt);
+
+    return elt;
+}
+
+/*!
+	Returns the types and times of the elements of each voice and of the references
+	lists of the \a staff.
+*/
+QStringList CAStaffSyncTest::describe(CAStaff* staff)
+{
+    QStringList description;
+    for (CAVoice* voice : staff->voiceList()) {
+        QString line;
+        for (CAMusElement* elt : voice->musElementList())
+            line += QString("%1@%2+%3 ").arg(elt->musElementType()).arg(elt->timeStart()).arg(elt->timeLength());
+        description << line;
+    }
+
+    for (QList<CAMusElement*>* refs : { &staff->clefRefs(), &staff->keySignatureRefs(), &staff->timeSignatureRefs(), &staff->barlineRefs() }) {
+        QString line;
+        for (CAMusElement* elt : *refs)
+            line += QString("%1@%2 ").arg(elt->musElementType()).arg(elt->timeStart());
+        description << line;
+    }
+
+    return description;
+}
+
+int CAStaffSyncTest::restCount(CAStaff* staff)
+{
+    int rests = 0;
+    for (CAVoice* voice : staff->voiceList()) {
+        for (CAMusElement* elt : voice->musElementList())
+            rests += (elt->musElementType() == CAMusElement::Rest);
+    }
+
+    return rests;
+}
+
+void CAStaffSyncTest::synchronizeVoices_data()
+{
+    QTest::addColumn<QString>("sign");
+    QTest::addColumn<int>("voice");
+    QTest::addColumn<int>("playable");
+    QTest::addColumn<bool>("rests");
+
+    // bar 5: the third quarter starts with the second half note, the second one in the middle of the first
+    QTest::newRow("clef, aligned") << QString("clef") << 0 << 4 * 4 + 2 << false;
+    QTest::newRow("clef, rests inserted") << QString("clef") << 0 << 4 * 4 + 1 << true;
+    QTest::newRow("clef in the second voice") << QString("clef") << 1 << 4 * 2 + 1 << false;
+    QTest::newRow("barline, aligned") << QString("barline") << 0 << 4 * 4 + 2 << false;
+    QTest::newRow("barline, rests inserted") << QString("barline") << 0 << 4 * 4 + 1 << true;
+    QTest::newRow("barline in the second voice") << QString("barline") << 1 << 4 * 2 + 1 << false;
+}
+
+void CAStaffSyncTest::synchronizeVoices()
+{
+    QFETCH(QString, sign);
+    QFETCH(int, voice);
+    QFETCH(int, playable);
+    QFETCH(bool, rests);
+
+    CADocument doc;
+    CASheet* sheet = doc.addSheet();
+    CAStaff* ranged = createStaff(sheet);
+    CAStaff* full = createStaff(sheet);
+    QCOMPARE(describe(ranged), describe(full));
+    QCOMPARE(restCount(ranged), 0);
+
+    CAMusElement* rangedSign = insertSign(ranged, sign, voice, playable);
+    insertSign(full, sign, voice, playable);
+
+    bool rangedChanges = ranged->synchronizeVoices(rangedSign->timeStart(), rangedSign->timeStart());
+    bool fullChanges = full->synchronizeVoices();
+    QCOMPARE(rangedChanges, fullChanges);
+    QCOMPARE(restCount(ranged) > 0, rests);
+    QCOMPARE(describe(ranged), describe(full));
+
+    // the patched references point to the signs shared by the voices, in time order
+    for (QList<CAMusElement*>* refs : { &ranged->clefRefs(), &ranged->keySignatureRefs(), &ranged->timeSignatureRefs(), &ranged->barlineRefs() }) {
+        for (int i = 0; i < refs->size(); i++) {
+            for (CAVoice* v : ranged->voiceList())
+                QVERIFY(v->musElementList().contains(refs->at(i)));
+            if (i)
+                QVERIFY(refs->at(i - 1)->timeStart() <= refs->at(i)->timeStart());
+        }
+    }
+    QVERIFY(ranged->barlineRefs().contains(rangedSign) || ranged->clefRefs().contains(rangedSign));
+}
+
+QTEST_GUILESS_MAIN(CAStaffSyncTest)
+#include "staffsynctest.moc"
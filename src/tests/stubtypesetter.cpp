@@ -0,0 +1,40 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+// Stand-in for LilyPond used by typesetservertest.
+// Reads the source from the standard input ("-") and writes it unchanged to the
+// file given by "-o" plus ".pdf" (or ".svg" with -dbackend=svg).
+// A source containing "crash" makes it abort, "fail" makes it exit with code 1.
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+int main(int argc, char* argv[])
+{
+    std::string output, suffix = ".pdf";
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-o") && i + 1 < argc)
+            output = argv[++i];
+        else if (!strcmp(argv[i], "-dbackend=svg"))
+            suffix = ".svg";
+    }
+
+    std::string source((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+    std::cout << "stubtypesetter: typesetting " << source.size() << " bytes" << std::endl;
+
+    if (source.find("crash") != std::string::npos)
+        abort();
+    if (source.find("fail") != std::string::npos || output.empty())
+        return 1;
+
+    std::ofstream(output + suffix, std::ios::binary) << source;
+    return 0;
+}
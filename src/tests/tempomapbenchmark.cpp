@@ -0,0 +1,124 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#include <QtTest>
+
+#include "score/document.h"
+#include "score/note.h"
+#include "score/sheet.h"
+#include "score/staff.h"
+#include "score/tempo.h"
+#include "score/tempomap.h"
+#include "score/voice.h"
+
+/*!
+	\class CATempoMapBenchmark
+	\brief Benchmark of the tempo lookups and test of the tempo map invalidation
+
+	Compares looking up the tempo by searching the tempo marks of all the voices with
+	CASheet::getTempo() and the binary search in CATempoMap::tempoAt(). Also checks the
+	map follows the tempo marks without laying out the sheet.
+*/
+class CATempoMapBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void getTempo_data();
+    void getTempo();
+    void mapFollowsTempoMarks();
+
+private:
+    CADocument* _doc;
+    CASheet* _sheet;
+    QList<CANote*> _notes;
+
+    static const int NOTES = 4096;
+};
+
+void CATempoMapBenchmark::init()
+{
+    _doc = new CADocument();
+    _sheet = _doc->addSheet();
+    _notes.clear();
+
+    // four staffs of quarter notes, a new tempo every four bars in the first one
+    for (int s = 0; s < 4; s++) {
+        CAVoice* voice = _sheet->addStaff()->voiceList().first();
+        for (int i = 0; i < NOTES; i++) {
+            CANote* note = new CANote(CADiatonicPitch(28 + i % 7), CAPlayableLength(CAPlayableLength::Quarter), voice, 0);
+            voice->append(note);
+            if (!s) {
+                _notes << note;
+                if (!(i % 16))
+                    note->addMark(new CATempo(CAPlayableLength(CAPlayableLength::Quarter), 60 + (i / 16) % 120, note));
+            }
+        }
+    }
+}
+
+void CATempoMapBenchmark::cleanup()
+{
+    delete _doc;
+}
+
+void CATempoMapBenchmark::getTempo_data()
+{
+    QTest::addColumn<bool>("tempoMap");
+
+    QTest::newRow("CASheet::getTempo()") << false;
+    QTest::newRow("CATempoMap::tempoAt()") << true;
+}
+
+void CATempoMapBenchmark::getTempo()
+{
+    QFETCH(bool, tempoMap);
+
+    const int timeEnd = _notes.last()->timeEnd();
+    double sum = 0;
+    QBENCHMARK
+    {
+        for (int time = 0; time < timeEnd; time += timeEnd / 1000) {
+            if (tempoMap) {
+                sum += _sheet->tempoMap()->tempoAt(time);
+            } else {
+                CATempo* tempo = _sheet->getTempo(time);
+                sum += (tempo ? tempo->bpm() : CATempoMap::DEFAULT_BPM);
+            }
+        }
+    }
+    QVERIFY(sum > 0);
+}
+
+void CATempoMapBenchmark::mapFollowsTempoMarks()
+{
+    CANote* note = _notes[NOTES / 2 + 8]; // between two tempo marks
+    const int time = note->timeStart();
+    QCOMPARE(_sheet->tempoMap()->tempoAt(time), static_cast<double>(_sheet->getTempo(time)->bpm()));
+
+    CATempo* tempo = new CATempo(CAPlayableLength(CAPlayableLength::Quarter), 200, note);
+    note->addMark(tempo);
+    QCOMPARE(_sheet->tempoMap()->tempoAt(time), 200.0);
+
+    tempo->setBpm(220);
+    QCOMPARE(_sheet->tempoMap()->tempoAt(time), 220.0);
+
+    // the mark moves with its note when a note is inserted before it
+    const double ms = _sheet->tempoMap()->timeToMs(note->timeStart());
+    CAVoice* voice = note->voice();
+    voice->insert(_notes.first(), new CANote(CADiatonicPitch(28), CAPlayableLength(CAPlayableLength::Whole), voice, 0));
+    QCOMPARE(_sheet->tempoMap()->tempoAt(note->timeStart()), 220.0);
+    QVERIFY(_sheet->tempoMap()->timeToMs(note->timeStart()) > ms);
+
+    delete tempo;
+    QCOMPARE(_sheet->tempoMap()->tempoAt(note->timeStart()), static_cast<double>(_sheet->getTempo(note->timeStart())->bpm()));
+}
+
+QTEST_GUILESS_MAIN(CATempoMapBenchmark)
+#include "tempomapbenchmark.moc"
@@ -0,0 +1,142 @@
+/*!
+	Copyright (c) 2026, Canorus development team
+	All Rights Reserved. See AUTHORS for a complete list of authors.
+
+	Licensed under the GNU GENERAL PUBLIC LICENSE. See COPYING for details.
+*/
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <memory>
+
+#include "control/typesetserver.h"
+
+/*!
+	\class CATypesetServerTest
+	\brief Tests CATypesetServer using the stubtypesetter executable instead of LilyPond
+*/
+class CATypesetServerTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void cacheMiss();
+    void cacheHit();
+    void workerCrash();
+    void workerFailure();
+    void evictionKeepsUsedFiles();
+
+private:
+    QSharedPointer<CATypesetJob> typeset(const QByteArray& source);
+    static QByteArray readFile(const QString& fileName);
+
+    std::unique_ptr<QTemporaryDir> _cacheDir;
+    std::unique_ptr<CATypesetServer> _server;
+};
+
+void CATypesetServerTest::init()
+{
+    _cacheDir.reset(new QTemporaryDir());
+    QVERIFY(_cacheDir->isValid());
+    _server.reset(new CATypesetServer(_cacheDir->path()));
+}
+
+void CATypesetServerTest::cleanup()
+{
+    _server.reset();
+    _cacheDir.reset();
+}
+
+QSharedPointer<CATypesetJob> CATypesetServerTest::typeset(const QByteArray& source)
+{
+    return _server->typeset(CANORUS_STUB_TYPESETTER, QStringList(), source);
+}
+
+QByteArray CATypesetServerTest::readFile(const QString& fileName)
+{
+    QFile file(fileName);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+void CATypesetServerTest::cacheMiss()
+{
+    QSharedPointer<CATypesetJob> job = typeset("\\relative c' { c d e }");
+    QVERIFY(job->waitForFinished(10000));
+    QCOMPARE(job->exitCode(), 0);
+    QVERIFY(job->output().contains("stubtypesetter"));
+    QVERIFY(job->resultFileName().startsWith(_server->cacheDir()));
+    QCOMPARE(readFile(job->resultFileName()), QByteArray("\\relative c' { c d e }"));
+}
+
+void CATypesetServerTest::cacheHit()
+{
+    QSharedPointer<CATypesetJob> first = typeset("\\relative c' { f g a }");
+    QVERIFY(first->waitForFinished(10000));
+    QCOMPARE(first->exitCode(), 0);
+
+    QSharedPointer<CATypesetJob> second = typeset("\\relative c' { f g a }");
+    QVERIFY(second->isFinished()); // taken from the cache, no typesetter run
+    QCOMPARE(second->exitCode(), 0);
+    QVERIFY(second->output().isEmpty());
+    QCOMPARE(second->resultFileName(), first->resultFileName());
+
+    // different parameters must not share the cached file
+    QSharedPointer<CATypesetJob> svg = _server->typeset(CANORUS_STUB_TYPESETTER, QStringList() << "-dbackend=svg", "\\relative c' { f g a }");
+    QVERIFY(svg->waitForFinished(10000));
+    QCOMPARE(svg->exitCode(), 0);
+    QVERIFY(svg->resultFileName().endsWith(".svg"));
+}
+
+void CATypesetServerTest::workerCrash()
+{
+    QSharedPointer<CATypesetJob> job = typeset("crash");
+    QVERIFY(job->waitForFinished(10000));
+    QVERIFY(job->exitCode() != 0);
+    QVERIFY(job->resultFileName().isEmpty());
+
+    // a crash is not cached and the server keeps working
+    QSharedPointer<CATypesetJob> again = typeset("crash");
+    QVERIFY(again->waitForFinished(10000));
+    QVERIFY(!again->output().isEmpty());
+
+    QSharedPointer<CATypesetJob> next = typeset("\\relative c' { b c }");
+    QVERIFY(next->waitForFinished(10000));
+    QCOMPARE(next->exitCode(), 0);
+}
+
+void CATypesetServerTest::workerFailure()
+{
+    QSharedPointer<CATypesetJob> job = typeset("fail");
+    QVERIFY(job->waitForFinished(10000));
+    QCOMPARE(job->exitCode(), 1);
+    QVERIFY(job->resultFileName().isEmpty());
+}
+
+void CATypesetServerTest::evictionKeepsUsedFiles()
+{
+    _server->setMaxCacheSize(1);
+
+    QSharedPointer<CATypesetJob> kept = typeset("first");
+    QVERIFY(kept->waitForFinished(10000));
+    const QString keptFile = kept->resultFileName();
+
+    for (const QByteArray& source : { QByteArray("second"), QByteArray("third") }) {
+        QSharedPointer<CATypesetJob> job = typeset(source);
+        QVERIFY(job->waitForFinished(10000));
+        QCOMPARE(job->exitCode(), 0);
+    }
+    QVERIFY(QFile::exists(keptFile)); // still referenced by the job
+
+    kept.clear();
+    QSharedPointer<CATypesetJob> job = typeset("fourth");
+    QVERIFY(job->waitForFinished(10000));
+    QVERIFY(!QFile::exists(keptFile)); // evicted once the job is gone
+    QVERIFY(QFile::exists(job->resultFileName()));
+}
+
+QTEST_GUILESS_MAIN(CATypesetServerTest)
+#include "typesetservertest.moc"
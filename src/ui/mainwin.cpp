@@ -73,6 +73,8 @@
 #include "layout/layoutengine.h"
 
 #include "canorus.h"
+#include "core/clipboardbuffer.h"
+#include "core/exportqueue.h"
 #include "core/midirecorder.h"
 #include "core/mimedata.h"
 #include "core/muselementfactory.h"
@@ -151,6 +153,7 @@ CAMainWin::CAMainWin(QMainWindow* oParent)
     , _mainWinProgressCtl(this)
     , _playbackView(nullptr)
     , _repaintTimer(nullptr)
+    , _playbackStep(-1)
     , _playback(nullptr)
 {
     setAttribute(Qt::WA_DeleteOnClose);
@@ -171,8 +174,9 @@ CAMainWin::CAMainWin(QMainWindow* oParent)
     // Create plugins menus and toolbars in this main window
     CAPluginManager::enablePlugins(this);
 
-    // Connects MIDI IN callback function to a local slot. Not implemented yet.
-    connect(CACanorus::midiDevice(), SIGNAL(midiInEvent(QVector<unsigned char>)), this, SLOT(onMidiInEvent(QVector<unsigned char>)));
+    // Connects MIDI IN callback function to a local slot. The device is opened on first use, see CACanorus::initPlayback().
+    if (CACanorus::hasMidiDevice())
+        connectMidiDevice();
 
     // Connect QTimer so it increases the local document edited time every second
     restartTimeEditedTime();
@@ -197,7 +201,8 @@ CAMainWin::CAMainWin(QMainWindow* oParent)
     _permanentStatusBar = statusBar();
 
     setDocument(nullptr);
-    _poExp = nullptr;
+    connect(CACanorus::exportQueue(), SIGNAL(jobProgress(int, int)), this, SLOT(onExportProgress(int, int)));
+    connect(CACanorus::exportQueue(), SIGNAL(jobFinished(int, int)), this, SLOT(onExportDone(int, int)));
     CACanorus::addMainWin(this);
 }
 
@@ -235,9 +240,6 @@ CAMainWin::~CAMainWin()
     delete _resourceView;
     delete _transposeView;
 
-    if (_poExp)
-        delete _poExp;
-
     if (_midiRecorderView)
         delete _midiRecorderView;
 
@@ -889,14 +891,8 @@ void CAMainWin::newDocument()
     CACanorus::undo()->createUndoStack(document());
     restartTimeEditedTime();
 
-#ifdef USE_PYTHON
-    QList<PyObject*> argsPython;
-    PyEval_RestoreThread(CASwigPython::mainThreadState);
-    argsPython << CASwigPython::toPythonObject(document(), CASwigPython::Document);
-    PyEval_ReleaseThread(CASwigPython::mainThreadState);
-    CASwigPython::callFunction(QFileInfo("scripts:newdocument.py").absoluteFilePath(), "newDefaultDocument", argsPython);
-#else
-    // fallback: add basic sheet with two staffs
+    // add basic sheet with two staffs, the same as scripts:newdocument.py
+    // this doesn't need the scripting engine, which is started on first use
     CASheet* sheet1 = document()->addSheet();
     CAStaff* staff1 = sheet1->addStaff();
     staff1->addVoice();
@@ -914,7 +910,6 @@ void CAMainWin::newDocument()
 
     staff1->synchronizeVoices();
     staff2->synchronizeVoices();
-#endif
 
     // call local rebuild only because no other main windows share the new document
     rebuildUI();
@@ -1231,6 +1226,7 @@ void CAMainWin::initView(CAView* v)
             this, SLOT(onTextEditKeyPressEvent(QKeyEvent*)));
         connect(v, SIGNAL(selectionChanged()),
             this, SLOT(onScoreViewSelectionChanged()));
+        static_cast<CAScoreView*>(v)->setVirtualLayout(CACanorus::settings()->virtualLayout());
         break;
     }
     case CAView::SourceView: {
@@ -1344,13 +1340,10 @@ void CAMainWin::on_uiUndo_toggled(bool, int row)
             CACanorus::undo()->undo(document());
         }
 
-        if (CACanorus::settings()->useNoteChecker()) {
-            for (int i = 0; i < document()->sheetList().size(); i++) {
-                _noteChecker.checkSheet(document()->sheetList()[i]);
-            }
-        }
-
         CACanorus::rebuildUI(document());
+        for (int i = 0; i < document()->sheetList().size(); i++) {
+            checkNotes(document()->sheetList()[i]);
+        }
         if (curVoiceIdx >= 0 && curVoiceIdx < currentSheet()->voiceList().size()) {
             setCurrentVoice(currentSheet()->voiceList()[curVoiceIdx]);
         }
@@ -1370,13 +1363,10 @@ void CAMainWin::on_uiRedo_toggled(bool, int row)
             CACanorus::undo()->redo(document());
         }
 
-        if (CACanorus::settings()->useNoteChecker()) {
-            for (int i = 0; i < document()->sheetList().size(); i++) {
-                _noteChecker.checkSheet(document()->sheetList()[i]);
-            }
-        }
-
         CACanorus::rebuildUI(document(), nullptr);
+        for (int i = 0; i < document()->sheetList().size(); i++) {
+            checkNotes(document()->sheetList()[i]);
+        }
 
         if (curVoiceIdx >= 0 && curVoiceIdx < currentSheet()->voiceList().size()) {
             setCurrentVoice(currentSheet()->voiceList()[curVoiceIdx]);
@@ -1721,6 +1711,33 @@ void CAMainWin::rebuildUI(bool repaint)
     setRebuildUILock(false);
 }
 
+/*!
+	Runs the note checker on the given \a sheet, if enabled in the settings, and updates
+	the drawable errors of the elements whose errors changed in the score views of all the
+	main windows showing the sheet.
+
+	Call this after the views were rebuilt. Only the changed errors are replaced and
+	repainted, the sheet is not laid out again.
+
+	\sa CANoteChecker::changedElements(), CAScoreView::updateNoteCheckerErrors()
+*/
+void CAMainWin::checkNotes(CASheet* sheet)
+{
+    if (!CACanorus::settings()->useNoteChecker()) {
+        return;
+    }
+
+    _noteChecker.checkSheet(sheet);
+    for (int i = 0; i < CACanorus::mainWinList().size(); i++) {
+        const QList<CAView*>& views = CACanorus::mainWinList()[i]->viewList();
+        for (int j = 0; j < views.size(); j++) {
+            if (views[j]->viewType() == CAView::ScoreView && static_cast<CAScoreView*>(views[j])->sheet() == sheet) {
+                static_cast<CAScoreView*>(views[j])->updateNoteCheckerErrors(_noteChecker.changedElements());
+            }
+        }
+    }
+}
+
 /*!
 	Processes the mouse press event \a e with world coordinates \a coords.
 	Any action happened in any of the Views are always linked to these main window slots.
@@ -1971,7 +1988,7 @@ void CAMainWin::scoreViewMouseMove(QMouseEvent* e, QPoint coords)
         musElementFactory()->setNoteAccs(iNoteAccs);
         c->setShadowNoteAccs(iNoteAccs);
         c->updateHelpers();
-        c->repaint();
+        c->repaintDirty(); // only the old and the new shadow note
     } else if (mode() != InsertMode) {
         if (c->resizeDirection() != CADrawable::Undefined) {
             // resize element
@@ -1988,6 +2005,7 @@ void CAMainWin::scoreViewMouseMove(QMouseEvent* e, QPoint coords)
                 c->selection().at(0)->setWidth(c->timeToCoords(c->selection().at(0)->musElement()->timeEnd()) - c->timeToCoords(time));
                 c->repaint();
             }
+            c->selection().at(0)->musElement()->invalidateTempoMap(); // resized ritardandos change the tempo
         } else if (e->buttons() == Qt::LeftButton && c->mouseDragActivated()) {
             // multiple selection
             c->clearSelectionRegionList();
@@ -2233,14 +2251,11 @@ void CAMainWin::scoreViewKeyPress(QKeyEvent* e)
                 staff->voiceList()[0]->insert(right, bar);
         }
 
-        staff->synchronizeVoices();
-
-        if (CACanorus::settings()->useNoteChecker()) {
-            _noteChecker.checkSheet(v->sheet());
-        }
+        staff->synchronizeVoices(bar->timeStart(), bar->timeStart());
 
         CACanorus::undo()->pushUndoCommand();
         CACanorus::rebuildUI(document(), v->sheet());
+        checkNotes(v->sheet());
         v->selectMElement(bar);
         v->repaint();
         break;
@@ -2260,8 +2275,9 @@ void CAMainWin::scoreViewKeyPress(QKeyEvent* e)
                 if (elt->drawableMusElementType() == CADrawableMusElement::DrawableNote) {
                     CANote* note = static_cast<CANote*>(elt->musElement());
                     CADiatonicKey key;
-                    if (note->voice()->getKeySig(note)) {
-                        key = note->voice()->getKeySig(note)->diatonicKey();
+                    CAKeySignature* keySig = note->voice()->keySignatureAt(note->timeStart());
+                    if (keySig) {
+                        key = keySig->diatonicKey();
                     }
                     CADiatonicPitch pitch(note->diatonicPitch().noteName() + 1, key.noteAccs(note->diatonicPitch().noteName() + 1));
                     note->setDiatonicPitch(pitch);
@@ -2295,8 +2311,9 @@ void CAMainWin::scoreViewKeyPress(QKeyEvent* e)
                 if (elt->drawableMusElementType() == CADrawableMusElement::DrawableNote) {
                     CANote* note = static_cast<CANote*>(elt->musElement());
                     CADiatonicKey key;
-                    if (note->voice()->getKeySig(note)) {
-                        key = note->voice()->getKeySig(note)->diatonicKey();
+                    CAKeySignature* keySig = note->voice()->keySignatureAt(note->timeStart());
+                    if (keySig) {
+                        key = keySig->diatonicKey();
                     }
                     CADiatonicPitch pitch(note->diatonicPitch().noteName() - 1, key.noteAccs(note->diatonicPitch().noteName() - 1));
                     note->setDiatonicPitch(pitch);
@@ -2463,15 +2480,12 @@ void CAMainWin::scoreViewKeyPress(QKeyEvent* e)
                     }
 
                     for (int j = 0; j < p->voice()->lyricsContextList().size(); j++) { // reposit syllables
-                        p->voice()->lyricsContextList().at(j)->repositionElements();
-                    }
-
-                    if (CACanorus::settings()->useNoteChecker()) {
-                        _noteChecker.checkSheet(v->sheet());
+                        p->voice()->lyricsContextList().at(j)->repositionElements(p->timeStart());
                     }
 
                     CACanorus::undo()->pushUndoCommand();
                     CACanorus::rebuildUI(document(), p->staff()->sheet());
+                    checkNotes(p->staff()->sheet());
                 }
             }
         }
@@ -2966,14 +2980,19 @@ bool CAMainWin::insertMusElementAt(const QPoint coords, CAScoreView* v)
     }
 
     if (success) {
-        if (staff)
-            staff->synchronizeVoices();
+        if (staff) {
+            CAMusElement::CAMusElementType type = musElementFactory()->musElementType();
+            if (type == CAMusElement::Clef || type == CAMusElement::KeySignature || type == CAMusElement::TimeSignature || type == CAMusElement::Barline) {
+                CAMusElement* sign = musElementFactory()->musElement();
+                staff->synchronizeVoices(sign->timeStart(), sign->timeStart()); // re-align the bars around the new sign only
+            } else {
+                staff->synchronizeVoices();
+            }
+        }
 
         CACanorus::undo()->pushUndoCommand();
-        if (CACanorus::settings()->useNoteChecker()) {
-            _noteChecker.checkSheet(v->sheet());
-        }
         CACanorus::rebuildUI(document(), v->sheet());
+        checkNotes(v->sheet());
         CADrawableMusElement* d = v->selectMElement(musElementFactory()->musElement());
         musElementFactory()->emptyMusElem();
 
@@ -3032,6 +3051,7 @@ void CAMainWin::playbackFinished()
 
     if (_playbackView) {
         static_cast<CAScoreView*>(_playbackView)->setPlaying(false);
+        static_cast<CAScoreView*>(_playbackView)->setPlaybackTime(-1);
     }
 
     if (_repaintTimer) {
@@ -3062,10 +3082,11 @@ void CAMainWin::on_uiPlayFromSelection_toggled(bool checked)
     if (checked && currentScoreView() && !_playback) {
         /// \todo replace raw pointer with shared or unique pointer
         _repaintTimer = new QTimer();
-        _repaintTimer->setInterval(100);
+        _repaintTimer->setInterval(16); // display refresh rate for the playback cursor
         _repaintTimer->start();
         //connect(_repaintTimer, SIGNAL(timeout()), this, SLOT(on_repaintTimer_timeout())); //TODO: timeout is connected directly to repaint() directly. This should be optimized in the future -Matevz
         connect(_repaintTimer, SIGNAL(timeout()), this, SLOT(onRepaintTimerTimeout()));
+        _playbackStep = -1;
 
         CACanorus::midiDevice()->openOutputPort(CACanorus::settings()->midiOutPort());
         /// \todo replace raw pointer with shared or unique pointer
@@ -3084,7 +3105,7 @@ void CAMainWin::on_uiPlayFromSelection_toggled(bool checked)
         currentScoreView()->setPlaying(true); // set the deadlock for borders
 
         // Remember old selection
-        _prePlaybackSelection = currentScoreView()->selection();
+        _prePlaybackSelection = currentScoreView()->musElementSelection();
         currentScoreView()->clearSelection();
 
         _playback->start();
@@ -3096,23 +3117,42 @@ void CAMainWin::on_uiPlayFromSelection_toggled(bool checked)
 /*!
 	Called every few miliseconds during playback to repaint score View as the GUI can
 	only be repainted from the main thread.
+
+	The playback cursor is moved on every call, the played notes are highlighted only
+	when the playback reaches the next notes.
 */
 void CAMainWin::onRepaintTimerTimeout()
 {
     CAScoreView* sv = static_cast<CAScoreView*>(_playbackView);
+    sv->setPlaybackTime(_playback->playbackTime());
+
+    if (_playback->playbackStep() == _playbackStep) {
+        return;
+    }
+    _playbackStep = _playback->playbackStep();
+
+    bool scrolled = false;
     sv->clearSelection();
     for (int i = 0; i < _playback->curPlaying().size(); i++) {
         if (_playback->curPlaying().at(i)->musElementType() == CAMusElement::Note) {
             CADrawableMusElement* elt = sv->addToSelection(_playback->curPlaying()[i]);
             if (CACanorus::settings()->lockScrollPlayback()) {
-                if (elt && (elt->xPos() > (sv->worldX() + sv->worldWidth()) || elt->xPos() < sv->worldX())) {
-                    sv->setWorldX(elt->xPos() - 50, CACanorus::settings()->animatedScroll());
+                // notes outside the virtual layout have no drawable yet, use their column
+                double x = (elt ? elt->xPos() : sv->timeToCoords(_playback->curPlaying()[i]->timeStart()));
+                if (x >= 0 && (x > (sv->worldX() + sv->worldWidth()) || x < sv->worldX())) {
+                    sv->setWorldX(x - 50, CACanorus::settings()->animatedScroll());
+                    scrolled = true;
                 }
             }
         }
     }
 
-    sv->repaint();
+    // repaint only the previously and currently played notes, unless the view scrolled
+    if (scrolled) {
+        sv->repaint();
+    } else {
+        sv->repaintDirty();
+    }
 }
 
 void CAMainWin::on_uiLockScrollPlayback_toggled(bool val)
@@ -3296,12 +3336,10 @@ CADocument* CAMainWin::openDocument(CADocument* doc)
         CACanorus::undo()->createUndoStack(document());
 
         uiCloseDocument->setEnabled(true);
-        if (CACanorus::settings()->useNoteChecker()) {
-            for (int i = 0; i < doc->sheetList().size(); i++) {
-                _noteChecker.checkSheet(doc->sheetList()[i]);
-            }
-        }
         rebuildUI(); // local rebuild only
+        for (int i = 0; i < doc->sheetList().size(); i++) {
+            checkNotes(doc->sheetList()[i]);
+        }
         if (doc->sheetList().size())
             uiTabWidget->setCurrentIndex(0);
 
@@ -3396,6 +3434,14 @@ void CAMainWin::updateWindowTitle()
     }
 }
 
+/*!
+	Connects the MIDI input of the application's MIDI device to this main window.
+*/
+void CAMainWin::connectMidiDevice()
+{
+    connect(CACanorus::midiDevice(), SIGNAL(midiInEvent(QVector<unsigned char>)), this, SLOT(onMidiInEvent(QVector<unsigned char>)));
+}
+
 void CAMainWin::onMidiInEvent(QVector<unsigned char> m)
 {
     _keybdInput->onMidiInEvent(m);
@@ -3414,12 +3460,6 @@ void CAMainWin::on_uiExportDocument_triggered()
     if (!ffound)
         return;
 
-    // ! Warning: If there is still a running export instance
-    // !               this will stop the old one (kill it actually)
-    /// \todo: maybe block new export until the old is finished
-    if (_poExp) // Delete old export instance
-        delete _poExp;
-
     fileNames = uiExportDialog->selectedFiles();
 
     QString s = fileNames[0];
@@ -3440,38 +3480,34 @@ void CAMainWin::on_uiExportDocument_triggered()
     if (CAPluginManager::exportFilterExists(uiExportDialog->selectedNameFilter())) {
         CAPluginManager::exportAction(uiExportDialog->selectedNameFilter(), document(), s);
     } else {
+        // Filters are owned and deleted by the export queue
+        CAExport* exp = nullptr;
         if (uiExportDialog->selectedNameFilter() == CAFileFormats::MIDI_FILTER) {
-            /// \todo replace raw pointer with shared or unique pointer
-            CAMidiExport* pme = new CAMidiExport;
-            _poExp = pme;
+            exp = new CAMidiExport;
         } else if (uiExportDialog->selectedNameFilter() == CAFileFormats::LILYPOND_FILTER) {
-            /// \todo replace raw pointer with shared or unique pointer
-            CALilyPondExport* ple = new CALilyPondExport;
-            _poExp = ple;
+            exp = new CALilyPondExport;
         } else if (uiExportDialog->selectedNameFilter() == CAFileFormats::MUSICXML_FILTER) {
-            /// \todo replace raw pointer with shared or unique pointer
-            CAMusicXmlExport* musicxml = new CAMusicXmlExport;
-            _poExp = musicxml;
+            exp = new CAMusicXmlExport;
         } else if (uiExportDialog->selectedNameFilter() == CAFileFormats::PDF_FILTER) {
-            /// \todo replace raw pointer with shared or unique pointer
-            CAPDFExport* ppe = new CAPDFExport;
-            _poExp = ppe;
+            exp = new CAPDFExport;
         } else if (uiExportDialog->selectedNameFilter() == CAFileFormats::SVG_FILTER) {
-            /// \todo replace raw pointer with shared or unique pointer
-            CASVGExport* pse = new CASVGExport;
-            _poExp = pse;
+            if (CACanorus::settings()->useNativePreview()) {
+                // Render the pages natively, without running the typesetter
+                if (!_poPrintPreviewCtl->exportSvg(currentSheet(), s))
+                    QMessageBox::critical(this, tr("Error while exporting"), tr("Unable to write %1.").arg(s));
+                return;
+            }
+            exp = new CASVGExport;
         } else {
             //TODO: unknown/unsupported format, raise an error
             return;
         }
-        if (_poExp) {
-            _poExp->setStreamToFile(s);
+        if (exp) {
+            exp->setStreamToFile(s);
             // @ToDo Complete document export is not supported currently
             // Also when (context) to print current sheet and when the whole document ?
-            //_poExp->exportDocument( document() );
-            _poExp->exportSheet(currentSheet());
-            _poExp->wait();
-            //delete _poExp;
+            //CACanorus::exportQueue()->exportDocument( exp, document() );
+            _exportJobs << CACanorus::exportQueue()->exportSheet(exp, currentSheet());
         }
     }
 }
@@ -3568,10 +3604,8 @@ void CAMainWin::onImportDone(int)
             if (import->importedSheet()) {
                 addSheet(import->importedSheet());
                 document()->addSheet(import->importedSheet());
-                if (CACanorus::settings()->useNoteChecker()) {
-                    _noteChecker.checkSheet(import->importedSheet());
-                }
                 CACanorus::rebuildUI(document());
+                checkNotes(import->importedSheet());
             }
         }
 
@@ -3596,8 +3630,37 @@ void CAMainWin::on_uiExportToPdf_triggered()
     on_uiExportDocument_triggered();
 }
 
-void CAMainWin::onExportDone(int)
+/*!
+	Shows the progress of the background export \a job started in this main window.
+*/
+void CAMainWin::onExportProgress(int job, int progress)
+{
+    if (_exportJobs.contains(job)) {
+        statusBar()->showMessage(progress < 0 ? tr("Exporting...") : tr("Exporting... %1%").arg(progress));
+    }
+}
+
+/*!
+	Called when the background export \a job is finished.
+	Shows the error message, if the export failed.
+*/
+void CAMainWin::onExportDone(int job, int status)
 {
+    if (!_exportJobs.remove(job)) {
+        return; // job from another main window
+    }
+
+    if (status == 0) {
+        statusBar()->showMessage(tr("Export finished."), 2000);
+    } else if (status == CAFile::CANCELLED_STATUS) {
+        statusBar()->showMessage(tr("Export cancelled."), 2000);
+    } else {
+        statusBar()->clearMessage();
+        QMessageBox::critical(
+            this,
+            tr("Error while exporting document"),
+            tr("The document was not exported!\nError number %1 %2.").arg(status).arg(CACanorus::exportQueue()->exporter(job)->readableStatus()));
+    }
 }
 
 /*!
@@ -3782,17 +3845,14 @@ void CAMainWin::on_uiPlayableLength_toggled(bool, int buttonId)
                 }
 
                 for (int j = 0; j < p->voice()->lyricsContextList().size(); j++) { // reposit syllables
-                    p->voice()->lyricsContextList().at(j)->repositionElements();
+                    p->voice()->lyricsContextList().at(j)->repositionElements(p->timeStart());
                 }
             }
         }
 
-        if (CACanorus::settings()->useNoteChecker()) {
-            _noteChecker.checkSheet(v->sheet());
-        }
-
         CACanorus::undo()->pushUndoCommand();
         CACanorus::rebuildUI(document(), currentSheet());
+        checkNotes(v->sheet());
     }
 }
 
@@ -3921,7 +3981,7 @@ void CAMainWin::confirmTextEdit(CAScoreView* v, CATextEdit* textEdit, CAMusEleme
 
         QString text = textEdit->text().simplified(); // remove any trailing whitespaces
         cn->importFromString(text);
-        _noteChecker.checkSheet(v->sheet());
+        checkNotes(v->sheet());
 
         v->removeTextEdit();
         break;
@@ -4213,11 +4273,8 @@ void CAMainWin::on_uiTimeSigBeats_valueChanged(int beats)
             CATimeSignature* timeSig = dynamic_cast<CATimeSignature*>(v->selection().at(0)->musElement());
             if (timeSig) {
                 timeSig->setBeats(beats);
-                if (CACanorus::settings()->useNoteChecker()) {
-                    _noteChecker.checkSheet(v->sheet());
-                }
-
                 CACanorus::rebuildUI(document(), currentSheet());
+                checkNotes(v->sheet());
             }
         }
     }
@@ -4380,14 +4437,11 @@ void CAMainWin::sourceViewCommit(QString inputString)
             // TODO UX: Set previous voice, set previous context.
         }
 
-        if (CACanorus::settings()->useNoteChecker()) {
-            for (int i = 0; i < document()->sheetList().size(); i++) {
-                _noteChecker.checkSheet(document()->sheetList()[i]);
-            }
-        }
-
         CACanorus::undo()->pushUndoCommand();
         CACanorus::rebuildUI(document());
+        for (int i = 0; i < document()->sheetList().size(); i++) {
+            checkNotes(document()->sheetList()[i]);
+        }
 
         if (oldDoc) {
             delete oldDoc;
@@ -4424,12 +4478,9 @@ void CAMainWin::sourceViewCommit(QString inputString)
 
         v->setVoice(newVoice);
 
-        if (CACanorus::settings()->useNoteChecker()) {
-            _noteChecker.checkSheet(newVoice->staff()->sheet());
-        }
-
         CACanorus::undo()->pushUndoCommand();
         CACanorus::rebuildUI(document(), newVoice->staff()->sheet());
+        checkNotes(newVoice->staff()->sheet());
         setCurrentView(v);
 
         // oldVoice must be cleaned *after* rebuildUI(), because of shadow notes referencing it!
@@ -5440,6 +5491,17 @@ void CAMainWin::copySelection(CAScoreView* v)
         contexts.removeAll(nullptr);
         // contexts now contains the contexts of the selected elements, in the correct order.
 
+        // Store simple selections in the compact buffer without cloning the elements
+        CAClipboardBuffer* buffer = new CAClipboardBuffer();
+        bool compact = !contexts.isEmpty();
+        for (int i = 0; i < contexts.size() && compact; i++)
+            compact = contexts[i]->contextType() == CAContext::Staff && buffer->addStaff(static_cast<CAStaff*>(contexts[i]), eltMap[contexts[i]]);
+        if (compact) {
+            QApplication::clipboard()->setMimeData(new CAMimeData(buffer));
+            return;
+        }
+        delete buffer;
+
         // Copy staff elements
         QHash<CAVoice*, CAVoice*> voiceMap; // all voices in selection
         for (int i = 0; i < contexts.size(); i++) {
@@ -5738,14 +5800,15 @@ void CAMainWin::deleteSelection(CAScoreView* v, bool deleteSyllables, bool delet
 
                 p->voice()->remove(p, true);
                 for (int j = 0; j < p->voice()->lyricsContextList().size(); j++) {
-                    p->voice()->lyricsContextList().at(j)->repositionElements();
+                    p->voice()->lyricsContextList().at(j)->repositionElements(p->timeStart());
                 }
                 delete p;
             } else if ((*i)->musElementType() == CAMusElement::Syllable) {
                 if (deleteSyllables) {
                     CALyricsContext* lc = static_cast<CALyricsContext*>((*i)->context());
+                    int timeStart = (*i)->timeStart();
                     (*i)->context()->remove(*i); // actually removes the syllable if SHIFT is pressed
-                    lc->repositionElements();
+                    lc->repositionElements(timeStart);
                 } else {
                     static_cast<CASyllable*>(*i)->clear(); // only clears syllable's text
                 }
@@ -5790,12 +5853,9 @@ void CAMainWin::deleteSelection(CAScoreView* v, bool deleteSyllables, bool delet
         if (doUndo)
             CACanorus::undo()->pushUndoCommand();
 
-        if (CACanorus::settings()->useNoteChecker()) {
-            _noteChecker.checkSheet(v->sheet());
-        }
-
         v->clearSelection();
         CACanorus::rebuildUI(document(), v->sheet());
+        checkNotes(v->sheet());
     }
 }
 
@@ -5811,13 +5871,19 @@ void CAMainWin::pasteAt(const QPoint coords, CAScoreView* v)
         CASheet* currentSheet = currentContext->sheet();
 
         QList<CAMusElement*> newEltList;
-        QList<CAContext*> contexts = static_cast<const CAMimeData*>(QApplication::clipboard()->mimeData())->contexts();
+        const CAMimeData* mimeData = static_cast<const CAMimeData*>(QApplication::clipboard()->mimeData());
+        const CAClipboardBuffer* buffer = mimeData->buffer(); // compact buffer contains staffs only
+        QList<CAContext*> contexts = mimeData->contexts();
         QHash<CAVoice*, CAVoice*> voiceMap; // MimeData -> paste
         CAContext* insertAfter = nullptr;
-        for (CAContext* context : contexts) {
+        int contextCount = buffer ? buffer->staffCount() : contexts.size();
+        for (int c = 0; c < contextCount; c++) {
+            CAContext* context = buffer ? nullptr : contexts[c];
+            CAContext::CAContextType contextType = context ? context->contextType() : CAContext::Staff;
+
             // create a new context if there isn't one of the right type.
             // exception: if the context is a staff, skip lyrics contexts instead of inserting a staff before a lyrics context.
-            if (context->contextType() == CAContext::Staff) {
+            if (contextType == CAContext::Staff) {
                 while (currentContext && currentContext->contextType() == CAContext::LyricsContext)
                     if (currentContext != currentSheet->contextList().last())
                         currentContext = currentSheet->contextList()[currentSheet->contextList().indexOf(currentContext) + 1];
@@ -5825,9 +5891,9 @@ void CAMainWin::pasteAt(const QPoint coords, CAScoreView* v)
                         currentContext = nullptr;
             }
 
-            if (!currentContext || context->contextType() != currentContext->contextType()) {
+            if (!currentContext || contextType != currentContext->contextType()) {
                 CAContext* newContext = nullptr;
-                switch (context->contextType()) {
+                switch (contextType) {
                 case CAContext::Staff: {
                     CAStaff /* * s = static_cast<CAStaff*>(context),*/* newStaff;
                     newContext = newStaff = new CAStaff(tr("Staff%1").arg(v->sheet()->staffList().size() + 1), currentSheet);
@@ -5867,102 +5933,122 @@ void CAMainWin::pasteAt(const QPoint coords, CAScoreView* v)
                     currentSheet->addContext(newContext);
                 currentContext = newContext;
             }
-            if (context->contextType() == CAContext::Staff) {
+            if (contextType == CAContext::Staff) {
                 CAStaff *staff = static_cast<CAStaff*>(currentContext), *cbstaff = static_cast<CAStaff*>(context);
                 int voice = uiVoiceNum->getRealValue() ? uiVoiceNum->getRealValue() - 1 : uiVoiceNum->getRealValue();
-                for (int i = staff->voiceList().size() - 1; i < voice + cbstaff->voiceList().size() - 1; i++) {
+                int voiceCount = buffer ? buffer->voiceCount(c) : cbstaff->voiceList().size();
+                for (int i = staff->voiceList().size() - 1; i < voice + voiceCount - 1; i++) {
                     staff->addVoice();
                 }
-                for (int i = voice; i < voice + cbstaff->voiceList().size(); i++) {
+                for (int i = voice; i < voice + voiceCount; i++) {
                     int cbi = i - voice;
-                    CADrawableMusElement* drawable = v->nearestRightElement(coords.x(), coords.y(), staff->voiceList()[i]);
-                    voiceMap[cbstaff->voiceList()[cbi]] = staff->voiceList()[i];
+                    CAVoice* target = staff->voiceList()[i];
+                    CADrawableMusElement* drawable = v->nearestRightElement(coords.x(), coords.y(), target);
+                    if (!buffer)
+                        voiceMap[cbstaff->voiceList()[cbi]] = target;
                     CAMusElement* right = (drawable) ? drawable->musElement() : nullptr;
 
                     // Can't have playables between two notes linked by a tie. Remove the tie in this case.
                     // FIXME this should be the behavior for insert as well.
                     CAMusElement* leftPl = right;
-                    while ((leftPl = staff->voiceList()[i]->previous(leftPl)) && !leftPl->isPlayable())
+                    while ((leftPl = target->previous(leftPl)) && !leftPl->isPlayable())
                         ;
                     CANote* leftNote = (leftPl && leftPl->musElementType() == CAMusElement::Note) ? static_cast<CANote*>(leftPl) : nullptr;
                     CASlur* tie = leftNote ? leftNote->tieStart() : nullptr;
 
-                    if (tie) {
-                        if (tie->noteEnd() && staff->voiceList()[i]->musElementList().contains(tie->noteEnd()))
-                            // pasting between two tied notes - remove tie
-                            delete tie; // resets notes' tieStart/tieEnd;
-                        else {
-                            // pasting after an "open" tie - if the first paste element is a note, connect them. Otherwise delete the tie.
-                            int idx = 0;
-                            for (; idx < cbstaff->voiceList()[cbi]->musElementList().size() && !cbstaff->voiceList()[cbi]->musElementList()[idx]->isPlayable(); idx++)
-                                ;
-                            CAPlayable* first = (idx != cbstaff->voiceList()[cbi]->musElementList().size()) ? static_cast<CAPlayable*>(cbstaff->voiceList()[cbi]->musElementList()[idx]) : nullptr;
-                            if (first && first->musElementType() == CAMusElement::Note)
-                                static_cast<CANote*>(first)->setTieEnd(tie);
-                            else
-                                delete tie;
-                        }
+                    if (tie && tie->noteEnd() && target->musElementList().contains(tie->noteEnd())) {
+                        // pasting between two tied notes - remove tie
+                        delete tie; // resets notes' tieStart/tieEnd;
+                        tie = nullptr;
                     }
 
-                    QHash<CATuplet*, QList<CAPlayable*>> tupletMap;
-                    QHash<CASlur*, CANote*> slurMap;
-                    for (CAMusElement* elt : cbstaff->voiceList()[cbi]->musElementList()) {
-                        CAMusElement* cloned = (elt->isPlayable()) ? static_cast<CAPlayable*>(elt)->clone(staff->voiceList()[i]) : elt->clone(staff);
-                        CANote* n = (elt->musElementType() == CAMusElement::Note) ? static_cast<CANote*>(elt) : nullptr;
-                        CAMusElement* prev = cbstaff->voiceList()[cbi]->previous(n);
-                        CANote* prevNote = (prev && prev->musElementType() == CAMusElement::Note) ? static_cast<CANote*>(prev) : nullptr;
-                        bool chord = n && prevNote && prevNote->timeStart() == n->timeStart();
-                        if (n) {
-                            QList<CASlur*> slurs;
-                            slurs << n->tieStart() << n->tieEnd() << n->slurStart() << n->slurEnd() << n->phrasingSlurStart() << n->phrasingSlurEnd();
-                            slurs.removeAll(nullptr);
-                            for (CASlur* s : slurs) {
-                                if (!slurMap.contains(s))
-                                    slurMap[s] = static_cast<CANote*>(cloned);
-                                else {
-                                    CANote *noteStart = slurMap[s], *noteEnd = static_cast<CANote*>(cloned);
-                                    CASlur* newSlur = s->clone(noteStart->context(), noteStart, noteEnd);
-                                    switch (s->slurType()) {
-                                    case CASlur::TieType:
-                                        noteStart->setTieStart(newSlur);
-                                        noteEnd->setTieEnd(newSlur);
-                                        break;
-                                    case CASlur::SlurType:
-                                        noteStart->setSlurStart(newSlur);
-                                        noteEnd->setSlurEnd(newSlur);
-                                        break;
-                                    case CASlur::PhrasingSlurType:
-                                        noteStart->setPhrasingSlurStart(newSlur);
-                                        noteEnd->setPhrasingSlurEnd(newSlur);
-                                        break;
+                    QList<CAMusElement*> pasted;
+                    if (buffer) {
+                        // single batch insert of the compact clipboard
+                        pasted = buffer->paste(c, cbi, target, right);
+                    } else {
+                        QHash<CATuplet*, QList<CAPlayable*>> tupletMap;
+                        QHash<CASlur*, CANote*> slurMap;
+                        for (CAMusElement* elt : cbstaff->voiceList()[cbi]->musElementList()) {
+                            CAMusElement* cloned = (elt->isPlayable()) ? static_cast<CAPlayable*>(elt)->clone(target) : elt->clone(staff);
+                            CANote* n = (elt->musElementType() == CAMusElement::Note) ? static_cast<CANote*>(elt) : nullptr;
+                            CAMusElement* prev = cbstaff->voiceList()[cbi]->previous(n);
+                            CANote* prevNote = (prev && prev->musElementType() == CAMusElement::Note) ? static_cast<CANote*>(prev) : nullptr;
+                            bool chord = n && prevNote && prevNote->timeStart() == n->timeStart();
+                            if (n) {
+                                QList<CASlur*> slurs;
+                                slurs << n->tieStart() << n->tieEnd() << n->slurStart() << n->slurEnd() << n->phrasingSlurStart() << n->phrasingSlurEnd();
+                                slurs.removeAll(nullptr);
+                                for (CASlur* s : slurs) {
+                                    if (!slurMap.contains(s))
+                                        slurMap[s] = static_cast<CANote*>(cloned);
+                                    else {
+                                        CANote *noteStart = slurMap[s], *noteEnd = static_cast<CANote*>(cloned);
+                                        CASlur* newSlur = s->clone(noteStart->context(), noteStart, noteEnd);
+                                        switch (s->slurType()) {
+                                        case CASlur::TieType:
+                                            noteStart->setTieStart(newSlur);
+                                            noteEnd->setTieEnd(newSlur);
+                                            break;
+                                        case CASlur::SlurType:
+                                            noteStart->setSlurStart(newSlur);
+                                            noteEnd->setSlurEnd(newSlur);
+                                            break;
+                                        case CASlur::PhrasingSlurType:
+                                            noteStart->setPhrasingSlurStart(newSlur);
+                                            noteEnd->setPhrasingSlurEnd(newSlur);
+                                            break;
+                                        }
                                     }
                                 }
                             }
-                        }
-                        staff->voiceList()[i]->insert(chord ? newEltList.last() : right, cloned, chord);
-                        newEltList << cloned;
-                        if (elt->isPlayable()) {
-                            CAPlayable* pl = static_cast<CAPlayable*>(elt);
-                            if (pl->tuplet()) {
-                                tupletMap[pl->tuplet()] << static_cast<CAPlayable*>(cloned);
-                                if (tupletMap[pl->tuplet()].size() == pl->tuplet()->noteList().size())
-                                    pl->tuplet()->clone(tupletMap[pl->tuplet()]);
+                            target->insert(chord ? pasted.last() : right, cloned, chord);
+                            pasted << cloned;
+                            if (elt->isPlayable()) {
+                                CAPlayable* pl = static_cast<CAPlayable*>(elt);
+                                if (pl->tuplet()) {
+                                    tupletMap[pl->tuplet()] << static_cast<CAPlayable*>(cloned);
+                                    if (tupletMap[pl->tuplet()].size() == pl->tuplet()->noteList().size())
+                                        pl->tuplet()->clone(tupletMap[pl->tuplet()]);
+                                }
                             }
                         }
-                        // FIXME duplicated from CAMusElementFactory::configureNote.
-                        if (n && staff->voiceList()[i]->lastNote() != static_cast<CANote*>(cloned)) {
-                            for (CALyricsContext* context : staff->voiceList()[i]->lyricsContextList())
-                                context->insertEmptyElement(cloned->timeStart());
-                            for (CAContext* context : currentSheet->contextList())
-                                if (context->contextType() == CAContext::FunctionMarkContext)
-                                    static_cast<CAFunctionMarkContext*>(context)->insertEmptyElement(cloned->timeStart());
-                        }
                     }
-                    for (CALyricsContext* context : staff->voiceList()[i]->lyricsContextList())
-                        context->repositionElements();
-                    for (CAContext* context : currentSheet->contextList())
-                        if (context->contextType() == CAContext::FunctionMarkContext)
+                    newEltList += pasted;
+                    if (pasted.isEmpty())
+                        continue;
+
+                    if (tie && !tie->noteEnd()) {
+                        // pasting after an "open" tie - if the first pasted element is a note, connect them. Otherwise delete the tie.
+                        int idx = 0;
+                        for (; idx < pasted.size() && !pasted[idx]->isPlayable(); idx++)
+                            ;
+                        if (idx < pasted.size() && pasted[idx]->musElementType() == CAMusElement::Note) {
+                            tie->setNoteEnd(static_cast<CANote*>(pasted[idx]));
+                            static_cast<CANote*>(pasted[idx])->setTieEnd(tie);
+                        } else
+                            delete tie;
+                    }
+
+                    // FIXME duplicated from CAMusElementFactory::configureNote.
+                    int emptyElements = 0;
+                    for (CAMusElement* elt : pasted) {
+                        if (elt->musElementType() == CAMusElement::Note && static_cast<CANote*>(elt)->isFirstInChord() && target->lastNote() != elt)
+                            emptyElements++;
+                    }
+                    int timeStart = pasted.first()->timeStart();
+                    for (CALyricsContext* context : target->lyricsContextList()) {
+                        for (int j = 0; j < emptyElements; j++)
+                            context->insertEmptyElement(timeStart);
+                        context->repositionElements(timeStart);
+                    }
+                    for (CAContext* context : currentSheet->contextList()) {
+                        if (context->contextType() == CAContext::FunctionMarkContext) {
+                            for (int j = 0; j < emptyElements; j++)
+                                static_cast<CAFunctionMarkContext*>(context)->insertEmptyElement(timeStart);
                             static_cast<CAFunctionMarkContext*>(context)->repositionElements();
+                        }
+                    }
                 }
                 staff->synchronizeVoices();
             } else {
@@ -5987,12 +6073,9 @@ void CAMainWin::pasteAt(const QPoint coords, CAScoreView* v)
             currentContext = (idx + 1 < currentSheet->contextList().size()) ? currentSheet->contextList()[idx + 1] : nullptr;
         }
 
-        if (CACanorus::settings()->useNoteChecker()) {
-            _noteChecker.checkSheet(currentSheet);
-        }
-
         CACanorus::undo()->pushUndoCommand();
         CACanorus::rebuildUI(document(), currentSheet);
+        checkNotes(currentSheet);
 
         // select pasted elements
         currentScoreView()->clearSelection();
@@ -6309,8 +6392,7 @@ void CAMainWin::playImmediately(QList<CAMusElement*> elements)
 
 /*!
 	\var QTimer* CACanorus::_repaintTimer
-	Used when playback is active to repaint the playback View.
-	\todo View should be repainted only when needed, not constantly as now. This should result in much less resource hunger.
+	Used when playback is active to move the playback cursor and highlight the played notes.
 */
 
 /*!
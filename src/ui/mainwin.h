@@ -11,6 +11,7 @@
 #include <QFileDialog>
 #include <QHash>
 #include <QObject>
+#include <QSet>
 #include <QTime>
 #include <QTimer>
 
@@ -94,7 +95,9 @@ public:
     void rebuildUI(CASheet* sheet, bool repaint = true);
     void rebuildUI(bool repaint = true);
     inline bool rebuildUILock() { return _rebuildUILock; }
+    void checkNotes(CASheet* sheet);
     void updateWindowTitle();
+    void connectMidiDevice();
 
     void newDocument();
     void addSheet(CASheet* s);
@@ -355,7 +358,8 @@ private slots:
     // Handle progress bar events //
     ////////////////////////////////
     void onImportDone(int status);
-    void onExportDone(int status);
+    void onExportProgress(int job, int progress);
+    void onExportDone(int job, int status);
 
 private:
     void playImmediately(QList<CAMusElement*> elements);
@@ -368,7 +372,7 @@ private:
 
     CAPreviewCtl* _poPrintPreviewCtl;
     CAPrintCtl* _poPrintCtl;
-    CAExport* _poExp; // abstract export instance
+    QSet<int> _exportJobs; // background export jobs started in this window
     CAResourceView* _resourceView;
     CATransposeView* _transposeView;
     CAJumpToView* _jumpToView;
@@ -394,8 +398,9 @@ private:
     int _iNumAllowed;
     CAView* _currentView;
     CAView* _playbackView;
-    QList<CADrawableMusElement*> _prePlaybackSelection;
+    QList<CAMusElement*> _prePlaybackSelection; // Music elements, the drawables may be rebuilt during playback
     QTimer* _repaintTimer;
+    int _playbackStep; // Playback step the notes were last highlighted for
     bool _rebuildUILock;
     inline void setRebuildUILock(bool l) { _rebuildUILock = l; }
 
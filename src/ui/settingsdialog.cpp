@@ -56,6 +56,7 @@ void CASettingsDialog::setupPages(CASettingsPage currentPage)
     uiPlayInsertedNotes->setChecked(CACanorus::settings()->playInsertedNotes());
     uiAutoBar->setChecked(CACanorus::settings()->autoBar());
     uiUseNoteChecker->setChecked(CACanorus::settings()->useNoteChecker());
+    uiVirtualLayout->setChecked(CACanorus::settings()->virtualLayout());
 
     // Appearance Page
     uiAntiAliasing->setChecked(CACanorus::settings()->antiAliasing());
@@ -88,6 +89,8 @@ void CASettingsDialog::setupPages(CASettingsPage currentPage)
             CAFileFormats::getFilter(CACanorus::settings()->defaultSaveFormat())));
 
     uiAutoRecoverySpinBox->setValue(CACanorus::settings()->autoRecoveryInterval());
+    uiCompressionLevelSpinBox->setValue(CACanorus::settings()->compressionLevel());
+    uiParallelCompression->setChecked(CACanorus::settings()->parallelCompression());
 
     // Playback Page
     _midiInPorts = CACanorus::midiDevice()->getInputPorts();
@@ -119,6 +122,7 @@ void CASettingsDialog::setupPages(CASettingsPage currentPage)
     uiTypesetterDefault->setChecked(CACanorus::settings()->useSystemDefaultTypesetter());
     uiPdfViewerLocation->setText(CACanorus::settings()->pdfViewerLocation());
     uiPdfViewerDefault->setChecked(CACanorus::settings()->useSystemDefaultPdfViewer());
+    uiNativePreview->setChecked(CACanorus::settings()->useNativePreview());
 }
 
 void CASettingsDialog::on_uiButtonBox_clicked(QAbstractButton* button)
@@ -147,6 +151,7 @@ void CASettingsDialog::applySettings()
     CACanorus::settings()->setPlayInsertedNotes(uiPlayInsertedNotes->isChecked());
     CACanorus::settings()->setAutoBar(uiAutoBar->isChecked());
     CACanorus::settings()->setUseNoteChecker(uiUseNoteChecker->isChecked());
+    CACanorus::settings()->setVirtualLayout(uiVirtualLayout->isChecked());
 
     // Saving/Loading Page
     CACanorus::settings()->setDocumentsDirectory(uiDocumentsDirectory->text());
@@ -158,6 +163,8 @@ void CASettingsDialog::applySettings()
     _mainWin->uiSaveDialog->selectNameFilter(uiDefaultSaveComboBox->currentText());
     CACanorus::settings()->setAutoRecoveryInterval(uiAutoRecoverySpinBox->value());
     CACanorus::autoRecovery()->updateTimer();
+    CACanorus::settings()->setCompressionLevel(uiCompressionLevelSpinBox->value());
+    CACanorus::settings()->setParallelCompression(uiParallelCompression->isChecked());
 
     // Appearance Page
     CACanorus::settings()->setAntiAliasing(uiAntiAliasing->isChecked());
@@ -187,6 +194,7 @@ void CASettingsDialog::applySettings()
     CACanorus::settings()->setUseSystemDefaultTypesetter(uiTypesetterDefault->isChecked());
     CACanorus::settings()->setPdfViewerLocation(uiPdfViewerLocation->text());
     CACanorus::settings()->setUseSystemDefaultPdfViewer(uiPdfViewerDefault->isChecked());
+    CACanorus::settings()->setUseNativePreview(uiNativePreview->isChecked());
 
     CACanorus::settings()->writeSettings();
 }
@@ -38,15 +38,20 @@ void CAProgressStatusBar::on_cancelButton_clicked(bool c)
     emit(cancelButtonClicked(c));
 }
 
+/*!
+	Shows the \a label and the progress \a value in percent.
+	A negative value shows a busy indicator instead.
+*/
 void CAProgressStatusBar::setProgress(QString label, int value)
 {
     _progressLabel->setText(label);
-    _progressBar->setValue(value);
+    setProgress(value);
 }
 
 void CAProgressStatusBar::setProgress(int value)
 {
-    _progressBar->setValue(value);
+    _progressBar->setRange(0, value < 0 ? 0 : 100);
+    _progressBar->setValue(qMax(value, 0));
 }
 
 void CAProgressStatusBar::setProgress(QString label)
@@ -10,6 +10,7 @@
 #include "canorus.h"
 #include "interface/plugin.h"
 #include "interface/pluginmanager.h"
+#include "ui/mainwin.h"
 #include "widgets/pyconsole.h"
 
 #include <QKeyEvent>
@@ -504,6 +505,17 @@ bool CAPyConsole::cmdIntern(QString strCmd)
     // if (!strCmd.startsWith("/"))
     //     return false;
 
+    // Python and the pyCLI plugin are started on the first command, not when the console is created
+    CACanorus::initScripting();
+    for (int i = 0; i < CAPluginManager::pluginList().size(); i++) {
+        CAPlugin* plugin = CAPluginManager::pluginList()[i];
+        for (int j = 0; plugin->name() == "pyCLI" && plugin->isEnabled() && j < CACanorus::mainWinList().size(); j++) {
+            if (CACanorus::mainWinList()[j]->pyConsole == this) {
+                plugin->initialize(CACanorus::mainWinList()[j]);
+            }
+        }
+    }
+
     if (strCmd == "/i") {
         txtAppend("[Can't reset PyCLI]\n");
         /*
@@ -8,6 +8,7 @@
 #include <QBrush>
 #include <QColor>
 #include <QDebug>
+#include <QFontMetricsF>
 #include <QGridLayout>
 #include <QMouseEvent>
 #include <QPainter>
@@ -15,10 +16,12 @@
 #include <QScrollBar>
 #include <QTimer>
 #include <QWheelEvent>
+#include <QtMath>
 
 #include <math.h> // needed for square root in animated scrolls/zoom
 
 #include <iostream>
+#include <limits>
 
 #include "layout/drawable.h"
 #include "layout/drawableaccidental.h"
@@ -27,6 +30,7 @@
 #include "layout/drawablelyricscontext.h" // syllable edit creation
 #include "layout/drawablemuselement.h"
 #include "layout/drawablenote.h"
+#include "layout/drawablenotecheckererror.h"
 #include "layout/drawablestaff.h"
 #include "layout/drawabletimesignature.h"
 #include "layout/layoutengine.h"
@@ -39,6 +43,7 @@
 #include "score/document.h"
 #include "score/lyricscontext.h"
 #include "score/muselement.h"
+#include "score/notecheckererror.h"
 #include "score/note.h"
 #include "score/rest.h"
 #include "score/sheet.h"
@@ -56,6 +61,8 @@ const int CAScoreView::BOTTOM_EXTRA_SPACE = 30; // Gives some space after the mu
 const int CAScoreView::RULER_HEIGHT = 15;
 const int CAScoreView::ANIMATION_STEPS = 7;
 const int CAScoreView::SELECTION_REGION_THRESHOLD = 10;
+const int CAScoreView::DIRTY_MARGIN = 4;
+const int CAScoreView::VIRTUAL_LAYOUT_MARGIN = 1000;
 
 /*!
 	\class CATextEdit
@@ -136,6 +143,10 @@ void CAScoreView::initScoreView(CASheet* sheet)
     _vScrollBarDeadLock = false;
     _checkScrollBarsDeadLock = false;
     _playing = false;
+    _virtualLayout = false;
+    _materialisedX1 = -std::numeric_limits<double>::max();
+    _materialisedX2 = std::numeric_limits<double>::max();
+    _playbackCursorX = -1;
     _currentContext = nullptr;
     _xCursor = _yCursor = 0;
     setResizeDirection(CADrawable::Undefined);
@@ -164,6 +175,12 @@ void CAScoreView::initScoreView(CASheet* sheet)
     _clickTimer->setInterval(static_cast<int>(QApplication::doubleClickInterval() * 1.5));
     connect(_clickTimer, SIGNAL(timeout()), this, SLOT(on_clickTimer_timeout()));
 
+    // init virtual layout timer (used for laying out the area scrolled into view, see setVirtualLayout())
+    _materialiseTimer = new QTimer(this);
+    _materialiseTimer->setSingleShot(true);
+    _materialiseTimer->setInterval(0);
+    connect(_materialiseTimer, SIGNAL(timeout()), this, SLOT(on_materialiseTimer_timeout()));
+
     // init helpers
     setSelectedVoice(nullptr);
     setShadowNoteVisible(false);
@@ -204,6 +221,7 @@ void CAScoreView::initScoreView(CASheet* sheet)
     setSelectedContextColor(CACanorus::settings()->selectedContextColor());
     setHiddenElementsColor(CACanorus::settings()->hiddenElementsColor());
     setDisabledElementsColor(CACanorus::settings()->disabledElementsColor());
+    setPlaybackCursorColor(QColor(0, 160, 0, 160));
 }
 
 CAScoreView::~CAScoreView()
@@ -285,6 +303,7 @@ void CAScoreView::addMElement(CADrawableMusElement* elt, bool select)
     _drawableMList.addElement(elt);
     _mapDrawable.insertMulti(elt->musElement(), elt);
     if (select) {
+        addDirtySelection();
         _selection.clear();
         addToSelection(elt);
     }
@@ -311,12 +330,54 @@ void CAScoreView::addCElement(CADrawableContext* elt, bool select)
 }
 
 /*!
-	Adds a drawable music element \a elt to the score view and selects it, if \a select is true.
+	Adds a drawable note checker error \a dnce to the score view.
 */
 void CAScoreView::addDrawableNoteCheckerError(CADrawableNoteCheckerError* dnce)
 {
     _drawableNCEList.addElement(dnce);
-    _mapDrawable.insertMulti(nullptr, dnce);
+}
+
+/*!
+	Updates the drawable note checker errors of the \a changedElements and repaints them.
+	Use this after CANoteChecker::checkSheet() with CANoteChecker::changedElements(), if
+	only the errors have changed, instead of laying out the whole sheet again. The
+	drawable errors of other elements are kept.
+*/
+void CAScoreView::updateNoteCheckerErrors(const QList<CAMusElement*>& changedElements)
+{
+    if (changedElements.isEmpty()) {
+        return;
+    }
+
+    QSet<CAMusElement*> changed = changedElements.toSet();
+    QList<CADrawableNoteCheckerError*> oldErrors = _drawableNCEList.list();
+    _drawableNCEList.clear(false);
+    for (int i = 0; i < oldErrors.size(); i++) {
+        if (changed.contains(oldErrors[i]->targetElement())) {
+            addDirtyDrawable(oldErrors[i]);
+            delete oldErrors[i];
+        } else {
+            _drawableNCEList.addElement(oldErrors[i]);
+        }
+    }
+
+    QList<CADrawableMusElement*> targetDrawables; // collected first, placing the errors changes _drawableNCEList
+    for (QSet<CAMusElement*>::const_iterator t = changed.constBegin(); t != changed.constEnd(); t++) {
+        for (QMultiHash<void*, CADrawable*>::const_iterator it = _mapDrawable.constFind(*t); it != _mapDrawable.constEnd() && it.key() == *t; it++) {
+            targetDrawables << static_cast<CADrawableMusElement*>(it.value());
+        }
+    }
+    for (int i = 0; i < targetDrawables.size(); i++) {
+        CALayoutEngine::placeNoteCheckerErrors(targetDrawables[i], this);
+    }
+
+    QList<CADrawableNoteCheckerError*> newErrors = _drawableNCEList.list();
+    for (int i = 0; i < newErrors.size(); i++) {
+        if (changed.contains(newErrors[i]->targetElement())) {
+            addDirtyDrawable(newErrors[i]);
+        }
+    }
+    repaintDirty();
 }
 
 /*!
@@ -353,9 +414,8 @@ void CAScoreView::setLastMousePressCoordsAfter(const QList<CAMusElement*> list)
 {
     double maxX = 0;
     for (int i = 0; i < list.size(); i++) {
-        QList<CADrawable*> drawables = _mapDrawable.values(list[i]);
-        for (int j = 0; j < drawables.size(); j++) {
-            maxX = qMax(drawables[j]->xPos() + drawables[j]->width(), maxX);
+        for (QMultiHash<void*, CADrawable*>::const_iterator it = _mapDrawable.constFind(list[i]); it != _mapDrawable.constEnd() && it.key() == list[i]; it++) {
+            maxX = qMax(it.value()->xPos() + it.value()->width(), maxX);
         }
     }
     QPoint newCoords(lastMousePressCoords());
@@ -411,12 +471,12 @@ QList<CADrawableMusElement*> CAScoreView::musElementsAt(double x, double y)
 */
 CADrawableMusElement* CAScoreView::selectMElement(CAMusElement* elt)
 {
+    addDirtySelection();
     _selection.clear();
 
-    QList<CADrawable*> drawables = _mapDrawable.values(elt);
-    for (int i = 0; i < drawables.size(); i++) {
-        if (drawables[i]->drawableType() == CADrawable::DrawableMusElement && static_cast<CADrawableMusElement*>(drawables[i])->musElement() == elt && drawables[i]->isSelectable()) {
-            addToSelection(static_cast<CADrawableMusElement*>(drawables[i]));
+    for (QMultiHash<void*, CADrawable*>::const_iterator it = _mapDrawable.constFind(elt); it != _mapDrawable.constEnd() && it.key() == elt; it++) {
+        if (it.value()->drawableType() == CADrawable::DrawableMusElement && static_cast<CADrawableMusElement*>(it.value())->musElement() == elt && it.value()->isSelectable()) {
+            addToSelection(static_cast<CADrawableMusElement*>(it.value()));
         }
     }
 
@@ -598,6 +658,28 @@ CAContext* CAScoreView::contextCollision(double x, double y)
     }
 }
 
+/*!
+	Deletes the drawable elements and the shadow notes without laying out the sheet again.
+
+	Views which are kept around, but not shown (eg. by CAPreviewCtl) call this once they
+	are done with the drawables, so the view doesn't refer to the sheet when it is changed
+	or deleted in the meantime. Call rebuild() to lay out the sheet again.
+*/
+void CAScoreView::clearDrawables()
+{
+    while (!_shadowNote.isEmpty()) {
+        delete _shadowDrawableNote.takeFirst();
+        delete _shadowNote.takeFirst();
+    }
+
+    _selection.clear();
+    _currentContext = nullptr;
+    _drawableMList.clear(true);
+    _drawableCList.clear(true);
+    _drawableNCEList.clear(true);
+    _mapDrawable.clear();
+}
+
 /*!
 	Calls the engraver to reposition the music elements on the canvas.
 	Also updates scrollbars.
@@ -626,9 +708,28 @@ void CAScoreView::rebuild()
     int contextIdx = (_currentContext ? _drawableCList.list().indexOf(_currentContext) : -1); // remember the index of last used context
     _drawableCList.clear(true);
     _drawableNCEList.clear(true);
+    int drawableCount = _mapDrawable.size();
     _mapDrawable.clear();
+    _mapDrawable.reserve(drawableCount); // the new layout usually has a similar number of drawables
+
+    // notes and rests further than one screen away are not materialised, see setVirtualLayout()
+    if (_virtualLayout) {
+        double margin = qMax(_worldW, static_cast<double>(VIRTUAL_LAYOUT_MARGIN));
+        _materialisedX1 = _worldX - margin;
+        _materialisedX2 = _worldX + _worldW + margin;
+        _materialisedElements = musElementSelection.toSet();
+    } else {
+        _materialisedX1 = -std::numeric_limits<double>::max();
+        _materialisedX2 = std::numeric_limits<double>::max();
+    }
 
+    // the old drawables are gone, lay out the new ones one after another in the arena
+    _drawableArena.reset();
+    CADrawableArena* previousArena = CADrawableArena::current();
+    CADrawableArena::setCurrent(&_drawableArena);
     CALayoutEngine::reposit(this);
+    CADrawableArena::setCurrent(previousArena);
+    _materialisedElements.clear();
 
     for (int i = 0; i < _shadowNote.size(); i++) {
         _shadowNote[i]->setPlayableLength(l);
@@ -646,6 +747,73 @@ void CAScoreView::rebuild()
     updateHelpers();
 }
 
+/*!
+	\fn void CAScoreView::setVirtualLayout(bool v)
+	Enables or disables the virtual layout of the view.
+
+	In virtual layout, the layout engine still walks the whole sheet to compute the
+	columns and the time axis, but the drawable notes, rests and syllables are only created
+	for the columns near the visible area. Contexts, signatures, barlines and the elements
+	other drawables refer to (eg. tied or slurred notes) are always kept. When the view
+	is scrolled or zoomed close to the border of the laid out area, a rebuild() around the
+	new position is queued, so the memory and the indexes of the view are proportional
+	to what is on screen, not to the length of the score. The rebuild is never done while
+	painting or scrolling, so the drawables stay valid until the control returns to the
+	event loop. Keep music elements instead of drawables across the event loop.
+
+	Functions working on all the drawables (eg. selectAll()) call materialiseAll() first.
+	The new setting is used on the next rebuild().
+*/
+
+/*!
+	Returns True, if the music element \a elt placed at the world X coordinate \a x
+	should get its drawable in the current rebuild().
+	Used by CALayoutEngine in virtual layout.
+
+	\sa setVirtualLayout()
+*/
+bool CAScoreView::isMaterialised(double x, CAMusElement* elt)
+{
+    return (x >= _materialisedX1 && x <= _materialisedX2) || _materialisedElements.contains(elt);
+}
+
+/*!
+	Queues a rebuild() around the visible area, if less than half of the visible width is
+	laid out left or right of it in virtual layout.
+
+	\sa setVirtualLayout()
+*/
+void CAScoreView::checkMaterialised()
+{
+    if (_virtualLayout && (_worldX - _worldW / 2 < _materialisedX1 || _worldX + 1.5 * _worldW > _materialisedX2)) {
+        _materialiseTimer->start();
+    }
+}
+
+void CAScoreView::on_materialiseTimer_timeout()
+{
+    if (_virtualLayout && (_worldX - _worldW / 2 < _materialisedX1 || _worldX + 1.5 * _worldW > _materialisedX2)) {
+        rebuild();
+        repaint();
+    }
+}
+
+/*!
+	Lays out the whole sheet, if only part of it was laid out because of the virtual layout.
+	The elements stay laid out until the next rebuild().
+*/
+void CAScoreView::materialiseAll()
+{
+    if (_materialisedX1 == -std::numeric_limits<double>::max() && _materialisedX2 == std::numeric_limits<double>::max()) {
+        return;
+    }
+
+    bool virtualLayout = _virtualLayout;
+    _virtualLayout = false;
+    rebuild();
+    _virtualLayout = virtualLayout;
+}
+
 /*!
 	Sets the world Top-Left X coordinate of the view. Animates the scroll, if \a animate is True.
 	If \a force is True, sets the value despite the potential illegal value (like negative coordinates).
@@ -677,6 +845,7 @@ void CAScoreView::setWorldX(double x, bool animate, bool force)
     _hScrollBarDeadLock = false;
 
     checkScrollBars();
+    checkMaterialised();
     updateHelpers();
 }
 
@@ -744,6 +913,7 @@ void CAScoreView::setWorldWidth(double w, bool force)
     _zoom = static_cast<double>(drawableWidth() / _worldW);
 
     checkScrollBars();
+    checkMaterialised();
 }
 
 /*!
@@ -956,11 +1126,20 @@ void CAScoreView::setZoom(float z, double x, double y, bool animate, bool force)
 */
 #include <sys/time.h> //benchmarking
 #include <time.h> //benchmarking
-void CAScoreView::paintEvent(QPaintEvent*)
+void CAScoreView::paintEvent(QPaintEvent* e)
 {
     if (_holdRepaint)
         return;
 
+    // only the part of the view Qt asked for is redrawn, see repaintDirty()
+    bool partial = (!_repaintArea && e->rect() != rect());
+    QRectF area(_worldX, _worldY, _worldW, _worldH);
+    if (_repaintArea) {
+        area = QRectF(*_repaintArea);
+    } else if (partial) {
+        area = QRectF(_worldX + e->rect().x() / _zoom, _worldY + e->rect().y() / _zoom, e->rect().width() / _zoom, e->rect().height() / _zoom);
+    }
+
     // draw the border
     QPainter p(this);
     if (_drawBorder) {
@@ -971,18 +1150,15 @@ void CAScoreView::paintEvent(QPaintEvent*)
     // draw the background
     if (_repaintArea)
         p.fillRect(qRound((_repaintArea->x() - _worldX) * _zoom), qRound((_repaintArea->y() - _worldY) * _zoom), qRound(_repaintArea->width() * _zoom), qRound(_repaintArea->height() * _zoom), _backgroundColor);
+    else if (partial)
+        p.fillRect(e->rect(), _backgroundColor);
     else
         p.fillRect(_canvas->x(), _canvas->y(), _canvas->width(), _canvas->height(), _backgroundColor);
 
     // draw contexts
     timeval timeStart, timeEnd, timeEnd2;
     gettimeofday(&timeStart, nullptr);
-    QList<CADrawableContext*> cList;
-    //int j = _drawableCList.size();
-    if (_repaintArea)
-        cList = _drawableCList.findInRange(_repaintArea->x(), _repaintArea->y(), _repaintArea->width(), _repaintArea->height());
-    else
-        cList = _drawableCList.findInRange(_worldX, _worldY, _worldW, _worldH);
+    QList<CADrawableContext*> cList = _drawableCList.findInRange(area.x(), area.y(), area.width(), area.height());
 
     for (int i = 0; i < cList.size(); i++) {
         CADrawSettings s = {
@@ -998,11 +1174,7 @@ void CAScoreView::paintEvent(QPaintEvent*)
     }
 
     // draw music elements
-    QList<CADrawableMusElement*> mList;
-    if (_repaintArea)
-        mList = _drawableMList.findInRange(_repaintArea->x(), _repaintArea->y(), _repaintArea->width(), _repaintArea->height());
-    else
-        mList = _drawableMList.findInRange(_worldX, _worldY, _worldW, _worldH);
+    QList<CADrawableMusElement*> mList = _drawableMList.findInRange(area.x(), area.y(), area.width(), area.height());
 
     gettimeofday(&timeEnd, nullptr);
 
@@ -1084,7 +1256,7 @@ void CAScoreView::paintEvent(QPaintEvent*)
 
     // draw note checker errors
     {
-        QList<CADrawableNoteCheckerError*> dnceList = _drawableNCEList.findInRange(_worldX, _worldY, _worldW, _worldH);
+        QList<CADrawableNoteCheckerError*> dnceList = _drawableNCEList.findInRange(area.x(), area.y(), area.width(), area.height());
         for (int i = 0; i < dnceList.size(); i++) {
             CADrawSettings c = {
                 _zoom,
@@ -1141,14 +1313,19 @@ void CAScoreView::paintEvent(QPaintEvent*)
 
         // draw note name
         if (_shadowNote.size()) {
-            QFont font("FreeSans");
-            font.setPixelSize(20);
-            p.setFont(font);
+            p.setFont(shadowNoteNameFont());
             p.setPen(disabledElementsColor());
-            p.drawText(qRound((_xCursor - _worldX + 10) * _zoom), qRound((_yCursor - _worldY - 10) * _zoom), CANote::generateNoteName(_shadowNote[0]->diatonicPitch().noteName(), _shadowNoteAccs));
+            p.drawText(qRound((_xCursor - _worldX + 10) * _zoom), qRound((_yCursor - _worldY - 10) * _zoom), shadowNoteName());
         }
     }
 
+    // draw playback cursor
+    if (_playbackCursorX >= 0) {
+        p.setPen(QPen(playbackCursorColor(), 2));
+        int x = qRound((_playbackCursorX - _worldX) * _zoom);
+        p.drawLine(x, 0, x, height());
+    }
+
     gettimeofday(&timeEnd2, nullptr);
 
     //	std::cout << "finding elements to draw took " << timeEnd.tv_sec-timeStart.tv_sec+(timeEnd.tv_usec-timeStart.tv_usec)/1000000.0 << "s." << std::endl;
@@ -1163,12 +1340,158 @@ void CAScoreView::paintEvent(QPaintEvent*)
     if (_repaintArea) {
         delete _repaintArea;
         _repaintArea = nullptr;
+    } else if (!partial) {
+        _dirtyRect = QRectF(); // everything is up to date
+    }
+}
+
+/*!
+	Marks the world area \a rect as changed.
+	The changed areas are accumulated until repaintDirty() is called.
+*/
+void CAScoreView::addDirtyRect(const QRectF& rect)
+{
+    _dirtyRect = _dirtyRect.isNull() ? rect : _dirtyRect.united(rect);
+}
+
+/*!
+	Marks the area occupied by the \a drawable as changed, eg. when selecting it.
+*/
+void CAScoreView::addDirtyDrawable(CADrawable* drawable)
+{
+    if (drawable) {
+        addDirtyRect(drawable->bBox().adjusted(-DIRTY_MARGIN, -DIRTY_MARGIN, DIRTY_MARGIN, DIRTY_MARGIN));
+    }
+}
+
+/*!
+	Marks the currently selected elements as changed.
+*/
+void CAScoreView::addDirtySelection()
+{
+    for (int i = 0; i < _selection.size(); i++) {
+        addDirtyDrawable(_selection[i]);
+    }
+}
+
+/*!
+	Marks the shadow notes, their accidentals and the note name next to the cursor as changed.
+*/
+void CAScoreView::addDirtyShadowNotes()
+{
+    if (!_shadowNoteVisible) {
+        return;
+    }
+
+    for (int i = 0; i < _shadowDrawableNote.size(); i++) {
+        // the shadow note is drawn centered, the accidental left of it
+        QRectF r = _shadowDrawableNote[i]->bBox().translated(-_shadowDrawableNote[i]->width() / 2, 0);
+        addDirtyRect(r.adjusted(-(r.width() + 2 * DIRTY_MARGIN), -r.height(), DIRTY_MARGIN, r.height()));
+    }
+
+    if (!_shadowNoteNameRect.isNull()) {
+        addDirtyRect(_shadowNoteNameRect);
+    }
+}
+
+/*!
+	Moves the playback cursor to the given Canorus \a time and repaints the old and the
+	new cursor position only. The score itself is not laid out again.
+	Hides the cursor, if \a time is -1 or doesn't exist in the sheet.
+
+	Usually called by the main window at display refresh rate with CAPlayback::playbackTime().
+*/
+void CAScoreView::setPlaybackTime(int time)
+{
+    double x = (time < 0 ? -1 : timeToCoords(time));
+    if (x == _playbackCursorX) {
+        return;
+    }
+
+    if (_playbackCursorX >= 0) {
+        addDirtyRect(playbackCursorRect());
+    }
+    _playbackCursorX = x;
+    if (_playbackCursorX >= 0) {
+        addDirtyRect(playbackCursorRect());
+    }
+
+    repaintDirty();
+}
+
+/*!
+	Returns the world area covered by the playback cursor line across the whole view.
+*/
+QRectF CAScoreView::playbackCursorRect()
+{
+    return QRectF(_playbackCursorX - 2 / _zoom, _worldY, 4 / _zoom, _worldH);
+}
+
+/*!
+	Returns the name of the shadow note written next to the cursor.
+*/
+QString CAScoreView::shadowNoteName()
+{
+    return _shadowNote.size() ? CANote::generateNoteName(_shadowNote[0]->diatonicPitch().noteName(), _shadowNoteAccs) : QString();
+}
+
+/*!
+	Returns the font of the shadow note name. Its size is fixed in pixels and doesn't
+	change with the zoom level.
+*/
+QFont CAScoreView::shadowNoteNameFont()
+{
+    QFont font("FreeSans");
+    font.setPixelSize(20);
+    return font;
+}
+
+/*!
+	Returns the world area of the note name written next to the cursor, measured with the
+	metrics of the font it's painted in.
+	Returns an empty rectangle, if there is no shadow note.
+*/
+QRectF CAScoreView::shadowNoteNameRect()
+{
+    QString name = shadowNoteName();
+    if (name.isEmpty()) {
+        return QRectF();
+    }
+
+    // the text is painted at the baseline 10 units right above the cursor, in pixels
+    QRectF r = QFontMetricsF(shadowNoteNameFont()).boundingRect(name);
+    return QRectF(_xCursor + 10 + r.x() / _zoom, _yCursor - 10 + r.y() / _zoom, r.width() / _zoom, r.height() / _zoom)
+        .adjusted(-DIRTY_MARGIN, -DIRTY_MARGIN, DIRTY_MARGIN, DIRTY_MARGIN);
+}
+
+/*!
+	Repaints the areas marked as changed since the last repaint only.
+	Use this instead of repaint() when only a few elements changed their look, eg. when
+	the selection, the shadow note or the playback position changes.
+	The repaint is scheduled, so multiple calls in a row are painted once.
+
+	\sa addDirtyRect(), addDirtyDrawable()
+*/
+void CAScoreView::repaintDirty()
+{
+    if (_dirtyRect.isNull()) {
+        return;
+    }
+
+    QRect r(qFloor((_dirtyRect.x() - _worldX) * _zoom) - 1, qFloor((_dirtyRect.y() - _worldY) * _zoom) - 1,
+        qCeil(_dirtyRect.width() * _zoom) + 2, qCeil(_dirtyRect.height() * _zoom) + 2);
+    _dirtyRect = QRectF();
+
+    r = r.intersected(rect());
+    if (!r.isEmpty()) {
+        update(r);
     }
 }
 
 void CAScoreView::updateHelpers()
 {
     // Shadow notes
+    addDirtyShadowNotes(); // old position
     if (currentContext() ? (currentContext()->drawableContextType() == CADrawableContext::DrawableStaff) : 0) {
         int pitch = (static_cast<CADrawableStaff*>(currentContext()))->calculatePitch(_xCursor, _yCursor); // the current staff has the real pitch we need
         for (int i = 0; i < _shadowNote.size(); i++) { // apply this pitch to all shadow notes in all staffs
@@ -1185,6 +1508,8 @@ void CAScoreView::updateHelpers()
             _shadowDrawableNote[i] = new CADrawableNote(_shadowNote[i], c, _xCursor, static_cast<CADrawableStaff*>(c)->calculateCenterYCoord(pitch, _xCursor), true);
         }
     }
+    _shadowNoteNameRect = shadowNoteNameRect();
+    addDirtyShadowNotes(); // new position
 
     // Text edit widget
     if (textEditVisible()) {
@@ -1589,8 +1914,10 @@ void CAScoreView::addToSelection(CADrawableMusElement* elt, bool triggerSignal)
     for (i = 0; i < _selection.size() && _selection[i]->xPos() < elt->xPos(); i++)
         ;
 
-    if (elt->isSelectable())
+    if (elt->isSelectable()) {
         _selection.insert(i, elt);
+        addDirtyDrawable(elt);
+    }
 
     if (triggerSignal)
         emit selectionChanged();
@@ -1615,9 +1942,8 @@ void CAScoreView::addToSelection(const QList<CADrawableMusElement*> list, bool s
 */
 CADrawableMusElement* CAScoreView::addToSelection(CAMusElement* elt)
 {
-    QList<CADrawable*> l = _mapDrawable.values(elt);
-    for (int i = 0; i < l.size(); i++) {
-        addToSelection(static_cast<CADrawableMusElement*>(l[i]));
+    for (QMultiHash<void*, CADrawable*>::const_iterator it = _mapDrawable.constFind(elt); it != _mapDrawable.constEnd() && it.key() == elt; it++) {
+        addToSelection(static_cast<CADrawableMusElement*>(it.value()));
     }
 
     emit selectionChanged();
@@ -1630,9 +1956,8 @@ CADrawableMusElement* CAScoreView::addToSelection(CAMusElement* elt)
 void CAScoreView::addToSelection(const QList<CAMusElement*> elts)
 {
     for (int i = 0; i < elts.size(); i++) {
-        QList<CADrawable*> l = _mapDrawable.values(elts[i]);
-        for (int j = 0; j < l.size(); j++) {
-            addToSelection(static_cast<CADrawableMusElement*>(l[j]), false);
+        for (QMultiHash<void*, CADrawable*>::const_iterator it = _mapDrawable.constFind(elts[i]); it != _mapDrawable.constEnd() && it.key() == elts[i]; it++) {
+            addToSelection(static_cast<CADrawableMusElement*>(it.value()), false);
         }
     }
 
@@ -1645,6 +1970,7 @@ void CAScoreView::addToSelection(const QList<CAMusElement*> elts)
 */
 void CAScoreView::selectAll()
 {
+    materialiseAll();
     clearSelection();
 
     QList<CADrawableMusElement*> elts = _drawableMList.list();
@@ -1688,6 +2014,7 @@ void CAScoreView::selectAllCurContext()
         return;
     }
 
+    materialiseAll();
     clearSelection();
     addToSelection(currentContext()->drawableMusElementList(), false);
 
@@ -1699,6 +2026,7 @@ void CAScoreView::selectAllCurContext()
 */
 void CAScoreView::invertSelection()
 {
+    materialiseAll();
     QList<CADrawableMusElement*> oldSelection = selection();
     clearSelection();
 
@@ -1721,11 +2049,7 @@ CADrawableMusElement* CAScoreView::findMElement(CAMusElement* elt)
         return nullptr;
     }
 
-    QList<CADrawable*> hits = _mapDrawable.values(elt);
-    if (hits.size()) {
-        return static_cast<CADrawableMusElement*>(hits[0]);
-    }
-    return nullptr;
+    return static_cast<CADrawableMusElement*>(newestDrawable(elt));
 }
 
 /*!
@@ -1739,11 +2063,34 @@ CADrawableContext* CAScoreView::findCElement(CAContext* context)
         return nullptr;
     }
 
-    QList<CADrawable*> hits = _mapDrawable.values(context);
-    if (hits.size()) {
-        return static_cast<CADrawableContext*>(hits[0]);
+    return static_cast<CADrawableContext*>(newestDrawable(context));
+}
+
+/*!
+	Returns the most recently added drawable instance of the given music element or context \a elt
+	or Null, if none exists. Constant time, doesn't allocate.
+
+	\sa oldestDrawable()
+*/
+CADrawable* CAScoreView::newestDrawable(void* elt)
+{
+    return _mapDrawable.value(elt, nullptr);
+}
+
+/*!
+	Returns the first added drawable instance of the given music element or context \a elt
+	or Null, if none exists. Elements split over multiple systems have more instances.
+
+	\sa newestDrawable()
+*/
+CADrawable* CAScoreView::oldestDrawable(void* elt)
+{
+    CADrawable* oldest = nullptr;
+    for (QMultiHash<void*, CADrawable*>::const_iterator it = _mapDrawable.constFind(elt); it != _mapDrawable.constEnd() && it.key() == elt; it++) {
+        oldest = it.value();
     }
-    return nullptr;
+
+    return oldest;
 }
 
 /*!
@@ -1835,7 +2182,13 @@ void CAScoreView::removeTextEdit()
 template <typename T>
 double CAScoreView::getMaxXExtended(CAKDTree<T>& v)
 {
-    return v.getMaxX() + RIGHT_EXTRA_SPACE;
+    double maxX = v.getMaxX();
+    if (_virtualLayout && _timeAxis.anchorCount()) {
+        // the last columns may not be materialised, the time axis ends at the sheet end
+        maxX = qMax(maxX, _timeAxis.anchorX(_timeAxis.anchorCount() - 1));
+    }
+
+    return maxX + RIGHT_EXTRA_SPACE;
 }
 
 /*!
@@ -1861,54 +2214,59 @@ QList<CADrawableContext*> CAScoreView::findContextsInRegion(QRect& region)
 
 /*!
 	Returns Canorus time for the given X coordinate \a x.
+	Looks up the time axis of the view built by the layout engine.
+
+	Columns whose notes and rests are all selected (eg. being dragged) are skipped, so the
+	time is determined by the remaining elements only.
 
 	Returns 0, if no contexts are present.
+
+	\sa CATimeAxis
 */
 int CAScoreView::coordsToTime(double x)
 {
-    CADrawableMusElement* d1 = nearestLeftElement(x, 0);
-    if (selection().contains(d1)) {
-        CADrawableMusElement* newD1 = nearestLeftElement(d1->xPos(), 0);
-        d1 = newD1;
+    QSet<CAMusElement*> selected;
+    for (CADrawableMusElement* d : selection()) {
+        if (d->musElement() && d->musElement()->isPlayable()) {
+            selected << d->musElement();
+        }
     }
 
-    CADrawableMusElement* d2 = nearestRightElement(x, 0);
-    if (selection().contains(d2)) {
-        CADrawableMusElement* newD2 = nearestRightElement(d2->xPos() + d2->width(), 0);
-        d2 = newD2;
+    QSet<int> skippedTimes;
+    if (!selected.isEmpty()) {
+        QList<CAVoice*> voiceList = _sheet->voiceList();
+        for (CAMusElement* elt : selected) {
+            const int time = elt->timeStart();
+            if (skippedTimes.contains(time)) {
+                continue;
+            }
+
+            bool shared = false;
+            for (int i = 0; i < voiceList.size() && !shared; i++) {
+                const QList<CAMusElement*>& list = voiceList[i]->musElementList();
+                for (QList<CAMusElement*>::const_iterator it = std::lower_bound(list.constBegin(), list.constEnd(), time, CAScoreView::musElementTimeLessThan);
+                     it != list.constEnd() && (*it)->timeStart() == time && !shared; it++) {
+                    shared = (*it)->isPlayable() && !selected.contains(*it);
+                }
+            }
+
+            if (!shared) {
+                skippedTimes << time;
+            }
+        }
     }
 
-    if (d1 && d2 && d1->musElement() && d2->musElement()) {
-        int delta = (d2->xPos() - d1->xPos());
-        if (!delta)
-            delta = 1;
-        return qRound(d1->musElement()->timeStart() + (d2->musElement()->timeStart() - d1->musElement()->timeStart()) * ((x - d1->xPos()) / delta));
-    } else if (d1 && d1->musElement())
-        return (d1->musElement()->timeEnd());
-    else
-        return 0;
+    return _timeAxis.coordsToTime(x, skippedTimes);
 }
 
 /*!
- * Helper function for timeToCoords() when doing the binary search over elements.
- * 
- * \sa timeMusElementLessThan
+ * Helper function for coordsToTime() and timeToCoordsSimpleVersion() when doing the binary search over elements.
  */
 bool CAScoreView::musElementTimeLessThan(const CAMusElement* a, const int b)
 {
     return (a->timeStart() < b);
 }
 
-/*!
- * Helper function for timeToCoords() when doing the binary search over elements.
- * 
- * \sa musElementTimeLessThan
- */
-bool CAScoreView::timeMusElementLessThan(const int a, const CAMusElement* b)
-{
-    return (a < b->timeStart());
-}
-
 /*!
 	Simple Version of \sa timeToCoords( time ):
 	Returns the X coordinate for the given Canorus \a time.
@@ -1923,8 +2281,8 @@ double CAScoreView::timeToCoordsSimpleVersion(int time)
         // get the element still smaller or equal, but nearest to time
         QList<CAMusElement*>::const_iterator it = std::lower_bound(voiceList[i]->musElementList().constBegin(), voiceList[i]->musElementList().constEnd(), time, CAScoreView::musElementTimeLessThan);
         if (it != voiceList[i]->musElementList().constEnd()) {
-            if (_mapDrawable.contains(*it)) {
-                CADrawableMusElement* dElt = static_cast<CADrawableMusElement*>(_mapDrawable.values(*it).last());
+            CADrawableMusElement* dElt = static_cast<CADrawableMusElement*>(oldestDrawable(*it));
+            if (dElt) {
                 if (leftElt && leftElt->xPos() < dElt->xPos()) {
                     leftElt = dElt;
                 }
@@ -1940,52 +2298,12 @@ double CAScoreView::timeToCoordsSimpleVersion(int time)
 /*!
 	Returns the X coordinate for the given Canorus \a time.
 	Returns -1, if such a time doesn't exist in the score.
+
+	\sa CATimeAxis
 */
 double CAScoreView::timeToCoords(int time)
 {
-    CADrawableMusElement* leftElt = nullptr;
-    CADrawableMusElement* rightElt = nullptr;
-
-    QList<CAVoice*> voiceList = _sheet->voiceList();
-    for (int i = 0; i < voiceList.size(); i++) {
-        // get the element still smaller or equal, but nearest to time
-        QList<CAMusElement*>::const_iterator it = std::lower_bound(voiceList[i]->musElementList().constBegin(), voiceList[i]->musElementList().constEnd(), time, CAScoreView::musElementTimeLessThan);
-        if (it != voiceList[i]->musElementList().constEnd()) {
-            if (_mapDrawable.contains(*it)) {
-                CADrawableMusElement* dElt = static_cast<CADrawableMusElement*>(_mapDrawable.values(*it).last());
-                if (!leftElt || leftElt->xPos() < dElt->xPos()) {
-                    leftElt = dElt;
-                }
-            } else {
-                std::cerr << "ERROR: Drawable instance of musElement " << (*it) << " doesn't exist in _mapDrawable!" << std::endl;
-            }
-        }
-
-        // and for the right element
-        it = std::upper_bound(voiceList[i]->musElementList().constBegin(), voiceList[i]->musElementList().constEnd(), time, CAScoreView::timeMusElementLessThan);
-        if (it != voiceList[i]->musElementList().constEnd()) {
-            if (_mapDrawable.contains(*it)) {
-                CADrawableMusElement* dElt = static_cast<CADrawableMusElement*>(_mapDrawable.values(*it).first());
-                if (!rightElt || rightElt->xPos() > dElt->xPos()) {
-                    rightElt = dElt;
-                }
-            } else {
-                std::cerr << "ERROR: Drawable instance of musElement " << (*it) << " doesn't exist in _mapDrawable!" << std::endl;
-            }
-        }
-    }
-
-    // get the relative position between the nearest left and the nearest right elements
-    if (leftElt && rightElt && leftElt->musElement() && rightElt->musElement()) {
-        int delta = (rightElt->musElement()->timeStart() - leftElt->musElement()->timeStart());
-        if (!delta)
-            delta = 1;
-        // Note Reinhard: Fixed conversion to double
-        // I assume that division by delta should result in double value
-        return leftElt->xPos() + (rightElt->xPos() - leftElt->xPos()) * static_cast<double>(time - leftElt->musElement()->timeStart() / static_cast<double>(delta));
-    } else {
-        return -1;
-    }
+    return _timeAxis.timeToCoords(time);
 }
 
 void CAScoreView::setShadowNoteLength(CAPlayableLength l)
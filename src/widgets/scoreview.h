@@ -9,14 +9,18 @@
 #define SCOREVIEW_H_
 
 #include <QBrush>
+#include <QFont>
 #include <QLineEdit>
 #include <QList>
-#include <QMultiMap>
+#include <QMultiHash>
 #include <QPen>
 #include <QRect>
+#include <QSet>
 #include <QTimer>
 
+#include "layout/drawablearena.h"
 #include "layout/kdtree.h"
+#include "layout/timeaxis.h"
 #include "score/note.h"
 #include "widgets/view.h"
 
@@ -72,6 +76,7 @@ public:
     CAScoreView* clone(QWidget* parent);
     inline CASheet* sheet() { return _sheet; }
     inline void setSheet(CASheet* sheet) { _sheet = sheet; }
+    inline CATimeAxis* timeAxis() { return &_timeAxis; }
 
     ////////////////////////////////////////////
     // Addition, removal of drawable elements //
@@ -79,6 +84,7 @@ public:
     void addMElement(CADrawableMusElement* elt, bool select = false);
     void addCElement(CADrawableContext* elt, bool select = false);
     void addDrawableNoteCheckerError(CADrawableNoteCheckerError* dnce);
+    void updateNoteCheckerErrors(const QList<CAMusElement*>& changedElements);
 
     void importElements(CAKDTree<CADrawableMusElement*>* drawableMList, CAKDTree<CADrawableContext*>* drawableCList);
 
@@ -103,12 +109,14 @@ public:
     void invertSelection();
     inline void clearSelection()
     {
+        addDirtySelection();
         _selection.clear();
         emit selectionChanged();
     }
     // Note Reinhard: This code does not make sense
     inline bool removeFromSelection(CADrawableMusElement* elt)
     {
+        addDirtyDrawable(elt);
         return _selection.removeAll(elt);
         emit selectionChanged();
     }
@@ -136,6 +144,8 @@ public:
     /////////////////////////////////////////////////////////////////////
     CADrawableMusElement* findMElement(CAMusElement*);
     CADrawableContext* findCElement(CAContext*);
+    inline CAKDTree<CADrawableMusElement*>& drawableMList() { return _drawableMList; }
+    inline CAKDTree<CADrawableContext*>& drawableCList() { return _drawableCList; }
     QList<CADrawableContext*> findContextsInRegion(QRect& reg);
     CADrawableMusElement* nearestLeftElement(double x, double y, CADrawableContext* context = nullptr);
     CADrawableMusElement* nearestLeftElement(double x, double y, CAVoice* voice);
@@ -145,7 +155,6 @@ public:
     double timeToCoords(int time);
     double timeToCoordsSimpleVersion(int time);
     static bool musElementTimeLessThan(const CAMusElement* a, const int b);
-    static bool timeMusElementLessThan(const int a, const CAMusElement* b);
 
     CADrawableContext* nearestUpContext(double x, double y);
     CADrawableContext* nearestDownContext(double x, double y);
@@ -170,6 +179,12 @@ public:
     // Scene appearance, properties and actions //
     //////////////////////////////////////////////
     void rebuild();
+    void clearDrawables();
+    inline bool virtualLayout() { return _virtualLayout; }
+    inline void setVirtualLayout(bool v) { _virtualLayout = v; }
+    bool isMaterialised(double x, CAMusElement* elt);
+    void materialiseAll();
+    void checkMaterialised();
     void setMouseTracking(bool); // reimplemented!
     inline int drawableWidth() { return _canvas->width(); }
     inline int drawableHeight() { return _canvas->height(); }
@@ -223,8 +238,14 @@ public:
 
     inline bool playing() { return _playing; }
     inline void setPlaying(bool playing) { _playing = playing; }
+    void setPlaybackTime(int time);
+    inline QColor playbackCursorColor() { return _playbackCursorColor; }
+    inline void setPlaybackCursorColor(const QColor c) { _playbackCursorColor = c; }
 
     inline void setRepaintArea(QRect* area) { _repaintArea = area; }
+    void addDirtyRect(const QRectF& rect);
+    void addDirtyDrawable(CADrawable* drawable);
+    void repaintDirty();
     inline void clearRepaintArea()
     {
         if (_repaintArea)
@@ -279,6 +300,7 @@ private slots:
     void enterEvent(QEvent* e);
     void on_animationTimer_timeout();
     void on_clickTimer_timeout();
+    void on_materialiseTimer_timeout();
 
 signals:
     void CATripleClickEvent(QMouseEvent* e, QPoint p);
@@ -309,11 +331,15 @@ private:
     ////////////////////////
     // General properties //
     ////////////////////////
+    CADrawableArena _drawableArena; // Memory of the drawables created by rebuild(), must outlive the lists below
     CAKDTree<CADrawableMusElement*> _drawableMList; // The list of music elements stored in a tree for faster lookup and other operations. Every view has its own list of drawable elements and drawable objects themselves!
     CAKDTree<CADrawableContext*> _drawableCList; // The list of context drawable elements (staffs, lyrics etc.). Every view has its own list of drawable elements and drawable objects themselves!
     CAKDTree<CADrawableNoteCheckerError*> _drawableNCEList; // The list of drawable note checker errors
-    QMultiMap<void*, CADrawable*> _mapDrawable; // Mapping of all music elements/contexts in the score -> drawable elements on canvas
+    QMultiHash<void*, CADrawable*> _mapDrawable; // Mapping of all music elements/contexts in the score -> drawable elements on canvas, most recently added first
+    CADrawable* newestDrawable(void* elt);
+    CADrawable* oldestDrawable(void* elt);
     CASheet* _sheet; // Pointer to the CASheet which the view represents.
+    CATimeAxis _timeAxis; // Time <-> X coordinate anchors of this view's layout
 
     QList<CADrawableMusElement*> _selection; // The set of elements being selected.
     CADrawableContext* _currentContext; // The pointer to the currently active context (staff, lyrics).
@@ -321,6 +347,7 @@ private:
     static const int RIGHT_EXTRA_SPACE; // Extra space at the right end to insert new music
     static const int BOTTOM_EXTRA_SPACE; // Extra space at the bottom end to insert new music
     static const int RULER_HEIGHT; // Ruler height in pixels
+    static const int VIRTUAL_LAYOUT_MARGIN; // Minimum world width laid out left and right of the visible area in virtual layout
     template <typename T>
     double getMaxXExtended(CAKDTree<T>& v); // Make the viewable World a little bigger (stuffed) to make inserting at the end easier
     template <typename T>
@@ -373,6 +400,14 @@ private:
     bool _grabTabKey; // Pass the tab key to keyPressEvent() or treat it like the next item key
     bool _drawBorder; // Should the border be drawn or not.
     QRect* _repaintArea; // Area to be repainted on paintEvent().
+    QRectF _dirtyRect; // Union of the changed areas in world coordinates, repainted by repaintDirty().
+    void addDirtySelection();
+    void addDirtyShadowNotes();
+    QString shadowNoteName();
+    static QFont shadowNoteNameFont();
+    QRectF shadowNoteNameRect();
+    QRectF _shadowNoteNameRect; // World area of the note name at the current cursor, updated by updateHelpers()
+    static const int DIRTY_MARGIN; // Extra world units around the changed drawables for scale handles and antialiasing
     QPen _borderPen; // Pen which the border is drawn by.
     QColor _backgroundColor; // Color which the background is filled.
     QColor _foregroundColor; // Color which the music elements are painted.
@@ -381,6 +416,7 @@ private:
     QColor _selectedContextColor; // Color which the current context is painted.
     QColor _disabledElementsColor; // Color which the elements in non-selected voice are painted.
     QColor _hiddenElementsColor; // Color which the invisible elements are painted in current-voice-only mode.
+    QColor _playbackCursorColor; // Color which the playback cursor is painted.
     bool _noteNameVisible; // Is the written note name visible
     QString _noteName; // Name of the note to be inserted. eg. c', Des,
 
@@ -406,7 +442,13 @@ private:
     /////////////////////////
     double _oldWorldX, _oldWorldY, _oldWorldW, _oldWorldH; // Old coordinates used before the repaint. This is needed so only the new part of the view gets repainted when panning.
     bool _playing; // Set to on, when in Playback mode
+    bool _virtualLayout; // Lay out the notes and rests near the visible area only, see setVirtualLayout()
+    double _materialisedX1, _materialisedX2; // World X range whose notes and rests were laid out in the last rebuild()
+    QSet<CAMusElement*> _materialisedElements; // Elements laid out regardless of their position during rebuild(), eg. selected ones
+    double _playbackCursorX; // World X coordinate of the playback cursor or -1, if hidden
+    QRectF playbackCursorRect();
     QTimer* _clickTimer; // Used for measuring doubleClick and tripleClick
+    QTimer* _materialiseTimer; // Queues rebuild() of the area scrolled into view in virtual layout
     int _numberOfClicks; // Used for measuring doubleClick and tripleClick
 
     double _xCursor, _yCursor; // Mouse cursor position in absolute world coords.